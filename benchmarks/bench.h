@@ -0,0 +1,317 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_BENCH_H
+#define GONK_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Minimal benchmark driver shared by the gonk_bench_* targets.
+//   <target> [--filter <substring>] [--min-time <ms>] [--json <file>]
+//            [--baseline <file> [--threshold <percent>]]
+//
+// The baseline is a file previously written with --json, the program fails
+// if a benchmark got slower than the baseline by more than the threshold.
+// Invalid arguments and unreadable baselines are reported and exit with 1.
+
+namespace bench
+{
+
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+struct Result
+{
+  std::string name;
+  double ns_per_op = 0;
+  uint64_t iterations = 0;
+  // filled by the drivers that measure more than time
+  double allocs_per_op = -1;
+  size_t peak_rss_kb = 0;
+};
+
+class Suite
+{
+public:
+  Suite(int argc, char* argv[])
+  {
+    try
+    {
+      parse(argc, argv);
+    }
+    catch (const std::exception& ex)
+    {
+      std::cerr << argv[0] << ": " << ex.what() << std::endl;
+      std::exit(1);
+    }
+  }
+
+  const std::vector<std::string>& extraArgs() const { return m_extra; }
+  const std::vector<Result>& results() const { return m_results; }
+
+  bool enabled(const std::string& name) const
+  {
+    return m_filter.empty() || name.find(m_filter) != std::string::npos;
+  }
+
+  // runs f() in batches whose size is calibrated so that a batch lasts at
+  // least min-time, the best of 5 batches is kept;
+  // a call to f() may perform several operations
+  template<typename F>
+  Result* run(const std::string& name, F&& f, uint64_t ops_per_call = 1)
+  {
+    if (!enabled(name))
+      return nullptr;
+
+    using clock = std::chrono::steady_clock;
+
+    uint64_t batch = 1;
+
+    for (;;)
+    {
+      auto start = clock::now();
+      for (uint64_t i(0); i < batch; ++i)
+        f();
+      auto elapsed = clock::now() - start;
+
+      if (elapsed >= m_min_time || batch >= (uint64_t(1) << 40))
+        break;
+
+      batch *= 2;
+    }
+
+    double best = -1;
+
+    for (int rep(0); rep < 5; ++rep)
+    {
+      auto start = clock::now();
+      for (uint64_t i(0); i < batch; ++i)
+        f();
+      double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / static_cast<double>(batch * ops_per_call);
+
+      if (best < 0 || ns < best)
+        best = ns;
+    }
+
+    Result r;
+    r.name = name;
+    r.ns_per_op = best;
+    r.iterations = batch * ops_per_call;
+    m_results.push_back(r);
+
+    std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(1)
+      << std::setw(12) << best << " ns/op" << std::defaultfloat << std::endl;
+
+    return &m_results.back();
+  }
+
+  void add(const Result& r)
+  {
+    m_results.push_back(r);
+  }
+
+  void writeJson(std::ostream& out) const
+  {
+    out << "{\n  \"benchmarks\": [\n";
+
+    for (size_t i(0); i < m_results.size(); ++i)
+    {
+      const Result& r = m_results.at(i);
+      out << "    {\"name\": \"" << r.name << "\", \"ns_per_op\": " << r.ns_per_op << ", \"iterations\": " << r.iterations;
+
+      if (r.allocs_per_op >= 0)
+        out << ", \"allocs_per_op\": " << r.allocs_per_op;
+
+      if (r.peak_rss_kb > 0)
+        out << ", \"peak_rss_kb\": " << r.peak_rss_kb;
+
+      out << "}" << (i + 1 < m_results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n}\n";
+  }
+
+  // returns the number of benchmarks slower than the baseline
+  int checkBaseline() const
+  {
+    int regressions = 0;
+
+    for (const Result& r : m_results)
+    {
+      auto it = m_baseline.find(r.name);
+
+      if (it == m_baseline.end() || it->second <= 0)
+        continue;
+
+      const double ratio = r.ns_per_op / it->second;
+
+      if (ratio > 1.0 + m_threshold)
+      {
+        std::cout << "REGRESSION " << r.name << ": " << r.ns_per_op << " ns/op, baseline "
+          << it->second << " ns/op (+" << static_cast<int>((ratio - 1.0) * 100) << "%)" << std::endl;
+        ++regressions;
+      }
+    }
+
+    return regressions;
+  }
+
+  int finish() const
+  {
+    int result = 0;
+
+    if (!m_json.empty())
+    {
+      std::ofstream file{ m_json };
+
+      if (file.is_open())
+      {
+        writeJson(file);
+      }
+      else
+      {
+        std::cerr << "could not write " << m_json << std::endl;
+        result = 1;
+      }
+    }
+
+    if (!m_baseline.empty() && checkBaseline() > 0)
+      result = 1;
+
+    return result;
+  }
+
+  // the whole string must be a finite number
+  static double toNumber(const std::string& what, const std::string& str)
+  {
+    size_t pos = 0;
+    double result = 0;
+
+    try
+    {
+      result = std::stod(str, &pos);
+    }
+    catch (const std::exception&)
+    {
+      pos = 0;
+    }
+
+    if (pos == 0 || pos != str.size() || !std::isfinite(result))
+      throw std::runtime_error("invalid " + what + ": '" + str + "'");
+
+    return result;
+  }
+
+  // reads the "name" and "ns_per_op" of a file written by writeJson()
+  static std::map<std::string, double> readBaseline(const std::string& path)
+  {
+    std::ifstream file{ path };
+
+    if (!file.is_open())
+      throw std::runtime_error("could not read baseline " + path);
+
+    std::map<std::string, double> result;
+    std::string line;
+
+    const std::string name_key = "\"name\": \"";
+    const std::string ns_key = "\"ns_per_op\": ";
+
+    while (std::getline(file, line))
+    {
+      size_t name_pos = line.find(name_key);
+      size_t ns_pos = line.find(ns_key);
+
+      if (name_pos == std::string::npos || ns_pos == std::string::npos)
+        continue;
+
+      name_pos += name_key.size();
+      const std::string name = line.substr(name_pos, line.find('"', name_pos) - name_pos);
+
+      ns_pos += ns_key.size();
+      const std::string ns = line.substr(ns_pos, line.find_first_of(",}", ns_pos) - ns_pos);
+      result[name] = toNumber("ns_per_op of " + name + " in baseline " + path, ns);
+    }
+
+    if (result.empty())
+      throw std::runtime_error("no benchmark found in baseline " + path);
+
+    return result;
+  }
+
+protected:
+  void parse(int argc, char* argv[])
+  {
+    for (int i(1); i < argc; ++i)
+    {
+      std::string arg = argv[i];
+
+      if (arg == "--filter" && i + 1 < argc)
+      {
+        m_filter = argv[++i];
+      }
+      else if (arg == "--min-time" && i + 1 < argc)
+      {
+        const double ms = toNumber("--min-time", argv[++i]);
+
+        if (ms <= 0)
+          throw std::runtime_error("--min-time must be positive");
+
+        m_min_time = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(ms));
+      }
+      else if (arg == "--json" && i + 1 < argc)
+      {
+        m_json = argv[++i];
+      }
+      else if (arg == "--baseline" && i + 1 < argc)
+      {
+        m_baseline = readBaseline(argv[++i]);
+      }
+      else if (arg == "--threshold" && i + 1 < argc)
+      {
+        const double percent = toNumber("--threshold", argv[++i]);
+
+        if (percent < 0)
+          throw std::runtime_error("--threshold must not be negative");
+
+        m_threshold = percent / 100.0;
+      }
+      else
+      {
+        m_extra.push_back(arg);
+      }
+    }
+  }
+
+private:
+  std::string m_filter;
+  std::chrono::steady_clock::duration m_min_time = std::chrono::milliseconds(20);
+  std::string m_json;
+  std::map<std::string, double> m_baseline;
+  double m_threshold = 0.10;
+  std::vector<std::string> m_extra;
+  std::vector<Result> m_results;
+};
+
+} // namespace bench
+
+#endif // GONK_BENCH_H
@@ -0,0 +1,320 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "bench.h"
+
+#include "gonk/common/binding/constructor.h"
+#include "gonk/common/binding/destructor.h"
+#include "gonk/common/binding/function.h"
+#include "gonk/common/binding/memberfunction.h"
+#include "gonk/common/binding/operators.h"
+#include "gonk/common/binding/pointer.h"
+
+#include "gonk/templates/pointer-template.h"
+
+#include <script/class.h>
+#include <script/classbuilder.h>
+#include <script/engine.h>
+#include <script/functionbuilder.h>
+#include <script/interpreter/executioncontext.h>
+#include <script/locals.h>
+#include <script/namespace.h>
+#include <script/operator.h>
+
+// Measures the cost of a native call made through the gonk::bind wrappers
+// and through a hand-written FunctionBuilder callback doing the same work.
+// Each pair is named "<case>/wrapper" and "<case>/raw".
+// The "callable/" runs compare a bound lambda to the function pointer wrappers.
+
+struct Point
+{
+  int x_ = 0;
+  int y_ = 0;
+
+  Point() = default;
+  Point(const Point&) = default;
+  Point(int a, int b) : x_(a), y_(b) { }
+
+  int x() const { return x_; }
+  void reset() { x_ = 0; y_ = 0; }
+
+  Point& operator=(const Point&) = default;
+};
+
+Point operator+(const Point& a, const Point& b)
+{
+  return Point(a.x_ + b.x_, a.y_ + b.y_);
+}
+
+bool operator==(const Point& a, const Point& b)
+{
+  return a.x_ == b.x_ && a.y_ == b.y_;
+}
+
+struct RawPoint : Point
+{
+  using Point::Point;
+};
+
+static int add(int a, int b) { return a + b; }
+static void incr(int& a) { ++a; }
+static int sum_by_value(Point p) { return p.x_ + p.y_; }
+static int sum_by_cref(const Point& p) { return p.x_ + p.y_; }
+static void reset_by_ref(Point& p) { p.reset(); }
+static int x_by_pointer(Point* p) { return p->x_; }
+static int length(const std::string& s) { return static_cast<int>(s.size()); }
+static int length_by_value(std::string s) { return static_cast<int>(s.size()); }
+static int sum8(int a, int b, int c, int d, int e, int f, int g, int h) { return a + b + c + d + e + f + g + h; }
+
+namespace raw
+{
+
+static script::Value add(script::FunctionCall* c)
+{
+  return c->engine()->newInt(c->arg(0).toInt() + c->arg(1).toInt());
+}
+
+static script::Value incr(script::FunctionCall* c)
+{
+  script::get<int>(c->arg(0)) += 1;
+  return script::Value::Void;
+}
+
+static script::Value sum_by_value(script::FunctionCall* c)
+{
+  // the parameter is initialized from the value, as in the wrapper
+  return c->engine()->newInt(::sum_by_value(script::get<Point>(c->arg(0))));
+}
+
+static script::Value sum_by_cref(script::FunctionCall* c)
+{
+  const Point& p = script::get<Point>(c->arg(0));
+  return c->engine()->newInt(p.x_ + p.y_);
+}
+
+static script::Value reset_by_ref(script::FunctionCall* c)
+{
+  script::get<Point>(c->arg(0)).reset();
+  return script::Value::Void;
+}
+
+static script::Value x_by_pointer(script::FunctionCall* c)
+{
+  return c->engine()->newInt(script::get<gonk::Pointer<Point>>(c->arg(0)).ptr->x_);
+}
+
+static script::Value length(script::FunctionCall* c)
+{
+  return c->engine()->newInt(static_cast<int>(c->arg(0).toString().size()));
+}
+
+static script::Value sum8(script::FunctionCall* c)
+{
+  int result = 0;
+  for (int i(0); i < 8; ++i)
+    result += c->arg(i).toInt();
+  return c->engine()->newInt(result);
+}
+
+static script::Value x(script::FunctionCall* c)
+{
+  return c->engine()->newInt(script::get<Point>(c->arg(0)).x());
+}
+
+static script::Value reset(script::FunctionCall* c)
+{
+  script::get<Point>(c->arg(0)).reset();
+  return script::Value::Void;
+}
+
+static script::Value op_add(script::FunctionCall* c)
+{
+  return c->engine()->construct<Point>(script::get<Point>(c->arg(0)) + script::get<Point>(c->arg(1)));
+}
+
+static script::Value op_eq(script::FunctionCall* c)
+{
+  return c->engine()->newBool(script::get<Point>(c->arg(0)) == script::get<Point>(c->arg(1)));
+}
+
+static script::Value default_ctor(script::FunctionCall* c)
+{
+  c->thisObject().init<RawPoint>();
+  return c->arg(0);
+}
+
+static script::Value dtor(script::FunctionCall* c)
+{
+  c->thisObject().destroy<RawPoint>();
+  return script::Value::Void;
+}
+
+} // namespace raw
+
+static void invoke(script::Engine& e, const script::Function& f, script::Locals& args)
+{
+  script::Value result = f.invoke(args.data());
+
+  if (result.type().isObjectType())
+    e.destroy(result);
+}
+
+int main(int argc, char* argv[])
+{
+  using namespace script;
+
+  bench::Suite suite{ argc, argv };
+
+  script::Engine e;
+  e.setup();
+
+  gonk::register_pointer_template(e.rootNamespace());
+
+  Namespace ns = e.rootNamespace();
+
+  Class pt = ns.newClass("Point").setId(e.registerType<Point>().data()).get();
+  gonk::bind::pointer<Point>(&e);
+  gonk::bind::default_constructor<Point>(pt).create();
+  gonk::bind::constructor<Point, const Point&>(pt).create();
+  gonk::bind::destructor<Point>(pt).create();
+
+  Class raw_pt = ns.newClass("RawPoint").setId(e.registerType<RawPoint>().data()).get();
+  FunctionBuilder::Constructor(raw_pt).setCallback(raw::default_ctor).create();
+  FunctionBuilder::Destructor(raw_pt).setCallback(raw::dtor).create();
+
+  const Type pt_type = pt.id();
+  const Type cref_pt = Type::cref(pt_type);
+  const Type ref_pt = Type::ref(pt_type);
+  const Type ptr_type = e.makeType<Point*>();
+
+  struct Case
+  {
+    std::string name;
+    Function wrapper;
+    Function raw;
+  };
+
+  std::vector<Case> cases;
+
+  cases.push_back({ "free/int,int->int",
+    gonk::bind::free_function<int, int, int, &add>(ns, "add").get(),
+    FunctionBuilder::Fun(ns, "raw_add").setCallback(raw::add).returns(Type::Int).params(Type::Int, Type::Int).get() });
+
+  cases.push_back({ "free/int&",
+    gonk::bind::void_function<int&, &incr>(ns, "incr").get(),
+    FunctionBuilder::Fun(ns, "raw_incr").setCallback(raw::incr).params(Type::ref(Type::Int)).get() });
+
+  cases.push_back({ "free/Point(by value)->int",
+    gonk::bind::free_function<int, Point, &sum_by_value>(ns, "sum_by_value").get(),
+    FunctionBuilder::Fun(ns, "raw_sum_by_value").setCallback(raw::sum_by_value).returns(Type::Int).params(pt_type).get() });
+
+  cases.push_back({ "free/const Point&->int",
+    gonk::bind::free_function<int, const Point&, &sum_by_cref>(ns, "sum_by_cref").get(),
+    FunctionBuilder::Fun(ns, "raw_sum_by_cref").setCallback(raw::sum_by_cref).returns(Type::Int).params(cref_pt).get() });
+
+  cases.push_back({ "free/Point&",
+    gonk::bind::void_function<Point&, &reset_by_ref>(ns, "reset_by_ref").get(),
+    FunctionBuilder::Fun(ns, "raw_reset_by_ref").setCallback(raw::reset_by_ref).params(ref_pt).get() });
+
+  cases.push_back({ "free/Point*->int",
+    gonk::bind::free_function<int, Point*, &x_by_pointer>(ns, "x_by_pointer").get(),
+    FunctionBuilder::Fun(ns, "raw_x_by_pointer").setCallback(raw::x_by_pointer).returns(Type::Int).params(ptr_type).get() });
+
+  cases.push_back({ "free/const String&->int",
+    gonk::bind::free_function<int, const std::string&, &length>(ns, "length").get(),
+    FunctionBuilder::Fun(ns, "raw_length").setCallback(raw::length).returns(Type::Int).params(Type::cref(Type::String)).get() });
+
+  cases.push_back({ "free/String(by value)->int",
+    gonk::bind::free_function<&length_by_value>(ns, "length_by_value").get(),
+    FunctionBuilder::Fun(ns, "raw_length_by_value").setCallback(raw::length).returns(Type::Int).params(Type::String).get() });
+
+  cases.push_back({ "free/8 x int->int",
+    gonk::bind::free_function<&sum8>(ns, "sum8").get(),
+    FunctionBuilder::Fun(ns, "raw_sum8").setCallback(raw::sum8).returns(Type::Int)
+      .params(Type::Int, Type::Int, Type::Int, Type::Int, Type::Int, Type::Int, Type::Int, Type::Int).get() });
+
+  cases.push_back({ "member/const->int",
+    gonk::bind::member_function<Point, int, &Point::x>(pt, "x").get(),
+    FunctionBuilder::Fun(pt, "raw_x").setCallback(raw::x).returns(Type::Int).setConst().get() });
+
+  cases.push_back({ "member/const->int (deduced)",
+    gonk::bind::member_function<&Point::x>(pt, "x2").get(),
+    FunctionBuilder::Fun(pt, "raw_x2").setCallback(raw::x).returns(Type::Int).setConst().get() });
+
+  cases.push_back({ "member/void",
+    gonk::bind::void_member_function<Point, &Point::reset>(pt, "reset").get(),
+    FunctionBuilder::Fun(pt, "raw_reset").setCallback(raw::reset).get() });
+
+  cases.push_back({ "operator/+",
+    gonk::bind::op_add<Point, const Point&, const Point&>(ns),
+    FunctionBuilder::Op(ns, AdditionOperator).setCallback(raw::op_add).returns(pt_type).params(cref_pt, cref_pt).get() });
+
+  cases.push_back({ "operator/==",
+    gonk::bind::op_eq<const Point&, const Point&>(ns),
+    FunctionBuilder::Op(ns, EqualOperator).setCallback(raw::op_eq).returns(Type::Boolean).params(cref_pt, cref_pt).get() });
+
+  Point point{ 3, 4 };
+  Point other{ 5, 6 };
+  int counter = 0;
+
+  auto fill_args = [&](const Function& f, Locals& locals) {
+    for (size_t i(0); i < f.prototype().size(); ++i)
+    {
+      const Type t = f.parameter(i);
+
+      if (t.baseType() == Type::Int)
+        locals.push(t.isReference() && !t.isConst() ? e.expose(counter) : e.newInt(static_cast<int>(i) + 1));
+      else if (t.baseType() == Type::String)
+        locals.push(e.newString("hello gonk"));
+      else if (t.baseType() == ptr_type.baseType())
+        locals.push(e.construct<gonk::Pointer<Point>>(gonk::Pointer<Point>(&point)));
+      else
+        locals.push(e.expose(i == 0 ? point : other));
+    }
+  };
+
+  for (const Case& c : cases)
+  {
+    Locals wrapper_args;
+    fill_args(c.wrapper, wrapper_args);
+
+    Locals raw_args;
+    fill_args(c.raw, raw_args);
+
+    suite.run(c.name + "/wrapper", [&]() { invoke(e, c.wrapper, wrapper_args); });
+    suite.run(c.name + "/raw", [&]() { invoke(e, c.raw, raw_args); });
+  }
+
+  // a lambda with captured state against the function pointer paths
+  {
+    struct Context { int offset = 0; } context;
+
+    Function add_callable = gonk::bind::function(ns, "add_callable", [&context](int a, int b) { return a + b + context.offset; });
+    Function add_wrapper_t = gonk::bind::free_function<int, int, int, &add>(ns, "add_wrapper_t").get();
+    Function add_wrapper = gonk::bind::function(ns, "add_wrapper", &add);
+
+    Locals args;
+    fill_args(add_callable, args);
+
+    suite.run("callable/int,int->int/lambda", [&]() { invoke(e, add_callable, args); });
+    suite.run("callable/int,int->int/function_wrapper_t", [&]() { invoke(e, add_wrapper_t, args); });
+    suite.run("callable/int,int->int/FunctionWrapper", [&]() { invoke(e, add_wrapper, args); });
+  }
+
+  const Type raw_pt_type = raw_pt.id();
+
+  suite.run("ctor+dtor/wrapper", [&]() {
+    script::Value v = e.construct(pt_type, std::vector<script::Value>());
+    e.destroy(v);
+  });
+
+  suite.run("ctor+dtor/raw", [&]() {
+    script::Value v = e.construct(raw_pt_type, std::vector<script::Value>());
+    e.destroy(v);
+  });
+
+  bench::do_not_optimize(counter);
+
+  return suite.finish();
+}
@@ -0,0 +1,306 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "bench.h"
+
+#include "gonk-bench-resources.h"
+
+#include "gonk/gonk.h"
+#include "gonk/memstats.h"
+#include "gonk/modules.h"
+
+#include <script/class.h>
+#include <script/classtemplate.h>
+#include <script/engine.h>
+#include <script/module.h>
+#include <script/namelookup.h>
+#include <script/operator.h>
+#include <script/overloadresolution.h>
+#include <script/script.h>
+#include <script/sourcefile.h>
+#include <script/templateargument.h>
+#include <script/typesystem.h>
+
+#include <functional>
+
+// Benchmarks of std.vector, std.map and SemValue.
+//   gonk_bench_containers [bench options] [--native-only | --scripts-only]
+//
+// The native drivers call the container functions through Function::invoke(),
+// the scripts in benchmarks/scripts run the same kind of workloads from gonk
+// code; each of their bench_* functions is one benchmark.
+// Besides the time, the values constructed or copied per operation (counted
+// by gonk::memstats) and the peak RSS after the benchmark are reported.
+
+static const int N = 1000;
+
+class ContainerBench
+{
+public:
+  ContainerBench(bench::Suite& suite, script::Engine& e)
+    : m_suite(suite),
+      m_engine(e)
+  {
+
+  }
+
+  script::Engine& engine() { return m_engine; }
+
+  script::Type instance(const std::string& name, std::vector<script::TemplateArgument> args)
+  {
+    script::Module m = Gonk::Instance().moduleManager().getModule(name == "std::vector" ? "std.vector" : "std.map");
+    auto lookup = script::NameLookup::resolve(name, script::Scope(m.root()));
+    return lookup.classTemplateResult().asClassTemplate().getInstance(std::move(args)).id();
+  }
+
+  script::Function method(const script::Type& t, const std::string& name, const std::vector<script::Type>& args)
+  {
+    script::Class c = m_engine.typeSystem()->getClass(t);
+    auto funcs = script::NameLookup::resolve(name, script::Scope(c)).functions();
+    auto resol = script::resolve_overloads(funcs, args);
+
+    if (!resol)
+      throw std::runtime_error("could not find " + name);
+
+    return resol.function;
+  }
+
+  script::Function op(script::OperatorName name, const script::Type& lhs, const script::Type& rhs)
+  {
+    auto ops = script::NameLookup::resolve(name, lhs, rhs, script::Scope(m_engine.rootNamespace()));
+    auto resol = script::resolve_overloads(ops, std::vector<script::Type>{ lhs, rhs });
+
+    if (!resol)
+      throw std::runtime_error("could not find operator");
+
+    return resol.function;
+  }
+
+  // runs f() once with the value counters enabled, then times it
+  template<typename F>
+  void run(const std::string& name, F&& f, uint64_t ops)
+  {
+    if (!m_suite.enabled(name))
+      return;
+
+    gonk::memstats::reset();
+    gonk::memstats::setEnabled(true);
+    f();
+    gonk::memstats::setEnabled(false);
+
+    const gonk::memstats::TypeCounters counters = gonk::memstats::total();
+
+    bench::Result* r = m_suite.run(name, f, ops);
+
+    if (r)
+    {
+      r->allocs_per_op = static_cast<double>(counters.constructed + counters.copied) / static_cast<double>(ops);
+      r->peak_rss_kb = gonk::memstats::peak_rss();
+    }
+  }
+
+  void vector(const std::string& elem_name, const script::Type& elem, std::function<script::Value(int)> make)
+  {
+    script::Engine& e = m_engine;
+
+    const script::Type vec = instance("std::vector", { script::TemplateArgument(elem) });
+    const std::string prefix = "native/vector<" + elem_name + ">/";
+
+    script::Function push_back = method(vec, "push_back", { script::Type::ref(vec), script::Type::cref(elem) });
+    script::Function at = method(vec, "at", { script::Type::cref(vec), script::Type::Int });
+    script::Function eq = op(script::EqualOperator, script::Type::cref(vec), script::Type::cref(vec));
+
+    std::vector<script::Value> values;
+    for (int i(0); i < N; ++i)
+      values.push_back(make(i));
+
+    std::vector<script::Value> indices;
+    for (int i(0); i < N; ++i)
+      indices.push_back(e.newInt((i * 7919) % N));
+
+    script::Value filled = e.construct(vec, std::vector<script::Value>());
+    for (const script::Value& v : values)
+      push_back.invoke({ filled, v });
+
+    run(prefix + "push_back", [&]() {
+      script::Value v = e.construct(vec, std::vector<script::Value>());
+      for (const script::Value& x : values)
+        push_back.invoke({ v, x });
+      e.destroy(v);
+      }, N);
+
+    run(prefix + "at", [&]() {
+      for (const script::Value& i : indices)
+      {
+        script::Value x = at.invoke({ filled, i });
+        e.destroy(x);
+      }
+      }, N);
+
+    run(prefix + "copy", [&]() {
+      script::Value v = e.copy(filled);
+      e.destroy(v);
+      }, N);
+
+    script::Value other = e.copy(filled);
+
+    run(prefix + "equality", [&]() {
+      script::Value b = eq.invoke({ filled, other });
+      bench::do_not_optimize(b.toBool());
+      }, N);
+
+    e.destroy(other);
+    e.destroy(filled);
+
+    for (script::Value& v : values)
+      e.destroy(v);
+  }
+
+  void map(const std::string& elem_name, const script::Type& elem, std::function<script::Value(int)> make)
+  {
+    script::Engine& e = m_engine;
+
+    const script::Type map = instance("std::map", { script::TemplateArgument(script::Type::Int), script::TemplateArgument(elem) });
+    const std::string prefix = "native/map<int," + elem_name + ">/";
+
+    script::Function subscript = op(script::SubscriptOperator, script::Type::ref(map), script::Type::cref(script::Type::Int));
+    script::Function count = method(map, "count", { script::Type::cref(map), script::Type::cref(script::Type::Int) });
+    script::Function erase = method(map, "erase", { script::Type::ref(map), script::Type::cref(script::Type::Int) });
+    script::Function assign = op(script::AssignmentOperator, script::Type::ref(elem), script::Type::cref(elem));
+
+    std::vector<script::Value> values;
+    for (int i(0); i < N; ++i)
+      values.push_back(make(i));
+
+    std::vector<script::Value> keys;
+    for (int i(0); i < N; ++i)
+      keys.push_back(e.newInt((i * 7919) % N));
+
+    auto fill = [&](const script::Value& m) {
+      for (int i(0); i < N; ++i)
+      {
+        script::Value ref = subscript.invoke({ m, keys[i] });
+        assign.invoke({ ref, values[i] });
+      }
+    };
+
+    run(prefix + "insert", [&]() {
+      script::Value m = e.construct(map, std::vector<script::Value>());
+      fill(m);
+      e.destroy(m);
+      }, N);
+
+    script::Value filled = e.construct(map, std::vector<script::Value>());
+    fill(filled);
+
+    run(prefix + "lookup", [&]() {
+      for (const script::Value& k : keys)
+        bench::do_not_optimize(count.invoke({ filled, k }).toInt());
+      }, N);
+
+    run(prefix + "insert+erase", [&]() {
+      script::Value m = e.construct(map, std::vector<script::Value>());
+      fill(m);
+      for (const script::Value& k : keys)
+        erase.invoke({ m, k });
+      e.destroy(m);
+      }, N);
+
+    e.destroy(filled);
+
+    for (script::Value& v : values)
+      e.destroy(v);
+  }
+
+  void scripts(const script::Script& s)
+  {
+    for (const script::Function& f : s.functions())
+    {
+      if (f.name().rfind("bench_", 0) != 0 || f.prototype().size() != 0)
+        continue;
+
+      const script::Type rtype = f.returnType();
+      const bool owns_result = rtype.baseType() != script::Type::Void && !rtype.isReference();
+
+      run("script/" + f.name().substr(6), [&]() {
+        script::Value ret = f.invoke({});
+
+        if (owns_result)
+          m_engine.destroy(ret);
+        }, 1);
+    }
+  }
+
+private:
+  bench::Suite& m_suite;
+  script::Engine& m_engine;
+};
+
+int main(int argc, char* argv[])
+{
+  bench::Suite suite{ argc, argv };
+
+  bool native = true;
+  bool scripts = true;
+
+  for (const std::string& arg : suite.extraArgs())
+  {
+    if (arg == "--native-only")
+      scripts = false;
+    else if (arg == "--scripts-only")
+      native = false;
+  }
+
+  std::string gonk_str = "gonk";
+  int gonk_argc = 1;
+  char* gonk_argv[1] = { gonk_str.data() };
+
+  Gonk gonk{ gonk_argc, gonk_argv };
+  gonk.moduleManager().addImportPath(gonk_build_path() + std::string("modules"));
+  gonk.moduleManager().fetchModules();
+
+  script::Engine& e = *gonk.scriptEngine();
+
+  script::SourceFile src{ gonk_bench_scripts_path() + std::string("containers.gnk") };
+  src.load();
+
+  script::Script s = e.newScript(src);
+
+  if (!s.compile(script::CompileMode::Release))
+  {
+    for (const auto& m : s.messages())
+      std::cerr << m.to_string() << std::endl;
+
+    return 1;
+  }
+
+  s.run();
+
+  ContainerBench b{ suite, e };
+
+  if (native)
+  {
+    script::Type item = script::NameLookup::resolve("Item", script::Scope(s.rootNamespace())).typeResult();
+
+    auto make_int = [&e](int i) { return e.newInt(i); };
+    auto make_double = [&e](int i) { return e.newDouble(i * 0.5); };
+    auto make_string = [&e](int i) { return e.newString("element #" + std::to_string(i)); };
+    auto make_item = [&e, item](int i) { return e.construct(item, std::vector<script::Value>{ e.newInt(i) }); };
+
+    b.vector("int", script::Type::Int, make_int);
+    b.vector("double", script::Type::Double, make_double);
+    b.vector("String", script::Type::String, make_string);
+    b.vector("Item", item, make_item);
+
+    b.map("int", script::Type::Int, make_int);
+    b.map("double", script::Type::Double, make_double);
+    b.map("String", script::Type::String, make_string);
+    b.map("Item", item, make_item);
+  }
+
+  if (scripts)
+    b.scripts(s);
+
+  return suite.finish();
+}
@@ -0,0 +1,126 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "bench.h"
+
+#include "gonk/lazy-members.h"
+
+#include <script/class.h>
+#include <script/classbuilder.h>
+#include <script/engine.h>
+#include <script/functionbuilder.h>
+#include <script/namespace.h>
+
+#include <chrono>
+
+// Measures the time needed to register a synthetic class with many member
+// functions, eagerly and through gonk::LazyMembers.
+// A run is one "load" of the class in a fresh engine followed by the
+// demand of the few members used by a typical script; the best of 5 loads
+// is reported.
+//   gonk_bench_lazy [bench options] [--methods <count>]
+
+static script::Value get_zero(script::FunctionCall* c)
+{
+  return c->engine()->newInt(0);
+}
+
+static void create_method(script::Class& cla, const std::string& name)
+{
+  script::FunctionBuilder::Fun(cla, name).setConst().returns(script::Type::Int).setCallback(get_zero).create();
+}
+
+static std::string method_name(int i)
+{
+  return "m" + std::to_string(i);
+}
+
+static const char* used_members = "Widget w; int n = w.m0() + w.m10() + w.m100() + w.m1000();";
+
+template<typename F>
+static double measure(F&& load)
+{
+  using clock = std::chrono::steady_clock;
+
+  double best = -1;
+
+  for (int rep(0); rep < 5; ++rep)
+  {
+    script::Engine e;
+    e.setup();
+
+    script::Class cla = e.rootNamespace().newClass("Widget").get();
+
+    auto start = clock::now();
+    load(e, cla);
+    double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+    if (best < 0 || ns < best)
+      best = ns;
+
+    gonk::LazyMembers::release(&e);
+    e.tearDown();
+  }
+
+  return best;
+}
+
+int main(int argc, char* argv[])
+{
+  bench::Suite suite{ argc, argv };
+
+  int count = 5000;
+
+  for (size_t i(0); i + 1 < suite.extraArgs().size(); ++i)
+  {
+    if (suite.extraArgs().at(i) == "--methods")
+      count = std::stoi(suite.extraArgs().at(i + 1));
+  }
+
+  std::vector<std::string> names;
+
+  for (int i(0); i < count; ++i)
+    names.push_back(method_name(i));
+
+  const std::string suffix = "/" + std::to_string(count) + "-methods";
+
+  auto report = [&suite](const std::string& name, double ns) {
+    if (!suite.enabled(name))
+      return;
+
+    bench::Result r;
+    r.name = name;
+    r.ns_per_op = ns;
+    r.iterations = 1;
+    suite.add(r);
+
+    std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(1)
+      << std::setw(12) << ns / 1000.0 << " us/load" << std::defaultfloat << std::endl;
+  };
+
+  report("load/eager" + suffix, measure([&names](script::Engine&, script::Class& cla) {
+    for (const std::string& n : names)
+      create_method(cla, n);
+  }));
+
+  report("load/lazy" + suffix, measure([&names](script::Engine& e, script::Class& cla) {
+    gonk::LazyMembers& lazy = gonk::LazyMembers::of(&e);
+
+    for (const std::string& n : names)
+      lazy.add(cla, n, create_method);
+
+    lazy.demandSource(used_members);
+  }));
+
+  report("load/lazy-all" + suffix, measure([&names](script::Engine& e, script::Class& cla) {
+    gonk::LazyMembers& lazy = gonk::LazyMembers::of(&e);
+
+    for (const std::string& n : names)
+      lazy.add(cla, n, create_method);
+
+    lazy.materializeAll();
+  }));
+
+  return suite.finish();
+}
@@ -36,6 +36,19 @@ public:
   bool list_modules = false;
   bool debug = false;
   bool debugbuild = false;
+  bool debug_attach = false;
+  std::optional<int> debug_port;
+  std::optional<std::string> debug_socket;
+  std::optional<std::string> profile;
+  std::optional<std::string> trace;
+  std::optional<int> sample_profile;
+  std::string sample_profile_output = "gonk-sample-profile";
+  std::optional<std::string> coverage;
+  bool coverage_counts = false;
+  bool memstats = false;
+  bool copy_audit = false;
+  bool bench = false;
+  std::optional<std::string> bench_filter;
   std::optional<std::string> script;
   std::vector<std::string> extras;
 
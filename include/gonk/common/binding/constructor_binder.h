@@ -6,6 +6,7 @@
 #define GONK_BINDING_CONSTRUCTOR_BINDER_H
 
 #include "gonk/common/values.h"
+#include "gonk/memstats.h"
 
 #include <script/interpreter/executioncontext.h>
 
@@ -26,7 +27,12 @@ struct constructor_binder
 
   static script::Value copy_ctor(script::FunctionCall *c)
   {
-    c->thisObject().init<T>(value_cast<const T&>(c->arg(1)));
+    {
+      memstats::CopyScope scope;
+      c->thisObject().init<T>(value_cast<const T&>(c->arg(1)));
+    }
+
+    memstats::count(memstats::Copy, c->thisObject());
     return c->arg(0);
   }
 
@@ -19,6 +19,23 @@ namespace gonk
 namespace bind
 {
 
+/* Any function, the signature is deduced from F */
+
+template<auto F>
+script::FunctionBuilder free_function(script::Namespace & ns, std::string && name)
+{
+  using traits = wrapper::callable_traits<decltype(F)>;
+  static_assert(!traits::is_member, "free_function() expects a pointer to a free function");
+
+  auto* e = ns.engine();
+  script::FunctionBuilder builder = script::FunctionBuilder::Fun(ns, std::move(name)).setCallback(wrapper::function_wrapper_t<decltype(F), F>::wrap);
+
+  if constexpr (!std::is_void<typename traits::return_type>::value)
+    builder.returns(make_type<typename traits::return_type>(e));
+
+  return traits::invoker_type::params(builder, e);
+}
+
 /* Non-void functions */
 
 template<typename R, R(*F)()>
@@ -144,6 +161,27 @@ script::Function function(script::Class& cla, std::string name, T(*fun)(Args...)
   return ret;
 }
 
+/* callable objects, e.g. a lambda capturing some context; the object is moved into the function */
+
+template<typename F, typename = typename std::enable_if<std::is_class<typename std::decay<F>::type>::value>::type>
+script::Function function(script::Namespace& ns, std::string name, F&& fun)
+{
+  auto impl = std::make_shared<gonk::wrapper::CallableWrapper<typename std::decay<F>::type>>(script::Symbol{ ns }, std::move(name), std::forward<F>(fun));
+  script::Function ret{ impl };
+  ns.addFunction(ret);
+  return ret;
+}
+
+template<typename F, typename = typename std::enable_if<std::is_class<typename std::decay<F>::type>::value>::type>
+script::Function function(script::Class& cla, std::string name, F&& fun)
+{
+  auto impl = std::make_shared<gonk::wrapper::CallableWrapper<typename std::decay<F>::type>>(script::Symbol{ cla }, std::move(name), std::forward<F>(fun));
+  impl->setMember(true);
+  script::Function ret{ impl };
+  cla.addFunction(ret);
+  return ret;
+}
+
 } // namespace bind
 
 } // namespace gonk
@@ -19,6 +19,26 @@ namespace gonk
 namespace bind
 {
 
+/* Any non-static member function, the signature is deduced from F */
+
+template<auto F>
+script::FunctionBuilder member_function(script::Class& cla, std::string name)
+{
+  using traits = wrapper::callable_traits<decltype(F)>;
+  static_assert(traits::is_member, "member_function() expects a pointer to a member function");
+
+  script::Engine* e = cla.engine();
+  script::FunctionBuilder builder = script::FunctionBuilder::Fun(cla, std::move(name)).setCallback(wrapper::member_wrapper_t<decltype(F), F>::wrap);
+
+  if constexpr (!std::is_void<typename traits::return_type>::value)
+    builder.returns(make_type<typename traits::return_type>(e));
+
+  if constexpr (traits::is_const)
+    builder.setConst();
+
+  return traits::invoker_type::params(builder, e);
+}
+
 /* Non-void non-static non-const member functions */
 
 template<typename T, typename R, R(T::*F)()>
@@ -399,6 +419,20 @@ script::Function method(script::Class& cla, std::string name, R(*fn)(const T&, A
   return ret;
 }
 
+// callable object taking the object as first parameter, e.g. [ctx](Point& self, int n) { ... }
+template<typename F, typename = typename std::enable_if<std::is_class<typename std::decay<F>::type>::value>::type>
+script::Function method(script::Class& cla, std::string name, F&& fn)
+{
+  using wrapper_t = gonk::wrapper::CallableWrapper<typename std::decay<F>::type>;
+  static_assert(wrapper_t::traits::arity >= 1, "the callable must take the object as first parameter");
+
+  auto impl = std::make_shared<wrapper_t>(script::Symbol(cla), std::move(name), std::forward<F>(fn));
+  impl->setMember(false);
+  script::Function ret{ impl };
+  cla.addMethod(ret);
+  return ret;
+}
+
 } // namespace bind
 
 } // namespace gonk
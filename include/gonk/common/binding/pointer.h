@@ -9,6 +9,8 @@
 
 #include "gonk/common/binding/class.h"
 #include "gonk/common/binding/conversion.h"
+#include "gonk/common/binding/memberfunction.h"
+#include "gonk/common/binding/operators.h"
 
 #include <script/classtemplate.h>
 #include <script/classtemplatespecializationbuilder.h>
@@ -43,8 +45,8 @@ void pointer(script::Engine* e)
 
   // Pointer<T>();
   gonk::bind::default_constructor<PointerType>(ptr_type).create();
-  // Pointer<T>(const Pointer<T> &);
-  gonk::bind::copy_constructor<Pointer<T>>(ptr_type).create();
+  // Pointer<T>(const Pointer<T> &), copying a handle is not a deep copy
+  gonk::bind::constructor<Pointer<T>, const Pointer<T>&>(ptr_type).create();
   // ~Pointer<T>();
   gonk::bind::destructor<Pointer<T>>(ptr_type).create();
 
@@ -53,6 +55,21 @@ void pointer(script::Engine* e)
 
   // operator T&() const;
   gonk::bind::conversion<const Pointer<T>, T&>(ptr_type);
+
+  // Pointer<T>& operator=(const Pointer<T>&);
+  gonk::bind::memop_assign<PointerType, const PointerType&>(ptr_type);
+  // T& get() const;
+  gonk::bind::member_function<&PointerType::get>(ptr_type, "get").create();
+  // bool isNull() const;
+  gonk::bind::member_function<&PointerType::isNull>(ptr_type, "isNull").create();
+  // void reset();
+  gonk::bind::member_function<&PointerType::reset>(ptr_type, "reset").create();
+  // bool operator==(const Pointer<T>&) const;
+  gonk::bind::memop_eq<PointerType, const PointerType&>(ptr_type);
+  // bool operator!=(const Pointer<T>&) const;
+  gonk::bind::memop_neq<PointerType, const PointerType&>(ptr_type);
+  // bool operator<(const Pointer<T>&) const;
+  gonk::bind::memop_less<PointerType, const PointerType&>(ptr_type);
 }
 
 } // namespace bind
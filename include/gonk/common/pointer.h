@@ -9,9 +9,15 @@
 
 #include <script/engine.h>
 
+#include <functional>
+
 namespace gonk
 {
 
+/*!
+ * \class Pointer
+ * \brief non-owning reference to a native value, 'Pointer<T>' in the scripts
+ */
 template<typename T>
 class Pointer
 {
@@ -43,14 +49,48 @@ public:
   }
 
   operator T& () const
+  {
+    return get();
+  }
+
+  T& get() const
   {
     if (!this->ptr)
       throw script::RuntimeError{"bad pointer access"};
 
     return *(this->ptr);
   }
+
+  bool isNull() const
+  {
+    return this->ptr == nullptr;
+  }
+
+  void reset()
+  {
+    this->ptr = nullptr;
+  }
 };
 
+template<typename T>
+bool operator==(const Pointer<T>& lhs, const Pointer<T>& rhs)
+{
+  return lhs.ptr == rhs.ptr;
+}
+
+template<typename T>
+bool operator!=(const Pointer<T>& lhs, const Pointer<T>& rhs)
+{
+  return lhs.ptr != rhs.ptr;
+}
+
+// orders pointers by address, so that they can be stored in containers
+template<typename T>
+bool operator<(const Pointer<T>& lhs, const Pointer<T>& rhs)
+{
+  return std::less<T*>()(lhs.ptr, rhs.ptr);
+}
+
 } // namespace gonk
 
 namespace script {
@@ -33,6 +33,8 @@ struct GONK_API TypeInfo : public script::UserData
   static script::Function get_eq(script::Engine* e, const script::Type& t);
   static script::Function get_less(script::Engine* e, const script::Type& t);
   static script::Function get_assign(script::Engine* e, const script::Type& t);
+  // null if the type has no hash() function
+  static script::Function get_hash(script::Engine* e, const script::Type& t);
   static std::shared_ptr<TypeInfo> get(script::Engine *e, const script::Type & t);
 };
 
@@ -0,0 +1,112 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_COMMONS_SPAN_H
+#define GONK_COMMONS_SPAN_H
+
+#include <script/engine.h>
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace gonk
+{
+
+/*!
+ * \class Span
+ * \brief non-owning view of the elements of a std::vector<T>
+ *
+ * A Span<const T> parameter of a bound function is a 'const std::vector<T>&'
+ * for the scripts, a Span<T> is a 'std::vector<T>&'; the elements are not
+ * copied. Only vectors with a native storage (e.g. std::vector<int>,
+ * std::vector<double>) can be viewed.
+ */
+template<typename T>
+class Span
+{
+public:
+  using element_type = T;
+  using value_type = typename std::remove_const<T>::type;
+  using vector_type = std::vector<value_type>;
+
+  static_assert(!std::is_same<value_type, bool>::value, "std::vector<bool> has no contiguous storage");
+
+public:
+  Span() = default;
+  Span(const Span<T>&) = default;
+  ~Span() = default;
+
+  Span(T* data, size_t size)
+    : m_data(data),
+      m_size(size)
+  {
+
+  }
+
+  template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value || std::is_same<U, T>::value>::type>
+  Span(std::vector<U>& vec)
+    : m_data(vec.data()),
+      m_size(vec.size())
+  {
+
+  }
+
+  template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+  Span(const std::vector<U>& vec)
+    : m_data(vec.data()),
+      m_size(vec.size())
+  {
+
+  }
+
+  T* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  T* begin() const { return m_data; }
+  T* end() const { return m_data + m_size; }
+
+  T& operator[](size_t i) const { return m_data[i]; }
+
+  Span<T> subspan(size_t offset, size_t count) const
+  {
+    return Span<T>(m_data + offset, count);
+  }
+
+  Span<T>& operator=(const Span<T>&) = default;
+
+private:
+  T* m_data = nullptr;
+  size_t m_size = 0;
+};
+
+// the storage of the 'std::bytes' type of the std.vector module
+using Bytes = std::vector<unsigned char>;
+
+// read-only view of raw memory, e.g. a 'const std::bytes&' parameter
+using BufferView = Span<const unsigned char>;
+
+template<typename T>
+struct is_span : std::false_type { };
+
+template<typename T>
+struct is_span<Span<T>> : std::true_type { };
+
+template<typename T>
+struct is_span<const T> : is_span<T> { };
+
+} // namespace gonk
+
+namespace script {
+template<typename T> struct maketype_helper<gonk::Span<T>> {
+  inline static script::Type get(const Engine& e)
+  {
+    script::Type t = e.getType<typename gonk::Span<T>::vector_type>();
+    return std::is_const<T>::value ? script::Type::cref(t) : script::Type::ref(t);
+  }
+};
+} // namespace script
+
+#endif // GONK_COMMONS_SPAN_H
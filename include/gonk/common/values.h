@@ -8,8 +8,11 @@
 #include "gonk/common/dependent-false.h"
 #include "gonk/common/enums.h"
 #include "gonk/common/pointer.h"
+#include "gonk/common/span.h"
 #include "gonk/common/types.h"
 
+#include "gonk/memstats.h"
+
 #include <script/engine.h>
 #include <script/value.h>
 
@@ -23,7 +26,9 @@ script::Value make_value(T&& val, script::Engine* e)
 {
   if constexpr (!std::is_const<T>::value && !std::is_reference<T>::value && !std::is_pointer<T>::value)
   {
-    return e->construct<T>(std::forward<T>(val));
+    script::Value result = e->construct<T>(std::forward<T>(val));
+    memstats::count(memstats::Construct, result);
+    return result;
   }
   else if constexpr (std::is_lvalue_reference<T>::value && !std::is_const<T>::value)
   {
@@ -31,15 +36,21 @@ script::Value make_value(T&& val, script::Engine* e)
   }
   else if constexpr (std::is_rvalue_reference<T>::value)
   {
-    return e->construct<std::remove_reference<T>>(std::forward<T>(val)); // not sure about this one
+    script::Value result = e->construct<typename std::remove_reference<T>::type>(std::forward<T>(val));
+    memstats::count(memstats::Construct, result);
+    return result;
   }
   else if constexpr (std::is_pointer<T>::value && !std::is_const<typename std::remove_pointer<T>::type>::value)
   {
-    return e->construct<gonk::Pointer<std::remove_pointer_t<T>>>(std::forward<T>(val));
+    script::Value result = e->construct<gonk::Pointer<std::remove_pointer_t<T>>>(std::forward<T>(val));
+    memstats::count(memstats::Construct, result);
+    return result;
   }
   else if constexpr (std::is_const<T>::value && !std::is_reference<T>::value && !std::is_pointer<T>::value) // const U
   {
-    return e->construct<typename std::remove_const<T>::type>(std::forward<T>(val));
+    script::Value result = e->construct<typename std::remove_const<T>::type>(std::forward<T>(val));
+    memstats::count(memstats::Construct, result);
+    return result;
   }
   else
   {
@@ -55,13 +66,17 @@ namespace gonk
 template<typename T>
 T value_cast(const script::Value& val)
 {
-  if constexpr (!std::is_const<T>::value && !std::is_reference<T>::value && !std::is_pointer<T>::value)
+  if constexpr (is_span<T>::value)
+  {
+    return T(script::get<typename T::vector_type>(val));
+  }
+  else if constexpr (!std::is_const<T>::value && !std::is_reference<T>::value && !std::is_pointer<T>::value)
   {
     return script::get<T>(val);
   }
   else if constexpr (std::is_lvalue_reference<T>::value)
   {
-    return script::get<typename std::remove_reference<typename std::remove_const<T>::type>::type>(val);
+    return script::get<typename std::remove_const<typename std::remove_reference<T>::type>::type>(val);
   }
   else if constexpr (std::is_rvalue_reference<T>::value)
   {
@@ -77,6 +92,28 @@ T value_cast(const script::Value& val)
   }
 }
 
+/*!
+ * \brief converts an argument of a native call to the type of a C++ parameter
+ *
+ * Unlike value_cast(), a class passed by value is returned by reference:
+ * the object is copied only once, when the parameter of the C++ function
+ * is initialized. References, pointers and spans are borrowed from the value.
+ */
+template<typename T>
+using arg_t = typename std::conditional<std::is_class<typename std::remove_const<T>::type>::value && !std::is_reference<T>::value && !is_span<T>::value,
+  const typename std::remove_const<T>::type&, T>::type;
+
+template<typename T>
+arg_t<T> arg_cast(const script::Value& val)
+{
+  if constexpr (std::is_reference<T>::value || std::is_pointer<T>::value || is_span<T>::value)
+    return value_cast<T>(val);
+  else if constexpr (std::is_class<typename std::remove_const<T>::type>::value)
+    return script::get<typename std::remove_const<T>::type>(val);
+  else
+    return value_cast<typename std::remove_const<T>::type>(val);
+}
+
 } // namespace gonk
 
 #endif // GONK_COMMONS_VALUES_H
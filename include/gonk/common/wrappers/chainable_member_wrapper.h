@@ -6,6 +6,8 @@
 #define GONK_WRAPPERS_CHAINABLE_MEMBER_FUN_WRAPPER_H
 
 #include "gonk/common/values.h"
+#include "gonk/common/wrappers/invoker.h"
+#include "gonk/instrumentation.h"
 
 #include <script/interpreter/executioncontext.h>
 
@@ -22,57 +24,12 @@ namespace wrapper
 template<typename MemberType, MemberType f>
 struct chainable_member_wrapper_t;
 
-template<typename ClassType, typename A1, ClassType&(ClassType::*F)(A1)>
-struct chainable_member_wrapper_t<ClassType&(ClassType::*)(A1), F> {
+template<typename ClassType, typename... Args, ClassType&(ClassType::*F)(Args...)>
+struct chainable_member_wrapper_t<ClassType&(ClassType::*)(Args...), F> {
   static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)));
-         return c->thisObject();
-    //return make_value<ClassType&>(((ref).*(F))(value_cast<A1>(c->arg(1))), c->engine());
-  }
-};
-
-template<typename ClassType, typename A1, typename A2, ClassType&(ClassType::*F)(A1, A2)>
-struct chainable_member_wrapper_t<ClassType&(ClassType::*)(A1, A2), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)));
-    return c->thisObject();
-  }
-};
-
-template<typename ClassType, typename A1, typename A2, typename A3, ClassType&(ClassType::*F)(A1, A2, A3)>
-struct chainable_member_wrapper_t<ClassType&(ClassType::*)(A1, A2, A3), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)));
-    return c->thisObject();
-  }
-};
-
-template<typename ClassType, typename A1, typename A2, typename A3, typename A4, ClassType&(ClassType::*F)(A1, A2, A3, A4)>
-struct chainable_member_wrapper_t<ClassType&(ClassType::*)(A1, A2, A3, A4), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)));
-    return c->thisObject();
-  }
-};
-
-template<typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, ClassType&(ClassType::*F)(A1, A2, A3, A4, A5)>
-struct chainable_member_wrapper_t<ClassType&(ClassType::*)(A1, A2, A3, A4, A5), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)));
-    return c->thisObject();
-  }
-};
-
-template<typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, ClassType&(ClassType::*F)(A1, A2, A3, A4, A5, A6)>
-struct chainable_member_wrapper_t<ClassType&(ClassType::*)(A1, A2, A3, A4, A5, A6), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)), value_cast<A6>(c->arg(6)));
+    NativeCallScope scope{ c };
+    ClassType& ref = value_cast<ClassType&>(c->arg(0));
+    invoker<void, Args...>::template call<1>(c, F, ref);
     return c->thisObject();
   }
 };
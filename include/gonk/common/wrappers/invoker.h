@@ -0,0 +1,115 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_WRAPPERS_INVOKER_H
+#define GONK_WRAPPERS_INVOKER_H
+
+#include "gonk/common/values.h"
+
+#include <script/interpreter/executioncontext.h>
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace gonk
+{
+
+namespace wrapper
+{
+
+/*!
+ * \class invoker
+ * \brief calls a C++ callable with the arguments of a native call
+ *
+ * The arguments of the call, starting at arg(Offset), are converted with
+ * arg_cast() and passed after the bound arguments (e.g. the object of a
+ * member function); the result is converted with make_value().
+ */
+template<typename R, typename... Args>
+struct invoker
+{
+  template<std::size_t Offset, typename F, typename... Bound>
+  static script::Value call(script::FunctionCall* c, F&& f, Bound&&... bound)
+  {
+    return call_seq<Offset>(c, std::index_sequence_for<Args...>{}, std::forward<F>(f), std::forward<Bound>(bound)...);
+  }
+
+  // adds the parameters to a script::FunctionBuilder
+  template<typename Builder>
+  static Builder& params(Builder& builder, script::Engine* e)
+  {
+    if constexpr (sizeof...(Args) > 0)
+      builder.params(make_type<Args>(e)...);
+
+    return builder;
+  }
+
+  // sets the return type and the parameters of a script::DynamicPrototype
+  template<typename Proto>
+  static void fill(Proto& proto, script::Engine* e)
+  {
+    proto.setReturnType(make_type<R>(e));
+    proto.set({ make_type<Args>(e)... });
+  }
+
+  template<std::size_t Offset, std::size_t... Is, typename F, typename... Bound>
+  static script::Value call_seq(script::FunctionCall* c, std::index_sequence<Is...>, F&& f, Bound&&... bound)
+  {
+    if constexpr (std::is_void<R>::value)
+    {
+      std::invoke(std::forward<F>(f), std::forward<Bound>(bound)..., arg_cast<Args>(c->arg(Is + Offset))...);
+      return script::Value::Void;
+    }
+    else
+    {
+      return make_value<R>(std::invoke(std::forward<F>(f), std::forward<Bound>(bound)..., arg_cast<Args>(c->arg(Is + Offset))...), c->engine());
+    }
+  }
+};
+
+/*!
+ * \class callable_traits
+ * \brief decomposes the type of a function or member function pointer
+ */
+template<typename F>
+struct callable_traits;
+
+template<typename R, typename... Args>
+struct callable_traits<R(*)(Args...)>
+{
+  using return_type = R;
+  using invoker_type = invoker<R, Args...>;
+  static constexpr bool is_member = false;
+  static constexpr bool is_const = false;
+  static constexpr std::size_t arity = sizeof...(Args);
+};
+
+template<typename R, typename T, typename... Args>
+struct callable_traits<R(T::*)(Args...)>
+{
+  using return_type = R;
+  using class_type = T;
+  using invoker_type = invoker<R, Args...>;
+  static constexpr bool is_member = true;
+  static constexpr bool is_const = false;
+  static constexpr std::size_t arity = sizeof...(Args);
+};
+
+template<typename R, typename T, typename... Args>
+struct callable_traits<R(T::*)(Args...)const>
+{
+  using return_type = R;
+  using class_type = T;
+  using invoker_type = invoker<R, Args...>;
+  static constexpr bool is_member = true;
+  static constexpr bool is_const = true;
+  static constexpr std::size_t arity = sizeof...(Args);
+};
+
+} // namespace wrapper
+
+} // namespace gonk
+
+#endif // GONK_WRAPPERS_INVOKER_H
@@ -6,6 +6,8 @@
 #define GONK_WRAPPERS_MEMBER_FUN_WRAPPER_H
 
 #include "gonk/common/values.h"
+#include "gonk/common/wrappers/invoker.h"
+#include "gonk/instrumentation.h"
 
 #include <script/interpreter/executioncontext.h>
 #include <script/function-impl.h>
@@ -20,167 +22,24 @@ namespace wrapper
 Non-void member functions
 ****************************************************************/
 
-
 template<typename MemberType, MemberType f>
 struct member_wrapper_t;
 
-template<typename R, typename ClassType, R(ClassType::*F)()const>
-struct member_wrapper_t<R(ClassType::*)()const, F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, R(ClassType::*F)()>
-struct member_wrapper_t<R(ClassType::*)(), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, R(ClassType::*F)(A1)const>
-struct member_wrapper_t<R(ClassType::*)(A1)const, F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, R(ClassType::*F)(A1)>
-struct member_wrapper_t<R(ClassType::*)(A1), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, R(ClassType::*F)(A1, A2)const>
-struct member_wrapper_t<R(ClassType::*)(A1, A2)const, F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, R(ClassType::*F)(A1, A2)>
-struct member_wrapper_t<R(ClassType::*)(A1, A2), F> {
+template<typename R, typename ClassType, typename... Args, R(ClassType::*F)(Args...)const>
+struct member_wrapper_t<R(ClassType::*)(Args...)const, F> {
   static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, R(ClassType::*F)(A1, A2, A3)const>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3)const, F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, R(ClassType::*F)(A1, A2, A3)>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, R(ClassType::*F)(A1, A2, A3, A4)const>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4)const, F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, R(ClassType::*F)(A1, A2, A3, A4)>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, R(ClassType::*F)(A1, A2, A3, A4, A5)const>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4, A5)const, F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, R(ClassType::*F)(A1, A2, A3, A4, A5)>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4, A5), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, R(ClassType::*F)(A1, A2, A3, A4, A5, A6)const>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4, A5, A6)const, F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)), value_cast<A6>(c->arg(6))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, R(ClassType::*F)(A1, A2, A3, A4, A5, A6)>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4, A5, A6), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)), value_cast<A6>(c->arg(6))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, R(ClassType::*F)(A1, A2, A3, A4, A5, A6, A7)const>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4, A5, A6, A7)const, F> {
-  static script::Value wrap(script::FunctionCall* c) {
-    const ClassType& ref = value_cast<const ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)), value_cast<A6>(c->arg(6)), value_cast<A7>(c->arg(7))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, R(ClassType::*F)(A1, A2, A3, A4, A5, A6, A7)>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4, A5, A6, A7), F> {
-  static script::Value wrap(script::FunctionCall* c) {
-    ClassType& ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)), value_cast<A6>(c->arg(6)), value_cast<A7>(c->arg(7))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, R(ClassType::* F)(A1, A2, A3, A4, A5, A6, A7, A8)const>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4, A5, A6, A7, A8)const, F> {
-  static script::Value wrap(script::FunctionCall* c) {
+    NativeCallScope scope{ c };
     const ClassType& ref = value_cast<const ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)), value_cast<A6>(c->arg(6)), value_cast<A7>(c->arg(7)), value_cast<A8>(c->arg(8))), c->engine());
+    return invoker<R, Args...>::template call<1>(c, F, ref);
   }
 };
 
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, R(ClassType::* F)(A1, A2, A3, A4, A5, A6, A7, A8)>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4, A5, A6, A7, A8), F> {
-  static script::Value wrap(script::FunctionCall* c) {
-    ClassType& ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)), value_cast<A6>(c->arg(6)), value_cast<A7>(c->arg(7)), value_cast<A8>(c->arg(8))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, R(ClassType::* F)(A1, A2, A3, A4, A5, A6, A7, A8, A9)const>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4, A5, A6, A7, A8, A9)const, F> {
-  static script::Value wrap(script::FunctionCall* c) {
-    const ClassType& ref = value_cast<const ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)), value_cast<A6>(c->arg(6)), value_cast<A7>(c->arg(7)), value_cast<A8>(c->arg(8)), value_cast<A9>(c->arg(9))), c->engine());
-  }
-};
-
-template<typename R, typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, R(ClassType::* F)(A1, A2, A3, A4, A5, A6, A7, A8, A9)>
-struct member_wrapper_t<R(ClassType::*)(A1, A2, A3, A4, A5, A6, A7, A8, A9), F> {
-  static script::Value wrap(script::FunctionCall* c) {
+template<typename R, typename ClassType, typename... Args, R(ClassType::*F)(Args...)>
+struct member_wrapper_t<R(ClassType::*)(Args...), F> {
+  static script::Value wrap(script::FunctionCall *c) {
+    NativeCallScope scope{ c };
     ClassType& ref = value_cast<ClassType&>(c->arg(0));
-    return make_value<R>(((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)), value_cast<A6>(c->arg(6)), value_cast<A7>(c->arg(7)), value_cast<A8>(c->arg(8)), value_cast<A9>(c->arg(9))), c->engine());
+    return invoker<R, Args...>::template call<1>(c, F, ref);
   }
 };
 
@@ -191,66 +50,12 @@ void member functions
 template<typename MemberType, MemberType f>
 struct void_member_wrapper_t;
 
-template<typename ClassType, void(ClassType::*F)()>
-struct void_member_wrapper_t<void(ClassType::*)(), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))();
-    return script::Value::Void;
-  }
-};
-
-template<typename ClassType, typename A1, void(ClassType::*F)(A1)>
-struct void_member_wrapper_t<void(ClassType::*)(A1), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)));
-    return script::Value::Void;
-  }
-};
-
-template<typename ClassType, typename A1, typename A2, void(ClassType::*F)(A1, A2)>
-struct void_member_wrapper_t<void(ClassType::*)(A1, A2), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)));
-    return script::Value::Void;
-  }
-};
-
-template<typename ClassType, typename A1, typename A2, typename A3, void(ClassType::*F)(A1, A2, A3)>
-struct void_member_wrapper_t<void(ClassType::*)(A1, A2, A3), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)));
-    return script::Value::Void;
-  }
-};
-
-template<typename ClassType, typename A1, typename A2, typename A3, typename A4, void(ClassType::*F)(A1, A2, A3, A4)>
-struct void_member_wrapper_t<void(ClassType::*)(A1, A2, A3, A4), F> {
+template<typename ClassType, typename... Args, void(ClassType::*F)(Args...)>
+struct void_member_wrapper_t<void(ClassType::*)(Args...), F> {
   static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)));
-    return script::Value::Void;
-  }
-};
-
-template<typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, void(ClassType::*F)(A1, A2, A3, A4, A5)>
-struct void_member_wrapper_t<void(ClassType::*)(A1, A2, A3, A4, A5), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)));
-    return script::Value::Void;
-  }
-};
-
-template<typename ClassType, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, void(ClassType::*F)(A1, A2, A3, A4, A5, A6)>
-struct void_member_wrapper_t<void(ClassType::*)(A1, A2, A3, A4, A5, A6), F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)), value_cast<A2>(c->arg(2)), value_cast<A3>(c->arg(3)), value_cast<A4>(c->arg(4)), value_cast<A5>(c->arg(5)), value_cast<A6>(c->arg(6)));
-    return script::Value::Void;
+    NativeCallScope scope{ c };
+    ClassType& ref = value_cast<ClassType&>(c->arg(0));
+    return invoker<void, Args...>::template call<1>(c, F, ref);
   }
 };
 
@@ -261,21 +66,12 @@ const void member functions
 template<typename MemberType, MemberType f>
 struct const_void_member_wrapper_t;
 
-template<typename ClassType, void(ClassType::*F)()const>
-struct const_void_member_wrapper_t<void(ClassType::*)()const, F> {
+template<typename ClassType, typename... Args, void(ClassType::*F)(Args...)const>
+struct const_void_member_wrapper_t<void(ClassType::*)(Args...)const, F> {
   static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))();
-    return script::Value::Void;
-  }
-};
-
-template<typename ClassType, typename A1, void(ClassType::*F)(A1)const>
-struct const_void_member_wrapper_t<void(ClassType::*)(A1)const, F> {
-  static script::Value wrap(script::FunctionCall *c) {
-    ClassType & ref = value_cast<ClassType&>(c->arg(0));
-    ((ref).*(F))(value_cast<A1>(c->arg(1)));
-    return script::Value::Void;
+    NativeCallScope scope{ c };
+    const ClassType& ref = value_cast<const ClassType&>(c->arg(0));
+    return invoker<void, Args...>::template call<1>(c, F, ref);
   }
 };
 
@@ -299,7 +95,7 @@ public:
   {
     script::Engine* e = cla.engine();
     enclosing_symbol = script::Symbol(cla).impl();
-    proto.setReturnType(make_type<T>(e));
+    proto.setReturnType(make_type<R>(e));
     proto.set({ make_type<T&>(e).withFlag(script::Type::ThisFlag), make_type<Args>(e)... });
   }
 
@@ -324,26 +120,11 @@ public:
     return proto;
   }
 
-  template<std::size_t... Is>
-  script::Value do_invoke(script::FunctionCall* c, std::index_sequence<Is...>, std::false_type)
-  {
-    using Tuple = std::tuple<Args...>;
-    T& ref = value_cast<T&>(c->arg(0));
-    return make_value<R>(((ref).*(method))(value_cast<typename std::tuple_element<Is, Tuple>::type>(c->arg(Is + 1))...), c->engine());
-  }
-
-  template<std::size_t... Is>
-  script::Value do_invoke(script::FunctionCall* c, std::index_sequence<Is...>, std::true_type)
-  {
-    using Tuple = std::tuple<Args...>;
-    T& ref = value_cast<T&>(c->arg(0));
-    ((ref).*(method))(value_cast<typename std::tuple_element<Is, Tuple>::type>(c->arg(Is + 1))...);
-    return script::Value::Void;
-  }
-
   script::Value invoke(script::FunctionCall* c) override
   {
-    return do_invoke(c, std::index_sequence_for<Args...>{}, std::integral_constant<bool, std::is_void<R>::value>());
+    NativeCallScope scope{ c };
+    T& ref = value_cast<T&>(c->arg(0));
+    return invoker<R, Args...>::template call<1>(c, method, ref);
   }
 };
 
@@ -363,7 +144,7 @@ public:
   {
     script::Engine* e = cla.engine();
     enclosing_symbol = script::Symbol(cla).impl();
-    proto.setReturnType(make_type<T>(e));
+    proto.setReturnType(make_type<R>(e));
     proto.set({ make_type<const T&>(e).withFlag(script::Type::ThisFlag), make_type<Args>(e)... });
   }
 
@@ -392,26 +173,11 @@ public:
     return proto;
   }
 
-  template<std::size_t... Is>
-  script::Value do_invoke(script::FunctionCall* c, std::index_sequence<Is...>, std::false_type)
-  {
-    using Tuple = std::tuple<Args...>;
-    const T& ref = value_cast<T&>(c->arg(0));
-    return make_value<R>(((ref).*(method))(value_cast<typename std::tuple_element<Is, Tuple>::type>(c->arg(Is + 1))...), c->engine());
-  }
-
-  template<std::size_t... Is>
-  script::Value do_invoke(script::FunctionCall* c, std::index_sequence<Is...>, std::true_type)
-  {
-    using Tuple = std::tuple<Args...>;
-    const T& ref = value_cast<T&>(c->arg(0));
-    ((ref).*(method))(value_cast<typename std::tuple_element<Is, Tuple>::type>(c->arg(Is + 1))...);
-    return script::Value::Void;
-  }
-
   script::Value invoke(script::FunctionCall* c) override
   {
-    return do_invoke(c, std::index_sequence_for<Args...>{}, std::integral_constant<bool, std::is_void<R>::value>());
+    NativeCallScope scope{ c };
+    const T& ref = value_cast<const T&>(c->arg(0));
+    return invoker<R, Args...>::template call<1>(c, method, ref);
   }
 };
 
@@ -0,0 +1,87 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_COPY_AUDIT_H
+#define GONK_COPY_AUDIT_H
+
+#include "gonk/gonk-defs.h"
+
+#include "gonk/memstats.h"
+
+#include <script/function.h>
+#include <script/interpreter/debug-handler.h>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+namespace script
+{
+namespace interpreter
+{
+class ExecutionContext;
+} // namespace interpreter
+} // namespace script
+
+namespace gonk
+{
+
+/*!
+ * \class CopyAudit
+ * \brief attributes the deep copies made by native code to their call site
+ *
+ * A copy is charged to the innermost script frame (at the line of its last
+ * breakpoint) and to the native function running on top of it.
+ */
+class GONK_API CopyAudit : public script::interpreter::DebugHandler, public memstats::CopyObserver
+{
+public:
+  CopyAudit();
+  ~CopyAudit();
+
+  struct Site
+  {
+    const void* function = nullptr;
+    int line = -1;
+    const void* native = nullptr;
+    int type = 0;
+
+    bool operator<(const Site& other) const
+    {
+      return std::tie(function, line, native, type) < std::tie(other.function, other.line, other.native, other.type);
+    }
+  };
+
+  struct SiteStats
+  {
+    size_t count = 0;
+    size_t bytes = 0;
+  };
+
+  void start();
+  void stop();
+
+  void interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info) override;
+  void copied(const script::Value& copy) override;
+
+  const std::map<Site, SiteStats>& sites() const;
+
+  void writeReport(std::ostream& out, script::Engine& e, size_t limit = 20) const;
+
+protected:
+  const void* key(const script::Function& f);
+  std::string location(const Site& site) const;
+
+private:
+  script::interpreter::ExecutionContext* m_context = nullptr;
+  std::map<Site, SiteStats> m_sites;
+  std::unordered_map<const void*, script::Function> m_functions;
+  bool m_was_enabled = false;
+};
+
+} // namespace gonk
+
+#endif // GONK_COPY_AUDIT_H
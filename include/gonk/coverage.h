@@ -0,0 +1,76 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_COVERAGE_H
+#define GONK_COVERAGE_H
+
+#include "gonk/gonk-defs.h"
+
+#include <script/interpreter/debug-handler.h>
+#include <script/script.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gonk
+{
+
+/*!
+ * \class Coverage
+ * \brief collects the lines executed by scripts compiled in debug mode
+ *
+ * Each script has a dense bitmap indexed by line that is set on the first
+ * execution of the line, hits are only counted if requested.
+ */
+class GONK_API Coverage : public script::interpreter::DebugHandler
+{
+public:
+  explicit Coverage(bool count_hits = false);
+  ~Coverage();
+
+  struct ScriptCoverage
+  {
+    script::Script script;
+    std::vector<uint64_t> executed;
+    std::vector<uint32_t> hits;
+
+    bool isExecuted(int line) const;
+  };
+
+  static Coverage* active();
+
+  void start();
+  void stop();
+
+  bool countsHits() const;
+
+  void addScript(const script::Script& s);
+
+  void interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info) override;
+
+  const std::map<std::string, std::unique_ptr<ScriptCoverage>>& scripts() const;
+
+  void writeLcov(std::ostream& out) const;
+  bool save(const std::string& path) const;
+
+protected:
+  ScriptCoverage* getScript(const script::Script& s);
+  ScriptCoverage* findScript(script::interpreter::FunctionCall& call);
+
+private:
+  bool m_count_hits;
+  std::map<std::string, std::unique_ptr<ScriptCoverage>> m_scripts;
+  std::unordered_map<const void*, ScriptCoverage*> m_functions;
+  const void* m_last_function = nullptr;
+  ScriptCoverage* m_last_script = nullptr;
+};
+
+} // namespace gonk
+
+#endif // GONK_COVERAGE_H
@@ -8,6 +8,7 @@
 #include "gonk/gonk-defs.h"
 
 #include "gonk/common/values.h"
+#include "gonk/common/wrappers/invoker.h"
 
 #include <script/interpreter/executioncontext.h>
 #include <script/function-blueprint.h>
@@ -16,9 +17,12 @@
 
 #include <dynlib/dynlib.h>
 
-#include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 namespace gonk
 {
@@ -31,6 +35,72 @@ public:
   virtual script::Function create(void (*proc)(), script::FunctionBlueprint& blueprint) = 0;
 };
 
+/*!
+ * \class NativeSignatureError
+ * \brief thrown while compiling a [[native]] function that cannot be created
+ */
+class GONK_API NativeSignatureError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+/*!
+ * \class NativeSignatureTable
+ * \brief open addressing hash table from a prototype to its creator
+ *
+ * Prototypes are keyed by the data of their types, a lookup does not
+ * allocate.
+ */
+class GONK_API NativeSignatureTable
+{
+public:
+  NativeSignatureTable() = default;
+  NativeSignatureTable(const NativeSignatureTable&) = delete;
+  ~NativeSignatureTable() = default;
+
+  void insert(const script::Prototype& proto, std::unique_ptr<CFunctionCreator> creator);
+  CFunctionCreator* find(const script::Prototype& proto) const;
+
+  size_t size() const;
+
+  NativeSignatureTable& operator=(const NativeSignatureTable&) = delete;
+
+protected:
+  struct Slot
+  {
+    size_t hash = 0;
+    std::vector<int> types;
+    std::unique_ptr<CFunctionCreator> creator;
+  };
+
+  static int key(const script::Type& t);
+  static size_t hash(const script::Prototype& proto);
+  static bool matches(const Slot& slot, const script::Prototype& proto);
+  void rehash(size_t capacity);
+
+private:
+  std::vector<Slot> m_slots;
+  size_t m_size = 0;
+};
+
+/*!
+ * \class NativeSymbol
+ * \brief entry of a static table mapping a procedure name to its address
+ */
+struct NativeSymbol
+{
+  const char* name;
+  void (*proc)();
+};
+
+// the signature is spelled out so that a mismatch fails to compile
+template<typename Signature>
+inline void (*native_symbol(Signature* proc))()
+{
+  return reinterpret_cast<void(*)()>(proc);
+}
+
 class GONK_API FunctionCreator : public script::FunctionCreator
 {
 public:
@@ -46,20 +116,62 @@ public:
   template<typename R, typename... Args>
   void addCtorCreator();
 
+  // e.g. addCreators<int(const int&, const int&), void(Foo&)>()
+  template<typename... Signatures>
+  void addCreators();
+
+  // e.g. addCtorCreators<Foo(int), Foo(const std::string&)>()
+  template<typename... Signatures>
+  void addCtorCreators();
+
+  // e.g. addDtorCreators<Foo, Bar>(), for [[native]] destructors
+  template<typename... Ts>
+  void addDtorCreators();
+
+  // e.g. addMember<&Foo::bar>("Foo::bar") for [[native("Foo::bar")]];
+  // a data member is accessed with 'int bar() const' or 'int& bar()'
+  template<auto M>
+  void addMember(const std::string& name);
+
+  // procedures found in the table are not looked up in the library
+  void addSymbols(const NativeSymbol* symbols, size_t count);
+
   FunctionCreator& operator=(const FunctionCreator&) = delete;
 
 protected:
   std::string stringify(const script::Prototype& proto);
-  void addCreator(const std::string& key, std::unique_ptr<CFunctionCreator> creator);
-  void addCCreator(const std::string& key, std::unique_ptr<CFunctionCreator> creator);
+  void (*resolve(const std::string& name))();
+  void addCreator(const script::Prototype& proto, std::unique_ptr<CFunctionCreator> creator);
+  void addCCreator(const script::Prototype& proto, std::unique_ptr<CFunctionCreator> creator);
+  void addDCreator(const script::Prototype& proto, std::unique_ptr<CFunctionCreator> creator);
+  void addMemberCreator(const std::string& name, const script::Prototype& proto, std::unique_ptr<CFunctionCreator> creator);
   script::Function create_function(script::FunctionBlueprint& blueprint, const std::shared_ptr<script::ast::FunctionDecl>& fdecl, std::vector<script::Attribute>& attrs);
   script::Function create_ctor(script::FunctionBlueprint& blueprint, const std::shared_ptr<script::ast::FunctionDecl>& fdecl, std::vector<script::Attribute>& attrs);
+  script::Function create_dtor(script::FunctionBlueprint& blueprint, const std::shared_ptr<script::ast::FunctionDecl>& fdecl, std::vector<script::Attribute>& attrs);
+
+  template<typename R, typename... Args>
+  script::DynamicPrototype make_prototype();
+
+  template<typename R, typename... Args>
+  void addCreatorFor(R(*)(Args...));
+
+  template<typename T, typename... Args>
+  void addCtorCreatorFor(T(*)(Args...));
+
+  template<auto M, typename R, typename T, typename... Args>
+  void addMemberFunctionFor(const std::string& name, R(T::*)(Args...));
+
+  template<auto M, typename R, typename T, typename... Args>
+  void addMemberFunctionFor(const std::string& name, R(T::*)(Args...) const);
 
 private:
   script::Engine* m_engine;
   dynlib::Library& m_library;
-  std::map<std::string, std::unique_ptr<CFunctionCreator>> m_function_creators;
-  std::map<std::string, std::unique_ptr<CFunctionCreator>> m_ctor_creators;
+  NativeSignatureTable m_function_creators;
+  NativeSignatureTable m_ctor_creators;
+  NativeSignatureTable m_dtor_creators;
+  std::unordered_map<std::string, NativeSignatureTable> m_members;
+  std::unordered_map<std::string, void(*)()> m_symbols;
 };
 
 template<typename T, typename... Args>
@@ -219,6 +331,226 @@ public:
   };
 };
 
+template<auto M>
+class CMemberFunction : public script::FunctionImpl
+{
+public:
+  using traits = wrapper::callable_traits<decltype(M)>;
+  using object_type = typename std::conditional<traits::is_const, const typename traits::class_type&, typename traits::class_type&>::type;
+
+  script::Name m_name;
+  script::FixedSizePrototype<traits::arity + 1> m_proto;
+
+public:
+  explicit CMemberFunction(script::FunctionBlueprint& blueprint)
+    : FunctionImpl(blueprint.engine()),
+      m_name(blueprint.name()),
+      m_proto(blueprint.prototype_)
+  {
+    enclosing_symbol = blueprint.parent().impl();
+    flags = blueprint.flags();
+  }
+
+  script::SymbolKind get_kind() const override
+  {
+    return m_name.kind();
+  }
+
+  const std::string& name() const override
+  {
+    return m_name.string();
+  }
+
+  script::Name get_name() const override
+  {
+    return m_name;
+  }
+
+  bool is_native() const override
+  {
+    return true;
+  }
+
+  void set_body(std::shared_ptr<script::program::Statement>) override
+  {
+
+  }
+
+  const script::Prototype& prototype() const override
+  {
+    return m_proto;
+  }
+
+  script::Value invoke(script::FunctionCall* c) override
+  {
+    return traits::invoker_type::template call<1>(c, M, gonk::value_cast<object_type>(c->arg(0)));
+  }
+};
+
+template<typename M>
+struct field_traits;
+
+template<typename U, typename T>
+struct field_traits<U T::*>
+{
+  using value_type = U;
+  using class_type = T;
+};
+
+/*!
+ * \class CField
+ * \brief accessor reading a data member directly in the storage of the object
+ *
+ * With ByReference, the field itself is returned and can be assigned to.
+ */
+template<auto M, bool ByReference>
+class CField : public script::FunctionImpl
+{
+public:
+  using value_type = typename field_traits<decltype(M)>::value_type;
+  using class_type = typename field_traits<decltype(M)>::class_type;
+
+  script::Name m_name;
+  script::FixedSizePrototype<1> m_proto;
+
+public:
+  explicit CField(script::FunctionBlueprint& blueprint)
+    : FunctionImpl(blueprint.engine()),
+      m_name(blueprint.name()),
+      m_proto(blueprint.prototype_)
+  {
+    enclosing_symbol = blueprint.parent().impl();
+    flags = blueprint.flags();
+  }
+
+  script::SymbolKind get_kind() const override
+  {
+    return m_name.kind();
+  }
+
+  const std::string& name() const override
+  {
+    return m_name.string();
+  }
+
+  script::Name get_name() const override
+  {
+    return m_name;
+  }
+
+  bool is_native() const override
+  {
+    return true;
+  }
+
+  void set_body(std::shared_ptr<script::program::Statement>) override
+  {
+
+  }
+
+  const script::Prototype& prototype() const override
+  {
+    return m_proto;
+  }
+
+  script::Value invoke(script::FunctionCall* c) override
+  {
+    if constexpr (ByReference)
+      return gonk::make_value<value_type&>(gonk::value_cast<class_type&>(c->arg(0)).*M, c->engine());
+    else
+      return gonk::make_value<value_type>(value_type(gonk::value_cast<const class_type&>(c->arg(0)).*M), c->engine());
+  }
+};
+
+template<auto M>
+class CMemberCreatorImpl : public CFunctionCreator
+{
+public:
+  ~CMemberCreatorImpl() = default;
+
+  script::Function create(void (*)(), script::FunctionBlueprint& blueprint) override
+  {
+    return script::Function(std::make_shared<CMemberFunction<M>>(blueprint));
+  };
+};
+
+template<auto M, bool ByReference>
+class CFieldCreatorImpl : public CFunctionCreator
+{
+public:
+  ~CFieldCreatorImpl() = default;
+
+  script::Function create(void (*)(), script::FunctionBlueprint& blueprint) override
+  {
+    return script::Function(std::make_shared<CField<M, ByReference>>(blueprint));
+  };
+};
+
+template<typename T>
+class CDestructor : public script::FunctionImpl
+{
+public:
+  script::Name m_name;
+  script::FixedSizePrototype<1> m_proto;
+
+public:
+  explicit CDestructor(script::FunctionBlueprint& blueprint)
+    : script::FunctionImpl(blueprint.engine(), blueprint.flags()),
+      m_name(blueprint.name()),
+      m_proto(blueprint.prototype_)
+  {
+    enclosing_symbol = blueprint.parent().impl();
+  }
+
+  script::SymbolKind get_kind() const override
+  {
+    return script::SymbolKind::Destructor;
+  }
+
+  const std::string& name() const override
+  {
+    return m_name.string();
+  }
+
+  script::Name get_name() const override
+  {
+    return m_name;
+  }
+
+  bool is_native() const override
+  {
+    return true;
+  }
+
+  void set_body(std::shared_ptr<script::program::Statement>) override
+  {
+
+  }
+
+  const script::Prototype& prototype() const override
+  {
+    return m_proto;
+  }
+
+  script::Value invoke(script::FunctionCall* c) override
+  {
+    c->thisObject().destroy<T>();
+    return script::Value::Void;
+  }
+};
+
+template<typename T>
+class CDestructorCreatorImpl : public CFunctionCreator
+{
+public:
+  ~CDestructorCreatorImpl() = default;
+
+  script::Function create(void (*)(), script::FunctionBlueprint& blueprint) override
+  {
+    return script::Function(std::make_shared<CDestructor<T>>(blueprint));
+  };
+};
+
 template<typename R, typename... Args>
 inline void FunctionCreator::addCreator()
 {
@@ -226,11 +558,7 @@ inline void FunctionCreator::addCreator()
   proto.setReturnType(gonk::make_type<R>(m_engine));
   proto.set({ gonk::make_type<Args>(m_engine)... });
 
-  std::string key = stringify(proto);
-
-  auto creator = std::make_unique<CFunctionCreatorImpl<R, Args...>>();
-
-  addCreator(key, std::move(creator));
+  addCreator(proto, std::make_unique<CFunctionCreatorImpl<R, Args...>>());
 }
 
 template<typename R, typename... Args>
@@ -240,11 +568,77 @@ inline void FunctionCreator::addCtorCreator()
   proto.setReturnType(script::Type::Void);
   proto.set({ gonk::make_type<R&>(m_engine), gonk::make_type<Args>(m_engine)... });
 
-  std::string key = stringify(proto);
+  addCCreator(proto, std::make_unique<CConstructorCreatorImpl<R, Args...>>());
+}
 
-  auto creator = std::make_unique<CConstructorCreatorImpl<R, Args...>>();
+template<typename R, typename... Args>
+inline void FunctionCreator::addCreatorFor(R(*)(Args...))
+{
+  addCreator<R, Args...>();
+}
 
-  addCCreator(key, std::move(creator));
+template<typename T, typename... Args>
+inline void FunctionCreator::addCtorCreatorFor(T(*)(Args...))
+{
+  addCtorCreator<T, Args...>();
+}
+
+template<typename... Signatures>
+inline void FunctionCreator::addCreators()
+{
+  (addCreatorFor(static_cast<Signatures*>(nullptr)), ...);
+}
+
+template<typename... Signatures>
+inline void FunctionCreator::addCtorCreators()
+{
+  (addCtorCreatorFor(static_cast<Signatures*>(nullptr)), ...);
+}
+
+template<typename... Ts>
+inline void FunctionCreator::addDtorCreators()
+{
+  (addDCreator(make_prototype<void, Ts&>(), std::make_unique<CDestructorCreatorImpl<Ts>>()), ...);
+}
+
+template<typename R, typename... Args>
+inline script::DynamicPrototype FunctionCreator::make_prototype()
+{
+  script::DynamicPrototype proto;
+  proto.setReturnType(gonk::make_type<R>(m_engine));
+  proto.set({ gonk::make_type<Args>(m_engine)... });
+  return proto;
+}
+
+template<auto M, typename R, typename T, typename... Args>
+inline void FunctionCreator::addMemberFunctionFor(const std::string& name, R(T::*)(Args...))
+{
+  addMemberCreator(name, make_prototype<R, T&, Args...>(), std::make_unique<CMemberCreatorImpl<M>>());
+}
+
+template<auto M, typename R, typename T, typename... Args>
+inline void FunctionCreator::addMemberFunctionFor(const std::string& name, R(T::*)(Args...) const)
+{
+  addMemberCreator(name, make_prototype<R, const T&, Args...>(), std::make_unique<CMemberCreatorImpl<M>>());
+}
+
+template<auto M>
+inline void FunctionCreator::addMember(const std::string& name)
+{
+  if constexpr (std::is_member_function_pointer<decltype(M)>::value)
+  {
+    addMemberFunctionFor<M>(name, M);
+  }
+  else
+  {
+    static_assert(std::is_member_object_pointer<decltype(M)>::value, "addMember() expects a pointer to a member");
+
+    using U = typename field_traits<decltype(M)>::value_type;
+    using T = typename field_traits<decltype(M)>::class_type;
+
+    addMemberCreator(name, make_prototype<U, const T&>(), std::make_unique<CFieldCreatorImpl<M, false>>());
+    addMemberCreator(name, make_prototype<U&, T&>(), std::make_unique<CFieldCreatorImpl<M, true>>());
+  }
 }
 
 
@@ -0,0 +1,97 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_INSTRUMENTATION_H
+#define GONK_INSTRUMENTATION_H
+
+#include "gonk/gonk-defs.h"
+
+#include "gonk/metrics.h"
+
+#include <script/interpreter/debug-handler.h>
+
+#include <memory>
+#include <vector>
+
+namespace gonk
+{
+
+/*!
+ * \class DebugHandlerList
+ * \brief forwards the interpreter breakpoints to several debug handlers
+ *
+ * The interpreter only accepts one debug handler, this class allows
+ * several instrumentation tools (profiler, tracer, ...) to be used at once.
+ */
+class GONK_API DebugHandlerList : public script::interpreter::DebugHandler
+{
+public:
+  DebugHandlerList() = default;
+
+  void add(std::shared_ptr<script::interpreter::DebugHandler> handler);
+  bool empty() const;
+
+  void interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info) override;
+
+private:
+  std::vector<std::shared_ptr<script::interpreter::DebugHandler>> m_handlers;
+};
+
+/*!
+ * \class NativeCallObserver
+ * \brief receives the calls made to native functions through the bindings
+ */
+class GONK_API NativeCallObserver
+{
+public:
+  virtual ~NativeCallObserver();
+
+  virtual void enter(script::interpreter::FunctionCall* c) = 0;
+  virtual void leave(script::interpreter::FunctionCall* c) = 0;
+};
+
+namespace instrumentation
+{
+
+// null unless an observer is installed; together with metrics::enabled,
+// which guards the NativeCalls counter, this is all that is checked on
+// each native call
+GONK_API extern NativeCallObserver* native_call_observer;
+
+GONK_API void addNativeCallObserver(NativeCallObserver* observer);
+GONK_API void removeNativeCallObserver(NativeCallObserver* observer);
+
+} // namespace instrumentation
+
+class NativeCallScope
+{
+public:
+  explicit NativeCallScope(script::interpreter::FunctionCall* c)
+    : m_call(c),
+      m_observer(instrumentation::native_call_observer)
+  {
+    Metrics::count(Metrics::NativeCalls);
+
+    if (m_observer)
+      m_observer->enter(c);
+  }
+
+  NativeCallScope(const NativeCallScope&) = delete;
+
+  ~NativeCallScope()
+  {
+    if (m_observer)
+      m_observer->leave(m_call);
+  }
+
+  NativeCallScope& operator=(const NativeCallScope&) = delete;
+
+private:
+  script::interpreter::FunctionCall* m_call;
+  NativeCallObserver* m_observer;
+};
+
+} // namespace gonk
+
+#endif // GONK_INSTRUMENTATION_H
@@ -0,0 +1,75 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_LAZY_MEMBERS_H
+#define GONK_LAZY_MEMBERS_H
+
+#include "gonk/gonk-defs.h"
+
+#include <script/class.h>
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace script
+{
+class Engine;
+} // namespace script
+
+namespace gonk
+{
+
+/*!
+ * \class LazyMembers
+ * \brief creates the named members of native classes on first use
+ *
+ * Instead of creating every member function when a module is loaded, a
+ * plugin can add() a creator per member name. The names used by a script
+ * are demanded before it is compiled (see demandSource()); a member is
+ * created the first time its name is demanded, or as soon as it is added
+ * if the name was already demanded, e.g. by the script importing the module.
+ *
+ * Constructors, destructors and operators are not named and must still be
+ * created eagerly. Members looked up by the host through the C++ API must be
+ * demanded explicitly.
+ */
+class GONK_API LazyMembers
+{
+public:
+  // receives the class and the name of the member to create
+  using Creator = void(*)(script::Class&, const std::string&);
+
+  static LazyMembers& of(script::Engine* e);
+  static void release(script::Engine* e);
+
+  void add(script::Class cla, const std::string& name, Creator creator);
+
+  void demand(const std::string& name);
+  void demandSource(const std::string& source);
+  void materializeAll();
+
+  size_t pendingCount() const;
+  size_t createdCount() const { return m_created; }
+
+private:
+  struct Entry
+  {
+    script::Class cla;
+    Creator creator;
+  };
+
+  void create(Entry& entry, const std::string& name);
+
+private:
+  std::unordered_map<std::string, std::vector<Entry>> m_pending;
+  std::unordered_set<std::string> m_demanded;
+  size_t m_created = 0;
+};
+
+} // namespace gonk
+
+#endif // GONK_LAZY_MEMBERS_H
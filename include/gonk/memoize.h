@@ -0,0 +1,84 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_MEMOIZE_H
+#define GONK_MEMOIZE_H
+
+#include "gonk/gonk-defs.h"
+
+#include <script/function.h>
+#include <script/function-blueprint.h>
+#include <script/functioncreator.h>
+
+#include <cstddef>
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gonk
+{
+
+struct MemoStats
+{
+  std::string name;
+  size_t capacity = 0;
+  size_t size = 0;
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t evictions = 0;
+};
+
+/*!
+ * \class MemoizeError
+ * \brief thrown while compiling a function on which [[memoize]] cannot be used
+ */
+class GONK_API MemoizeError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+namespace memoize
+{
+
+static constexpr size_t DefaultCapacity = 128;
+
+// returns f itself unless attrs contains [[memoize]] or [[memoize(capacity)]],
+// in which case the returned function caches the results of f;
+// throws MemoizeError if f cannot be memoized
+GONK_API script::Function apply(script::FunctionBlueprint& blueprint, const script::Function& f, const std::vector<script::Attribute>& attrs);
+
+GONK_API std::vector<MemoStats> stats();
+
+// drops the cached results, must be called before the engine is torn down
+GONK_API void clear();
+
+GONK_API void write_report(std::ostream& out);
+
+} // namespace memoize
+
+/*!
+ * \class MemoizeCreator
+ * \brief adds support for the [[memoize]] attribute to a script
+ *
+ * The results of a function marked [[memoize]] are kept in a LRU cache
+ * (128 entries by default, [[memoize(n)]] for n entries) keyed by the
+ * values of its arguments. Only functions that return a value and take no
+ * non-const reference can be memoized; the function is assumed to be pure.
+ * Objects used as keys need operator== and, to be spread over the cache,
+ * a hash() function. Floating-point keys compare by value except that
+ * calls with a NaN argument are never cached.
+ */
+class GONK_API MemoizeCreator : public script::FunctionCreator
+{
+public:
+  MemoizeCreator() = default;
+
+  script::Function create(script::FunctionBlueprint& blueprint, const std::shared_ptr<script::ast::FunctionDecl>& fdecl, std::vector<script::Attribute>& attrs) override;
+};
+
+} // namespace gonk
+
+#endif // GONK_MEMOIZE_H
@@ -0,0 +1,234 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_MEMSTATS_H
+#define GONK_MEMSTATS_H
+
+#include "gonk/gonk-defs.h"
+
+#include <script/value.h>
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace script
+{
+class Engine;
+} // namespace script
+
+namespace gonk
+{
+
+namespace memstats
+{
+
+enum Operation
+{
+  Construct,
+  Copy,
+  Destroy,
+};
+
+struct TypeCounters
+{
+  size_t constructed = 0;
+  size_t copied = 0;
+  size_t destroyed = 0;
+};
+
+struct ContainerStats
+{
+  std::string name;
+  size_t live = 0;
+  size_t created = 0;
+  size_t elements = 0;
+  size_t capacity = 0;
+};
+
+// Counts the values constructed, copied and destroyed by native code
+// (containers and bindings), values destroyed by the interpreter are not seen.
+// Each thread counts in its own shard, counters() sums them.
+
+// false unless --memstats is used or the gonk.stats module is imported,
+// this is the only thing that is checked on each operation
+GONK_API extern std::atomic<bool> enabled;
+
+// the containers can be tracked without counting the values
+GONK_API extern std::atomic<bool> track_containers;
+
+GONK_API void setEnabled(bool on = true);
+// tracking is reference counted, each user turning it on must turn it off
+GONK_API void setTrackContainers(bool on);
+GONK_API void reset();
+
+GONK_API void record(Operation op, int type_id);
+GONK_API void record_copy(const script::Value& copy);
+
+inline void count(Operation op, const script::Type& t)
+{
+  if (enabled.load(std::memory_order_relaxed))
+    record(op, t.baseType().data());
+}
+
+inline void count(Operation op, const script::Value& val)
+{
+  if (enabled.load(std::memory_order_relaxed) && !val.isNull())
+  {
+    if (op == Copy)
+      record_copy(val);
+    else
+      record(op, val.type().baseType().data());
+  }
+}
+
+/*!
+ * \class CopyObserver
+ * \brief receives the deep copies made by native code
+ */
+class GONK_API CopyObserver
+{
+public:
+  virtual ~CopyObserver();
+
+  virtual void copied(const script::Value& copy) = 0;
+};
+
+GONK_API extern CopyObserver* copy_observer;
+
+GONK_API extern int copy_scope_depth;
+
+/*!
+ * \class CopyScope
+ * \brief groups the copies of the elements of a container being copied
+ *
+ * The elements are still counted, but only the copy of the container is
+ * reported to the copy observer.
+ */
+class CopyScope
+{
+public:
+  CopyScope() { ++copy_scope_depth; }
+  CopyScope(const CopyScope&) = delete;
+  ~CopyScope() { --copy_scope_depth; }
+
+  CopyScope& operator=(const CopyScope&) = delete;
+};
+
+using SizeEstimator = size_t(*)(const script::Value&);
+
+// containers register a function computing the memory they use,
+// other values are estimated from their type
+GONK_API void setSizeEstimator(const script::Type& t, SizeEstimator fn);
+GONK_API size_t estimate_size(const script::Value& val);
+
+GONK_API std::map<int, TypeCounters> counters();
+GONK_API TypeCounters total();
+
+/*!
+ * \class ContainerTracker
+ * \brief keeps track of the live instances of a container type
+ */
+class GONK_API ContainerTracker
+{
+public:
+  explicit ContainerTracker(std::string name);
+  virtual ~ContainerTracker();
+
+  const std::string& name() const;
+  virtual ContainerStats stats() const = 0;
+
+private:
+  std::string m_name;
+};
+
+template<typename C>
+class ContainerTrackerT : public ContainerTracker
+{
+public:
+  using ContainerTracker::ContainerTracker;
+
+  void add(const C* c)
+  {
+    if (enabled.load(std::memory_order_relaxed) || track_containers.load(std::memory_order_relaxed))
+    {
+      std::lock_guard<std::mutex> lock{ m_mutex };
+      m_live.insert(c);
+      m_created += 1;
+      m_count.store(m_live.size(), std::memory_order_relaxed);
+    }
+  }
+
+  // always erase, the stats may have been disabled since the container was added
+  void remove(const C* c)
+  {
+    if (m_count.load(std::memory_order_relaxed) > 0)
+    {
+      std::lock_guard<std::mutex> lock{ m_mutex };
+      m_live.erase(c);
+      m_count.store(m_live.size(), std::memory_order_relaxed);
+    }
+  }
+
+  ContainerStats stats() const override
+  {
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    ContainerStats result;
+    result.name = name();
+    result.live = m_live.size();
+    result.created = m_created;
+
+    for (const C* c : m_live)
+    {
+      result.elements += c->size();
+      result.capacity += capacity(*c);
+    }
+
+    return result;
+  }
+
+protected:
+  template<typename T>
+  static auto capacity_impl(const T& c, int) -> decltype(c.capacity())
+  {
+    return c.capacity();
+  }
+
+  // node-based containers allocate exactly one node per element
+  template<typename T>
+  static size_t capacity_impl(const T& c, long)
+  {
+    return c.size();
+  }
+
+  static size_t capacity(const C& c)
+  {
+    return static_cast<size_t>(capacity_impl(c, 0));
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  std::unordered_set<const C*> m_live;
+  std::atomic<size_t> m_count{ 0 };
+  size_t m_created = 0;
+};
+
+GONK_API std::vector<ContainerStats> containers();
+
+// in kilobytes, 0 if not supported on the platform
+GONK_API size_t peak_rss();
+
+GONK_API void write_report(std::ostream& out, script::Engine& e);
+
+} // namespace memstats
+
+} // namespace gonk
+
+#endif // GONK_MEMSTATS_H
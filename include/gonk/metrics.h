@@ -0,0 +1,145 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_METRICS_H
+#define GONK_METRICS_H
+
+#include "gonk/gonk-defs.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gonk
+{
+
+namespace metrics
+{
+
+// false unless the host enables the metrics, this is the only thing
+// that is checked at each measuring point
+GONK_API extern bool enabled;
+
+} // namespace metrics
+
+/*!
+ * \class Metrics
+ * \brief counters and histograms for hosts embedding gonkbase
+ *
+ * Each thread writes to its own set of counters, a snapshot sums them.
+ * Nothing is exposed over the network, the host decides where to publish
+ * the Prometheus or JSON dump.
+ */
+class GONK_API Metrics
+{
+public:
+
+  enum Counter
+  {
+    ScriptsCompiled,
+    CompileErrors,
+    ScriptsRun,
+    ModulesDiscovered,
+    ModuleImports,
+    ModuleLoads,
+    ModuleLoadFailures,
+    NativeCalls,
+    RuntimeErrors, // reaching the runner or the module loader
+    UncaughtErrors,
+    CounterCount,
+  };
+
+  enum Histogram
+  {
+    CompileTime,
+    RunTime,
+    ModuleLoadTime,
+    HistogramCount,
+  };
+
+  // upper bounds of the histogram buckets in seconds, the last bucket is +Inf
+  static constexpr size_t BucketCount = 8;
+  static const std::array<double, BucketCount - 1>& bucketBounds();
+
+  struct HistogramData
+  {
+    std::array<uint64_t, BucketCount> buckets{};
+    uint64_t count = 0;
+    double sum = 0;
+  };
+
+  struct Snapshot
+  {
+    std::array<uint64_t, CounterCount> counters{};
+    std::array<HistogramData, HistogramCount> histograms{};
+    std::vector<std::pair<std::string, size_t>> container_elements;
+  };
+
+  static void setEnabled(bool on = true);
+
+  inline static void count(Counter c, uint64_t n = 1)
+  {
+    if (metrics::enabled)
+      increment(c, n);
+  }
+
+  inline static void time(Histogram h, std::chrono::steady_clock::duration d)
+  {
+    if (metrics::enabled)
+      observe(h, std::chrono::duration<double>(d).count());
+  }
+
+  static void increment(Counter c, uint64_t n = 1);
+  static void observe(Histogram h, double seconds);
+
+  static Snapshot snapshot();
+  static void reset();
+
+  static const char* name(Counter c);
+  static const char* name(Histogram h);
+
+  static void writePrometheus(std::ostream& out, const Snapshot& s);
+  static void writeJson(std::ostream& out, const Snapshot& s);
+  static std::string toPrometheus();
+  static std::string toJson();
+};
+
+/*!
+ * \class MetricsTimer
+ * \brief adds the lifetime of the object to a histogram
+ */
+class MetricsTimer
+{
+public:
+  explicit MetricsTimer(Metrics::Histogram h)
+    : m_histogram(h),
+      m_active(metrics::enabled)
+  {
+    if (m_active)
+      m_start = std::chrono::steady_clock::now();
+  }
+
+  MetricsTimer(const MetricsTimer&) = delete;
+
+  ~MetricsTimer()
+  {
+    if (m_active)
+      Metrics::time(m_histogram, std::chrono::steady_clock::now() - m_start);
+  }
+
+  MetricsTimer& operator=(const MetricsTimer&) = delete;
+
+private:
+  Metrics::Histogram m_histogram;
+  bool m_active;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace gonk
+
+#endif // GONK_METRICS_H
@@ -7,6 +7,7 @@
 
 #include "gonk/gonk-defs.h"
 
+#include <script/compilemode.h>
 #include <script/module.h>
 #include <script/module-interface.h>
 #include <script/script.h>
@@ -50,6 +51,7 @@ public:
   void loadChildren();
 
 protected:
+  void loadModule();
   void loadDependencies();
   void loadPlugin();
 };
@@ -69,9 +71,14 @@ public:
 
   void loadModule(const std::string& name);
 
+  // instrumentation tools need module scripts compiled in debug mode
+  script::CompileMode scriptCompileMode() const;
+  void setScriptCompileMode(script::CompileMode mode);
+
 private:
   script::Engine* m_script_engine;
   std::vector<std::string> m_import_paths;
+  script::CompileMode m_script_compile_mode = script::CompileMode::Release;
 };
 
 } // namespace gonk
@@ -0,0 +1,112 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_PROFILER_H
+#define GONK_PROFILER_H
+
+#include "gonk/gonk-defs.h"
+
+#include <script/interpreter/debug-handler.h>
+#include <script/function.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gonk
+{
+
+/*!
+ * \class Profiler
+ * \brief instrumenting profiler for scripts compiled in debug mode
+ *
+ * The profiler is called on every breakpoint. It keeps a shadow copy of the
+ * interpreter callstack and charges the time elapsed since the previous
+ * breakpoint to the function and line that were on top of the stack.
+ */
+class GONK_API Profiler : public script::interpreter::DebugHandler
+{
+public:
+  Profiler();
+  ~Profiler();
+
+  using clock = std::chrono::steady_clock;
+
+  struct FunctionStats
+  {
+    script::Function function;
+    std::string name;
+    std::string path;
+    size_t calls = 0;
+    clock::duration exclusive{ 0 };
+    clock::duration inclusive{ 0 };
+    int active = 0;
+    clock::time_point start;
+  };
+
+  struct LineStats
+  {
+    size_t function;
+    int line;
+    size_t hits = 0;
+    clock::duration exclusive{ 0 };
+    clock::duration inclusive{ 0 };
+    int active = 0;
+    clock::time_point start;
+  };
+
+  void interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info) override;
+
+  void stop();
+
+  const std::vector<FunctionStats>& functions() const;
+  const std::vector<LineStats>& lines() const;
+
+  void writeReport(std::ostream& out) const;
+  void writeCollapsedStacks(std::ostream& out) const;
+
+protected:
+  struct Frame
+  {
+    script::interpreter::FunctionCall* call;
+    const void* callee;
+    size_t function;
+    size_t line;
+    size_t node;
+    const void* entry; // first breakpoint hit by the call, if observed
+  };
+
+  struct Node
+  {
+    size_t parent;
+    size_t function;
+    clock::duration self{ 0 };
+    std::unordered_map<size_t, size_t> children;
+  };
+
+  size_t functionIndex(const script::Function& f);
+  size_t lineIndex(size_t function, int line);
+  size_t childNode(size_t parent, size_t function);
+  void push(script::interpreter::FunctionCall* call, int line, clock::time_point now);
+  void pop(clock::time_point now);
+  void setLine(Frame& frame, size_t line, clock::time_point now);
+  std::string collapsedStack(size_t node) const;
+
+private:
+  std::vector<FunctionStats> m_functions;
+  std::vector<LineStats> m_lines;
+  std::vector<Node> m_nodes;
+  std::vector<Frame> m_stack;
+  std::unordered_map<const void*, size_t> m_function_indexes;
+  std::unordered_map<uint64_t, size_t> m_line_indexes;
+  clock::time_point m_last;
+  clock::duration m_total{ 0 };
+};
+
+} // namespace gonk
+
+#endif // GONK_PROFILER_H
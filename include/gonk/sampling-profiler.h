@@ -0,0 +1,103 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_SAMPLINGPROFILER_H
+#define GONK_SAMPLINGPROFILER_H
+
+#include "gonk/gonk-defs.h"
+
+#include <script/interpreter/debug-handler.h>
+#include <script/function.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace gonk
+{
+
+/*!
+ * \class SamplingProfiler
+ * \brief statistical profiler with a bounded overhead
+ *
+ * A watcher thread requests a sample at a fixed frequency, the callstack is
+ * then captured by the interpreter thread on the next breakpoint (reading it
+ * from another thread would not be safe) and pushed to a single-producer
+ * single-consumer ring buffer. The watcher thread drains the buffer into a
+ * histogram of callstacks.
+ * Between two samples the cost on the interpreter thread is a relaxed
+ * atomic load per breakpoint.
+ */
+class GONK_API SamplingProfiler : public script::interpreter::DebugHandler
+{
+public:
+  explicit SamplingProfiler(int frequency = 1000);
+  ~SamplingProfiler();
+
+  // higher frequencies are clamped, the watcher thread would busy-spin
+  static constexpr int MaxFrequency = 100000;
+  static constexpr size_t MaxDepth = 64;
+  static constexpr size_t RingSize = 1024;
+
+  struct Frame
+  {
+    const void* function = nullptr;
+    int line = -1;
+
+    bool operator<(const Frame& other) const
+    {
+      return function < other.function || (function == other.function && line < other.line);
+    }
+  };
+
+  struct Sample
+  {
+    // from the bottom of the callstack to the top
+    std::array<Frame, MaxDepth> frames;
+    size_t depth = 0;
+    bool truncated = false;
+  };
+
+  int frequency() const;
+
+  void start();
+  void stop();
+
+  void interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info) override;
+
+  size_t sampleCount() const;
+  size_t droppedSamples() const;
+
+  void writeReport(std::ostream& out) const;
+  void writeCollapsedStacks(std::ostream& out) const;
+
+protected:
+  void capture(script::interpreter::FunctionCall& call, script::program::Breakpoint& info);
+  void run();
+  void drain();
+  std::string functionName(const void* f) const;
+
+private:
+  int m_frequency;
+  std::thread m_watcher;
+  std::atomic<bool> m_running{ false };
+  std::atomic<bool> m_sample_requested{ false };
+  std::unique_ptr<Sample[]> m_ring;
+  std::atomic<size_t> m_head{ 0 };
+  std::atomic<size_t> m_tail{ 0 };
+  std::atomic<size_t> m_dropped{ 0 };
+  std::unordered_map<const void*, script::Function> m_functions;
+  std::map<std::vector<Frame>, size_t> m_histogram;
+  size_t m_samples = 0;
+};
+
+} // namespace gonk
+
+#endif // GONK_SAMPLINGPROFILER_H
@@ -0,0 +1,96 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_SCRIPT_BENCH_H
+#define GONK_SCRIPT_BENCH_H
+
+#include "gonk/gonk-defs.h"
+
+#include "gonk/memoize.h"
+
+#include <script/function.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gonk
+{
+
+struct BenchResult
+{
+  std::string name;
+  uint64_t iterations = 0; // per repetition
+  int repetitions = 0;
+  // nanoseconds per call
+  double mean = 0;
+  double median = 0;
+  double max = 0;
+  double ops_per_second = 0;
+};
+
+/*!
+ * \class BenchError
+ * \brief thrown while compiling a [[bench]] function that cannot be run
+ */
+class GONK_API BenchError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+/*!
+ * \class ScriptBench
+ * \brief collects and runs the functions of a script annotated with [[bench]]
+ *
+ * Attach it to a script before compiling it; the functions marked
+ * [[bench]] or [[bench("name")]] are recorded, a BenchError is thrown
+ * if such a function takes parameters.
+ * Each benchmark is warmed up, its iteration count is calibrated so that a
+ * repetition lasts about sampleTime() and the time per call of every
+ * repetition is used for the statistics.
+ * [[memoize]] functions are also supported.
+ */
+class GONK_API ScriptBench : public MemoizeCreator
+{
+public:
+  ScriptBench();
+
+  struct Entry
+  {
+    std::string name;
+    script::Function function;
+  };
+
+  script::Function create(script::FunctionBlueprint& blueprint, const std::shared_ptr<script::ast::FunctionDecl>& fdecl, std::vector<script::Attribute>& attrs) override;
+
+  const std::vector<Entry>& entries() const;
+
+  void setFilter(const std::string& filter);
+  void setRepetitions(int n);
+  void setSampleTime(std::chrono::milliseconds t);
+  std::chrono::nanoseconds sampleTime() const;
+
+  BenchResult run(const Entry& entry) const;
+  int runAll(std::ostream& out);
+
+  const std::vector<BenchResult>& results() const;
+
+  static void writeHeader(std::ostream& out);
+  static void writeResult(std::ostream& out, const BenchResult& r);
+
+private:
+  std::vector<Entry> m_entries;
+  std::string m_filter;
+  int m_repetitions = 30;
+  std::chrono::nanoseconds m_sample_time = std::chrono::milliseconds(10);
+  std::vector<BenchResult> m_results;
+};
+
+} // namespace gonk
+
+#endif // GONK_SCRIPT_BENCH_H
@@ -11,13 +11,31 @@
 #include <script/function.h>
 #include <script/value.h>
 
+#include <memory>
 #include <unordered_map>
 
 class Gonk;
 
+namespace script
+{
+namespace interpreter
+{
+class DebugHandler;
+} // namespace interpreter
+} // namespace script
+
 namespace gonk
 {
 
+class CopyAudit;
+class Coverage;
+class DebugHandlerList;
+class MemoizeCreator;
+class Profiler;
+class SamplingProfiler;
+class ScriptBench;
+class Tracer;
+
 class GONK_API ScriptRunner
 {
 public:
@@ -32,11 +50,32 @@ protected:
   script::Function findMain(const script::Script& s) const;
   script::Function findPushBackFunction(const script::Type& t) const;
   int invokeMain(const script::Script& s);
+  int runBenchmarks();
   script::Value invokeMain(const script::Function& f);
+  bool instrumented() const;
+  void installDebugHandler(std::shared_ptr<script::interpreter::DebugHandler> handler);
+  void startProfiler();
+  void writeProfile();
+  void startSamplingProfiler();
+  void writeSamplingProfile();
+  void startTracer();
+  void writeTrace();
+  void startCoverage();
+  void writeCoverage();
+  void startCopyAudit();
+  void writeCopyAudit();
 
 private:
   Gonk& m_gonk;
   script::CompileMode m_mode = script::CompileMode::Release;
+  std::shared_ptr<DebugHandlerList> m_debug_handlers;
+  std::shared_ptr<Profiler> m_profiler;
+  std::shared_ptr<SamplingProfiler> m_sampling_profiler;
+  std::shared_ptr<Tracer> m_tracer;
+  std::shared_ptr<Coverage> m_coverage;
+  std::shared_ptr<CopyAudit> m_copy_audit;
+  std::shared_ptr<ScriptBench> m_bench;
+  std::shared_ptr<MemoizeCreator> m_memoize;
 };
 
 } // namespace gonk
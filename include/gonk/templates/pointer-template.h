@@ -8,14 +8,35 @@
 #include "gonk/common/pointer.h"
 
 #include <script/classtemplatenativebackend.h>
+#include <script/value.h>
 
 namespace gonk
 {
 
 GONK_API void register_pointer_template(script::Namespace ns);
 
+/*!
+ * \class ValuePointer
+ * \brief storage of the instances of Pointer<T> that have no native specialization
+ *
+ * The referenced value is neither copied nor owned, the pointer must not
+ * outlive it.
+ */
+struct ValuePointer
+{
+  script::Value target;
+};
+
+/*!
+ * \class PointerTemplate
+ * \brief backend of the Pointer<T> class template
+ *
+ * Native types bound with gonk::bind::pointer<T>() use a specialization
+ * storing a gonk::Pointer<T>, the other instances store a ValuePointer.
+ */
 class PointerTemplate : public script::ClassTemplateNativeBackend
 {
+public:
   script::Class instantiate(script::ClassTemplateInstanceBuilder& builder) override;
 };
 
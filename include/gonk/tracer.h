@@ -0,0 +1,131 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_TRACER_H
+#define GONK_TRACER_H
+
+#include "gonk/gonk-defs.h"
+
+#include "gonk/instrumentation.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gonk
+{
+
+/*!
+ * \class Tracer
+ * \brief records a timeline of the execution in the Chrome trace-event format
+ *
+ * Script function calls are derived from the changes of the interpreter
+ * callstack observed on each breakpoint, native calls are reported by the
+ * bindings (see NativeCallScope) and module loading phases by TraceScope.
+ * Events are kept in memory and only written by save().
+ */
+class GONK_API Tracer : public script::interpreter::DebugHandler, public NativeCallObserver
+{
+public:
+  Tracer();
+  ~Tracer();
+
+  using clock = std::chrono::steady_clock;
+
+  enum Category : uint8_t
+  {
+    Script,
+    Native,
+    Module,
+  };
+
+  struct Event
+  {
+    char phase;
+    Category category;
+    uint32_t name;
+    clock::duration timestamp;
+  };
+
+  static Tracer* active();
+
+  void start();
+  void stop();
+
+  void begin(Category cat, const std::string& name);
+  void end(Category cat, const std::string& name);
+
+  void interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info) override;
+
+  void enter(script::interpreter::FunctionCall* c) override;
+  void leave(script::interpreter::FunctionCall* c) override;
+
+  const std::vector<Event>& events() const;
+
+  void write(std::ostream& out) const;
+  bool save(const std::string& path) const;
+
+protected:
+  struct Frame
+  {
+    script::interpreter::FunctionCall* call;
+    const void* callee;
+    Category category;
+    uint32_t name;
+    const void* entry; // first breakpoint hit by the call, if observed
+  };
+
+  uint32_t intern(const std::string& name);
+  uint32_t functionName(script::interpreter::FunctionCall* call);
+  void sync(script::interpreter::FunctionCall* call, size_t depth, const void* breakpoint = nullptr);
+
+private:
+  clock::time_point m_start;
+  std::vector<Event> m_events;
+  std::vector<std::string> m_names;
+  std::unordered_map<std::string, uint32_t> m_name_ids;
+  std::unordered_map<const void*, uint32_t> m_function_names;
+  std::vector<Frame> m_stack;
+};
+
+/*!
+ * \class TraceScope
+ * \brief emits a begin/end pair of events if a tracer is active
+ */
+class TraceScope
+{
+public:
+  TraceScope(Tracer::Category cat, const std::string& name)
+    : m_tracer(Tracer::active()),
+      m_category(cat)
+  {
+    if (m_tracer)
+    {
+      m_name = name;
+      m_tracer->begin(cat, name);
+    }
+  }
+
+  TraceScope(const TraceScope&) = delete;
+
+  ~TraceScope()
+  {
+    if (m_tracer)
+      m_tracer->end(m_category, m_name);
+  }
+
+  TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+  Tracer* m_tracer;
+  Tracer::Category m_category;
+  std::string m_name;
+};
+
+} // namespace gonk
+
+#endif // GONK_TRACER_H
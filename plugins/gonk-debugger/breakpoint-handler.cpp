@@ -15,13 +15,32 @@
 #include <script/script.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
 
 namespace gonk
 {
 
+static std::string content_hash(const std::string& content)
+{
+  // 64-bit FNV-1a, only used to detect that a client already has the source
+  uint64_t h = 14695981039346656037ull;
+
+  for (char c : content)
+  {
+    h ^= static_cast<unsigned char>(c);
+    h *= 1099511628211ull;
+  }
+
+  char buffer[17];
+  std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(h));
+  return std::string(buffer);
+}
+
 GonkDebugHandler::GonkDebugHandler(debugger::Server& serv, State s)
   : comm(serv),
-    m_state(s)
+    m_state(s),
+    m_attached(serv.isConnected())
 {
 
 }
@@ -36,6 +55,12 @@ void GonkDebugHandler::interrupt(script::interpreter::FunctionCall& call, script
   m_call = &call;
   m_breakpoint = &info;
 
+  if (m_attached && !comm.isConnected())
+    detach();
+
+  if (!m_attached && !pollConnection())
+    return;
+
   if (shouldBreak(call, info))
   {
     doBreak();
@@ -49,6 +74,49 @@ void GonkDebugHandler::interrupt(script::interpreter::FunctionCall& call, script
   }
 }
 
+bool GonkDebugHandler::pollConnection()
+{
+  // Polling the socket on every statement would slow down the script,
+  // so only check for a new client every few hundreds statements.
+  if ((++m_interrupts_since_poll & 0xFF) != 0)
+    return false;
+
+  auto now = std::chrono::steady_clock::now();
+
+  if (now - m_last_poll < std::chrono::milliseconds(50))
+    return false;
+
+  m_last_poll = now;
+  comm.poll();
+
+  if (!comm.isConnected())
+    return false;
+
+  attach();
+  return true;
+}
+
+void GonkDebugHandler::attach()
+{
+  m_attached = true;
+  m_state = State::StepInto;
+}
+
+void GonkDebugHandler::detach()
+{
+  m_attached = false;
+  m_state = State::Running;
+
+  while (!m_breakpoints.empty())
+    eraseBreakpoint(m_breakpoints.begin());
+
+  // the next client starts with the default snapshot configuration
+  m_snapshot_enabled = false;
+  m_snapshot_frames = -1;
+  m_snapshot_variables = true;
+  m_snapshot_source = true;
+}
+
 bool GonkDebugHandler::shouldBreak(script::interpreter::FunctionCall& call, script::program::Breakpoint& info)
 {
   return (m_state == State::StepInto) ||
@@ -73,13 +141,22 @@ void GonkDebugHandler::doBreak()
   m_state = State::Break;
   m_sp = static_cast<int>(m_call->stackOffset());
 
-  comm.notifyBreak();
+  if (m_snapshot_enabled)
+    comm.notifyBreak(snapshot());
+  else
+    comm.notifyBreak();
 
   for (;;)
   {
-    while (!comm.hasPendingRequests())
+    while (!comm.hasPendingRequests() && comm.isConnected())
       comm.waitForRequest();
 
+    if (!comm.isConnected())
+    {
+      detach();
+      return;
+    }
+
     std::vector<debugger::Request> reqs{ std::move(comm.pendingRequests()) };
 
     for (auto& r : reqs)
@@ -110,7 +187,10 @@ void GonkDebugHandler::process(debugger::Request& req)
     m_state = State::StepOut;
     break;
   case debugger::RequestType::GetSourceCode:
-    sendSource(req.data<debugger::GetSourceCode>().path);
+  {
+    auto data = req.data<debugger::GetSourceCode>();
+    sendSource(data.path, data.hash);
+  }
     break;
   case debugger::RequestType::GetBreakpointList:
     sendBreakpointList();
@@ -137,35 +217,76 @@ void GonkDebugHandler::process(debugger::Request& req)
       removeBreakpoint(data.script_path, data.line);
   }
     break;
+  case debugger::RequestType::Detach:
+    comm.disconnect();
+    detach();
+    break;
+  case debugger::RequestType::ConfigureSnapshot:
+  {
+    auto data = req.data<debugger::ConfigureSnapshot>();
+    m_snapshot_enabled = data.enabled;
+    m_snapshot_frames = data.frames;
+    m_snapshot_variables = data.variables;
+    m_snapshot_source = data.source;
+  }
+    break;
   default:
     break;
   }
 }
 
-void GonkDebugHandler::sendSource(const std::string& path)
+std::shared_ptr<debugger::SourceCode> GonkDebugHandler::getSource(const std::string& path)
 {
+  auto it = m_sources.find(path);
+
+  if (it != m_sources.end())
+    return it->second;
+
   script::Script s = findScript(path);
 
   if (s.isNull())
+    return nullptr;
+
+  auto src = std::make_shared<debugger::SourceCode>();
+
+  src->path = path;
+  src->source = s.source().content();
+  src->hash = content_hash(src->source);
+
+  GonkAstProducer astproducer;
+  src->syntaxtree = astproducer.produce(s.ast());
+
+  m_sources[path] = src;
+
+  return src;
+}
+
+void GonkDebugHandler::sendSource(const std::string& path, const std::string& hash)
+{
+  std::shared_ptr<debugger::SourceCode> src = getSource(path);
+
+  if (!src)
   {
-    debugger::SourceCode src;
+    debugger::SourceCode notfound;
 
-    src.path = path;
-    src.source = "could not find source code of " + path;
+    notfound.path = path;
+    notfound.source = "could not find source code of " + path;
 
-    comm.reply(src);
+    comm.reply(notfound);
   }
-  else
+  else if (!hash.empty() && hash == src->hash)
   {
-    debugger::SourceCode src;
+    debugger::SourceCode unchanged;
 
-    src.path = path;
-    src.source = m_call->callee().script().source().content();
+    unchanged.path = path;
+    unchanged.hash = src->hash;
+    unchanged.unchanged = true;
 
-    GonkAstProducer astproducer;
-    src.syntaxtree = astproducer.produce(m_call->callee().script().ast());
-
-    comm.reply(src);
+    comm.reply(unchanged);
+  }
+  else
+  {
+    comm.reply(*src);
   }
 }
 
@@ -191,13 +312,19 @@ void GonkDebugHandler::sendBreakpointList()
   comm.reply(list);
 }
 
-void GonkDebugHandler::sendCallstack()
+debugger::Callstack GonkDebugHandler::callstack(int max_frames) const
 {
   debugger::Callstack result;
 
   script::interpreter::Callstack& cs = m_call->executionContext()->callstack;
+  size_t first = 0;
 
-  for (size_t i(0); i < cs.size(); ++i)
+  if (max_frames >= 0 && cs.size() > static_cast<size_t>(max_frames))
+    first = cs.size() - static_cast<size_t>(max_frames);
+
+  result.offset = static_cast<int>(first);
+
+  for (size_t i(first); i < cs.size(); ++i)
   {
     script::Function f = cs[i]->callee();
 
@@ -209,10 +336,15 @@ void GonkDebugHandler::sendCallstack()
     result.entries.push_back(entry);
   }
 
-  comm.reply(result);
+  return result;
 }
 
-void GonkDebugHandler::sendVariables(int d)
+void GonkDebugHandler::sendCallstack()
+{
+  comm.reply(callstack());
+}
+
+std::shared_ptr<debugger::VariableList> GonkDebugHandler::variables(int d) const
 {
   script::interpreter::Callstack& cs = m_call->executionContext()->callstack;
   int cs_size = static_cast<int>(cs.size());
@@ -226,8 +358,8 @@ void GonkDebugHandler::sendVariables(int d)
   // this would allow the _gonk_repr__ function lookup to be cached
   GonkValueSerializer serializer{ *e };
 
-  debugger::VariableList result;
-  result.callstack_depth = d;
+  auto result = std::make_shared<debugger::VariableList>();
+  result->callstack_depth = d;
 
   for (size_t i(0); i < w.size(); ++i)
   {
@@ -235,10 +367,44 @@ void GonkDebugHandler::sendVariables(int d)
     v->offset = static_cast<int>(w.stackOffsetAt(i));
     v->type = e->toString(w.varTypeAt(i));
     v->name = w.nameAt(i);
-    result.variables.push_back(v);
+    result->variables.push_back(v);
+  }
+
+  return result;
+}
+
+void GonkDebugHandler::sendVariables(int d)
+{
+  comm.reply(*variables(d));
+}
+
+debugger::BreakSnapshot GonkDebugHandler::snapshot()
+{
+  debugger::BreakSnapshot result;
+
+  if (m_snapshot_frames != 0)
+    result.callstack = std::make_shared<debugger::Callstack>(callstack(m_snapshot_frames));
+
+  if (m_snapshot_variables)
+    result.variables = variables(-1);
+
+  if (m_snapshot_source)
+  {
+    script::Script s = m_call->callee().script();
+
+    if (!s.isNull())
+    {
+      std::shared_ptr<debugger::SourceCode> src = getSource(s.path());
+
+      if (src)
+      {
+        result.path = src->path;
+        result.source_hash = src->hash;
+      }
+    }
   }
 
-  comm.reply(result);
+  return result;
 }
 
 void GonkDebugHandler::addBreakpoint(const std::string& script_path, int line)
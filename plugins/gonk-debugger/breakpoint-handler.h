@@ -7,8 +7,10 @@
 #include <script/interpreter/debug-handler.h>
 #include <script/function.h>
 
+#include <chrono>
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace gonk
@@ -18,6 +20,10 @@ namespace debugger
 {
 class Server;
 struct Request;
+struct SourceCode;
+struct Callstack;
+struct VariableList;
+struct BreakSnapshot;
 } // namespace debugger
 
 class GonkDebugHandler : public script::interpreter::DebugHandler
@@ -39,14 +45,21 @@ public:
   void interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info) override;
 
 protected:
+  bool pollConnection();
+  void attach();
+  void detach();
   bool shouldBreak(script::interpreter::FunctionCall& call, script::program::Breakpoint& info);
   script::Script findScript(const std::string& path) const;
   void doBreak();
   void process(debugger::Request& req);
-  void sendSource(const std::string& path);
+  std::shared_ptr<debugger::SourceCode> getSource(const std::string& path);
+  void sendSource(const std::string& path, const std::string& hash);
   void sendBreakpointList();
+  debugger::Callstack callstack(int max_frames = -1) const;
   void sendCallstack();
+  std::shared_ptr<debugger::VariableList> variables(int d) const;
   void sendVariables(int d);
+  debugger::BreakSnapshot snapshot();
   void addBreakpoint(const std::string& script_path, int line);
   void removeBreakpoint(int id);
   void removeBreakpoint(const std::string& script_path, int line);
@@ -57,13 +70,21 @@ protected:
   void eraseBreakpoint(std::map<int, std::vector<BreakpointEntry>>::iterator it);
 
 private:
+  debugger::Server& comm;
   State m_state;
   int m_sp = -1;
-  debugger::Server& comm;
+  bool m_attached = false;
+  unsigned int m_interrupts_since_poll = 0;
+  std::chrono::steady_clock::time_point m_last_poll;
+  bool m_snapshot_enabled = false;
+  int m_snapshot_frames = -1;
+  bool m_snapshot_variables = true;
+  bool m_snapshot_source = true;
   script::interpreter::FunctionCall* m_call = nullptr;
   script::program::Breakpoint* m_breakpoint = nullptr;
   int m_breakpoint_counter = 0;
   std::map<int, std::vector<BreakpointEntry>> m_breakpoints;
+  std::map<std::string, std::shared_ptr<debugger::SourceCode>> m_sources;
 };
 
 } // namespace gonk
\ No newline at end of file
@@ -15,11 +15,54 @@
 #include <script/namespace.h>
 #include <script/typesystem.h>
 
+#include <cstdlib>
 #include <iostream>
+#include <string>
 
 namespace gonk
 {
 
+namespace debugger
+{
+
+// command line options take precedence over the environment
+static ServerConfig read_server_config(const gonk::CLI& cli, bool& wait_for_client)
+{
+  ServerConfig config;
+
+  if (const char* port = std::getenv("GONK_DEBUG_PORT"))
+  {
+    const int value = std::atoi(port);
+
+    if (value >= 1 && value <= 65535)
+      config.port = value;
+    else
+      std::cerr << "ignoring invalid GONK_DEBUG_PORT: " << port << std::endl;
+  }
+
+  if (const char* path = std::getenv("GONK_DEBUG_SOCKET"))
+    config.local_socket = path;
+
+  if (const char* attach = std::getenv("GONK_DEBUG_ATTACH"))
+    wait_for_client = std::string(attach) != "1";
+
+  if (cli.debug_port.has_value())
+  {
+    config.port = cli.debug_port.value();
+    config.local_socket.clear();
+  }
+
+  if (cli.debug_socket.has_value())
+    config.local_socket = cli.debug_socket.value();
+
+  if (cli.debug_attach)
+    wait_for_client = false;
+
+  return config;
+}
+
+} // namespace debugger
+
 } // namespace gonk
 
 class GonkDebuggerPlugin : public gonk::Plugin
@@ -35,10 +78,22 @@ public:
 
     std::cout << "loading debugger" << std::endl;
 
-    comm.reset(new gonk::debugger::Server);
-    comm->waitForConnection();
+    bool wait_for_client = true;
+    gonk::debugger::ServerConfig config = gonk::debugger::read_server_config(gonk::Gonk::Instance().cli(), wait_for_client);
+
+    comm.reset(new gonk::debugger::Server(config));
+
+    if (wait_for_client)
+    {
+      comm->waitForConnection();
+      debug_handler = std::make_shared<gonk::GonkDebugHandler>(*comm, gonk::GonkDebugHandler::StepInto);
+    }
+    else
+    {
+      // the script runs until a client attaches, the handler then starts stepping
+      debug_handler = std::make_shared<gonk::GonkDebugHandler>(*comm, gonk::GonkDebugHandler::Running);
+    }
 
-    debug_handler = std::make_shared<gonk::GonkDebugHandler>(*comm, gonk::GonkDebugHandler::StepInto);
     e->interpreter()->setDebugHandler(debug_handler);
 
     std::cout << "debugger ready" << std::endl;
@@ -31,8 +31,6 @@ inline void JsonStreamParser::write(const std::string& data)
 {
   m_tokenizer.write(data);
 
-  json::ParserMachine<json::DefaultParserBackend> m_parser;
-
   for (const auto& tok : m_tokenizer.backend().token_buffer)
   {
     m_parser.write(tok);
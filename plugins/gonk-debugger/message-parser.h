@@ -0,0 +1,149 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_DEBUGGER_MESSAGEPARSER_H
+#define GONK_DEBUGGER_MESSAGEPARSER_H
+
+#include "message.h"
+
+#include <memory>
+#include <string>
+
+// Client-side decoding of the messages sent by the debugger server,
+// shared by the debugger front-ends.
+
+namespace gonk
+{
+
+namespace debugger
+{
+
+inline std::shared_ptr<Variable> parseVariable(const json::Object& json)
+{
+  auto ret = std::make_shared<Variable>();
+
+  ret->name = json["name"].toString();
+  ret->offset = json["offset"].toInt();
+  ret->type = json["type"].toString();
+  ret->value = json["value"].toString();
+
+  if (json["members"].isArray() && json["members"].toArray().length() > 0)
+  {
+    json::Array members = json["members"].toArray();
+
+    for (int i(0); i < members.length(); ++i)
+      ret->members.push_back(parseVariable(members.at(i).toObject()));
+  }
+
+  return ret;
+}
+
+inline std::shared_ptr<VariableList> parseVariableList(const json::Object& message)
+{
+  auto mssg = std::make_shared<VariableList>();
+
+  mssg->callstack_depth = message["depth"].toInt();
+
+  json::Array list = message["variables"].toArray();
+
+  for (int i(0); i < list.length(); ++i)
+    mssg->variables.push_back(parseVariable(list.at(i).toObject()));
+
+  return mssg;
+}
+
+inline std::shared_ptr<Callstack> parseCallstack(const json::Object& message)
+{
+  auto mssg = std::make_shared<Callstack>();
+
+  if (message["offset"].isInteger())
+    mssg->offset = message["offset"].toInt();
+
+  json::Array list = message["stack"].toArray();
+
+  for (int i(0); i < list.length(); ++i)
+  {
+    json::Object jsonentry = list.at(i).toObject();
+    CallstackEntry entry;
+    entry.function = jsonentry["function"].toString();
+    entry.path = jsonentry["path"].toString();
+    entry.line = jsonentry["line"].toInt();
+    mssg->entries.push_back(entry);
+  }
+
+  return mssg;
+}
+
+inline std::shared_ptr<BreakpointList> parseBreakpointList(const json::Object& message)
+{
+  auto mssg = std::make_shared<BreakpointList>();
+
+  json::Array list = message["list"].toArray();
+
+  for (int i(0); i < list.length(); ++i)
+  {
+    json::Object js = list.at(i).toObject();
+
+    BreakpointData bp;
+    bp.function = js["function"].toString();
+    bp.id = js["id"].toInt();
+    bp.line = js["line"].toInt();
+    bp.script_path = js["path"].toString();
+
+    mssg->list.push_back(bp);
+  }
+
+  return mssg;
+}
+
+inline std::shared_ptr<SourceCode> parseSourceCode(const json::Object& message)
+{
+  auto mssg = std::make_shared<SourceCode>();
+  mssg->path = message["path"].toString();
+
+  if (message["hash"].isString())
+    mssg->hash = message["hash"].toString();
+
+  if (message["unchanged"].isBoolean() && message["unchanged"].toBool())
+  {
+    mssg->unchanged = true;
+  }
+  else
+  {
+    mssg->source = message["text"].toString();
+    mssg->syntaxtree = message["ast"].toObject();
+  }
+
+  return mssg;
+}
+
+// returns nullptr if the break notification has no snapshot
+inline std::shared_ptr<BreakSnapshot> parseBreakSnapshot(const json::Object& message)
+{
+  if (!message["snapshot"].isObject())
+    return nullptr;
+
+  json::Object data = message["snapshot"].toObject();
+  auto mssg = std::make_shared<BreakSnapshot>();
+
+  if (data["callstack"].isObject())
+    mssg->callstack = parseCallstack(data["callstack"].toObject());
+
+  if (data["variables"].isObject())
+    mssg->variables = parseVariableList(data["variables"].toObject());
+
+  if (data["path"].isString())
+  {
+    mssg->path = data["path"].toString();
+    mssg->source_hash = data["hash"].toString();
+  }
+
+  return mssg;
+}
+
+} // namespace debugger
+
+} // namespace gonk
+
+#endif // GONK_DEBUGGER_MESSAGEPARSER_H
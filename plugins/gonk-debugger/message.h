@@ -25,6 +25,8 @@ public:
 struct SourceCode : DebuggerMessage
 {
   std::string path;
+  std::string hash;
+  bool unchanged = false;
   std::string source;
   json::Object syntaxtree;
 };
@@ -38,6 +40,7 @@ struct CallstackEntry
 
 struct Callstack : DebuggerMessage
 {
+  int offset = 0; // depth of the first entry, non-zero if the bottom of the stack was omitted
   std::vector<CallstackEntry> entries;
 };
 
@@ -69,6 +72,14 @@ struct VariableList : DebuggerMessage
   std::vector<std::shared_ptr<Variable>> variables;
 };
 
+struct BreakSnapshot : DebuggerMessage
+{
+  std::shared_ptr<Callstack> callstack;
+  std::shared_ptr<VariableList> variables;
+  std::string path;
+  std::string source_hash;
+};
+
 } // namespace debugger
 
 } // namespace gonk
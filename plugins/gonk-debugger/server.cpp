@@ -6,7 +6,9 @@
 
 #include <json-toolkit/stringify.h>
 
+#include <cstdio>
 #include <iostream>
+#include <stdexcept>
 
 namespace gonk
 {
@@ -14,22 +16,85 @@ namespace gonk
 namespace debugger
 {
 
-Server::Server()
-  : m_acceptor(m_io_context, tcp::endpoint(tcp::v4(), 24242))
+Server::Server(const ServerConfig& config)
+  : m_acceptor(m_io_context)
 {
+  protocol::endpoint endpoint;
+
+  if (!config.local_socket.empty())
+  {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    // remove a socket file left behind by a previous run
+    std::remove(config.local_socket.c_str());
+    m_local_socket = config.local_socket;
+    endpoint = boost::asio::local::stream_protocol::endpoint(config.local_socket);
+#else
+    throw std::runtime_error("Unix domain sockets are not supported on this platform");
+#endif // defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  }
+  else
+  {
+    endpoint = tcp::endpoint(tcp::v4(), static_cast<unsigned short>(config.port));
+  }
+
+  m_acceptor.open(endpoint.protocol());
+
+  if (m_local_socket.empty())
+    m_acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+
+  m_acceptor.bind(endpoint);
+  m_acceptor.listen();
+
   start_accept();
 }
 
 Server::~Server()
 {
+  boost::system::error_code ec;
+  m_acceptor.close(ec);
 
+  if (!m_local_socket.empty())
+    std::remove(m_local_socket.c_str());
+}
+
+bool Server::isConnected() const
+{
+  return m_connection != nullptr;
 }
 
 void Server::waitForConnection()
 {
   std::cout << "waiting for connection" << std::endl;
-  m_io_context.run();
-  m_io_context.restart();
+
+  while (!isConnected())
+  {
+    m_io_context.run_one();
+    restart_if_stopped();
+  }
+}
+
+void Server::poll()
+{
+  m_io_context.poll();
+  restart_if_stopped();
+}
+
+void Server::disconnect()
+{
+  if (!m_connection)
+    return;
+
+  boost::system::error_code ec;
+  m_connection->socket().shutdown(protocol::socket::shutdown_both, ec);
+  m_connection->socket().close(ec);
+  m_connection.reset();
+
+  m_requests.clear();
+  m_json_stream = std::make_unique<JsonStreamParser>();
+
+  std::cout << "debugger client disconnected" << std::endl;
+
+  start_accept();
 }
 
 void Server::notifyRun()
@@ -46,6 +111,32 @@ void Server::notifyBreak()
   send(resp);
 }
 
+void Server::notifyBreak(const BreakSnapshot& snapshot)
+{
+  json::Object resp;
+  resp["type"] = "break";
+
+  {
+    json::Object data;
+
+    if (snapshot.callstack)
+      data["callstack"] = serialize(*snapshot.callstack);
+
+    if (snapshot.variables)
+      data["variables"] = serialize(*snapshot.variables);
+
+    if (!snapshot.path.empty())
+    {
+      data["path"] = snapshot.path;
+      data["hash"] = snapshot.source_hash;
+    }
+
+    resp["snapshot"] = data;
+  }
+
+  send(resp);
+}
+
 void Server::notifyGoodbye()
 {
   json::Object resp;
@@ -66,6 +157,7 @@ std::vector<Request>& Server::pendingRequests()
 bool Server::receiveRequest()
 {
   m_io_context.poll_one();
+  restart_if_stopped();
   return hasPendingRequests();
 }
 
@@ -75,6 +167,7 @@ bool Server::waitForRequest(int msecs)
     return false;
 
   m_io_context.run_for(std::chrono::milliseconds(msecs));
+  restart_if_stopped();
 
   return hasPendingRequests();
 }
@@ -107,6 +200,10 @@ Request Server::parseRequest(json::Object reqjson)
   {
     GetSourceCode data;
     data.path = reqjson["path"].toString();
+
+    if (reqjson["hash"].isString())
+      data.hash = reqjson["hash"].toString();
+
     return Request(data);
   }
   else if (reqtype == "getbreakpoints")
@@ -143,6 +240,28 @@ Request Server::parseRequest(json::Object reqjson)
 
     return Request(data);
   }
+  else if (reqtype == "detach")
+  {
+    return Request::make<RequestType::Detach>();
+  }
+  else if (reqtype == "setsnapshot")
+  {
+    ConfigureSnapshot data;
+
+    if (reqjson["enabled"].isBoolean())
+      data.enabled = reqjson["enabled"].toBool();
+
+    if (reqjson["frames"].isInteger())
+      data.frames = reqjson["frames"].toInt();
+
+    if (reqjson["variables"].isBoolean())
+      data.variables = reqjson["variables"].toBool();
+
+    if (reqjson["source"].isBoolean())
+      data.source = reqjson["source"].toBool();
+
+    return Request(data);
+  }
 
   return Request::make<RequestType::Run>();
 }
@@ -152,8 +271,18 @@ json::Object Server::serialize(const SourceCode& src)
   json::Object obj;
   obj["type"] = "sourcecode";
   obj["path"] = src.path;
-  obj["text"] = src.source;
-  obj["ast"] = src.syntaxtree;
+  obj["hash"] = src.hash;
+
+  if (src.unchanged)
+  {
+    obj["unchanged"] = true;
+  }
+  else
+  {
+    obj["text"] = src.source;
+    obj["ast"] = src.syntaxtree;
+  }
+
   return obj;
 }
 
@@ -186,6 +315,9 @@ json::Object Server::serialize(const Callstack& cs)
   json::Object obj;
   obj["type"] = "callstack";
 
+  if (cs.offset > 0)
+    obj["offset"] = cs.offset;
+
   {
     json::Array stack;
 
@@ -250,15 +382,19 @@ void Server::send(json::Object response)
   if (m_connection)
   {
     std::string bytes = json::stringify(response);
-    boost::asio::write(m_connection->socket(), boost::asio::buffer(bytes));
+    boost::system::error_code ec;
+    boost::asio::write(m_connection->socket(), boost::asio::buffer(bytes), ec);
+
+    if (ec)
+      disconnect();
   }
 }
 
 void Server::start_accept()
 {
-  m_connection = TcpConnection::create(m_io_context);
+  m_pending_connection = Connection::create(m_io_context);
 
-  m_acceptor.async_accept(m_connection->socket(),
+  m_acceptor.async_accept(m_pending_connection->socket(),
     [this](const boost::system::error_code& error) {
       handle_accept(error);
     });
@@ -266,43 +402,68 @@ void Server::start_accept()
 
 void Server::handle_accept(const boost::system::error_code& error)
 {
-  if (!error)
+  if (error)
   {
-    m_io_context.stop();
-    start_read();
+    if (error != boost::asio::error::operation_aborted)
+      start_accept();
+
+    return;
   }
 
-  //start_accept();
+  // only one client at a time, the next one is accepted after a detach
+  m_connection = std::move(m_pending_connection);
+  m_json_stream = std::make_unique<JsonStreamParser>();
+
+  std::cout << "debugger client connected" << std::endl;
+
+  start_read();
 }
 
 void Server::start_read()
 {
-  m_connection->buffer().clear();
-  m_connection->buffer().resize(2048);
+  Connection::pointer conn = m_connection;
+
+  conn->buffer().clear();
+  conn->buffer().resize(2048);
 
-  boost::asio::async_read(m_connection->socket(), boost::asio::buffer(m_connection->buffer()),
+  boost::asio::async_read(conn->socket(), boost::asio::buffer(conn->buffer()),
     boost::asio::transfer_at_least(1),
-    [this](const boost::system::error_code& error, size_t bytes_transferred) {
-      handle_read(error, bytes_transferred);
+    [this, conn](const boost::system::error_code& error, size_t bytes_transferred) {
+      handle_read(conn, error, bytes_transferred);
     });
 }
 
-void Server::handle_read(const boost::system::error_code& error, size_t bytes_transferred)
+void Server::handle_read(Connection::pointer conn, const boost::system::error_code& error, size_t bytes_transferred)
 {
-  std::string& buffer = m_connection->buffer();
+  if (conn != m_connection)
+    return;
+
+  if (error)
+  {
+    disconnect();
+    return;
+  }
+
+  std::string& buffer = conn->buffer();
   buffer.resize(bytes_transferred);
-  m_json_stream.write(buffer);
+  m_json_stream->write(buffer);
 
-  for (json::Object obj : m_json_stream.objects)
+  for (json::Object obj : m_json_stream->objects)
   {
     m_requests.push_back(parseRequest(obj));
   }
 
-  m_json_stream.objects.clear();
+  m_json_stream->objects.clear();
 
   start_read();
 }
 
+void Server::restart_if_stopped()
+{
+  if (m_io_context.stopped())
+    m_io_context.restart();
+}
+
 } // namespace debugger
 
 } // namespace gonk
@@ -8,6 +8,7 @@
 #include <boost/asio.hpp>
 
 #include <memory>
+#include <string>
 #include <variant>
 #include <vector>
 
@@ -31,7 +32,9 @@ enum class RequestType
   GetCallStack,
   GetVariables,
   AddBreakpoint,
-  RemoveBreakpoint
+  RemoveBreakpoint,
+  Detach,
+  ConfigureSnapshot
 };
 
 template<RequestType RT>
@@ -40,6 +43,7 @@ struct EmptyData { };
 struct GetSourceCode
 {
   std::string path;
+  std::string hash;
 };
 
 struct GetVariables
@@ -60,6 +64,14 @@ struct RemoveBreakpoint
   int line = -1;
 };
 
+struct ConfigureSnapshot
+{
+  bool enabled = true;
+  int frames = -1;
+  bool variables = true;
+  bool source = true;
+};
+
 struct Request
 {
   using Data = std::variant<
@@ -73,7 +85,9 @@ struct Request
     EmptyData<RequestType::GetCallStack>,
     GetVariables,
     AddBreakpoint,
-    RemoveBreakpoint
+    RemoveBreakpoint,
+    EmptyData<RequestType::Detach>,
+    ConfigureSnapshot
   >;
   
   Data data_;
@@ -104,19 +118,19 @@ struct Request
 
 /* Server */
 
-class TcpConnection : public std::enable_shared_from_this<TcpConnection>
+class Connection : public std::enable_shared_from_this<Connection>
 {
 public:
-  typedef std::shared_ptr<TcpConnection> pointer;
+  typedef std::shared_ptr<Connection> pointer;
 
-  using tcp = boost::asio::ip::tcp;
+  using protocol = boost::asio::generic::stream_protocol;
 
   static pointer create(boost::asio::io_context& io_context)
   {
-    return pointer(new TcpConnection(io_context));
+    return pointer(new Connection(io_context));
   }
 
-  tcp::socket& socket()
+  protocol::socket& socket()
   {
     return socket_;
   }
@@ -127,25 +141,35 @@ public:
   }
 
 private:
-  TcpConnection(boost::asio::io_context& io_context)
+  Connection(boost::asio::io_context& io_context)
     : socket_(io_context)
   {
     buffer_.resize(2048);
   }
 
-  tcp::socket socket_;
+  protocol::socket socket_;
   std::string buffer_;
 };
 
+struct ServerConfig
+{
+  int port = 24242;
+  std::string local_socket; // if not empty, listen on a Unix domain socket instead of TCP
+};
+
 class Server
 {
 public:
-  Server();
+  explicit Server(const ServerConfig& config = {});
   ~Server();
 
   using tcp = boost::asio::ip::tcp;
+  using protocol = Connection::protocol;
 
+  bool isConnected() const;
   void waitForConnection();
+  void poll();
+  void disconnect();
 
   bool hasPendingRequests() const;
   std::vector<Request>& pendingRequests();
@@ -154,10 +178,11 @@ public:
 
   void notifyRun();
   void notifyBreak();
+  void notifyBreak(const BreakSnapshot& snapshot);
   void notifyGoodbye();
 
   template<typename T>
-  void reply(T response_data);
+  void reply(const T& response_data);
 
 protected:
   Request parseRequest(json::Object reqjson);
@@ -173,18 +198,21 @@ private:
   void start_accept();
   void handle_accept(const boost::system::error_code& error);
   void start_read();
-  void handle_read(const boost::system::error_code& error, size_t bytes_transferred);
+  void handle_read(Connection::pointer conn, const boost::system::error_code& error, size_t bytes_transferred);
+  void restart_if_stopped();
 
 private:
   boost::asio::io_context m_io_context;
-  tcp::acceptor m_acceptor;
-  TcpConnection::pointer m_connection;
+  boost::asio::basic_socket_acceptor<protocol> m_acceptor;
+  std::string m_local_socket;
+  Connection::pointer m_pending_connection;
+  Connection::pointer m_connection;
   std::vector<Request> m_requests;
-  JsonStreamParser m_json_stream;
+  std::unique_ptr<JsonStreamParser> m_json_stream;
 };
 
 template<typename T>
-inline void Server::reply(T response_data)
+inline void Server::reply(const T& response_data)
 {
   json::Object obj = serialize(response_data);
   send(obj);
@@ -0,0 +1,98 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk-memoize.h"
+
+#include "gonk/common/binding/function.h"
+#include "gonk/memoize.h"
+
+#include <script/namespace.h>
+
+#include <sstream>
+
+namespace gonk
+{
+
+namespace memoize_module
+{
+
+static gonk::MemoStats find(const std::string& name)
+{
+  gonk::MemoStats result;
+
+  // overloads share their name, their statistics are summed
+  for (const gonk::MemoStats& s : memoize::stats())
+  {
+    if (s.name != name)
+      continue;
+
+    result.name = name;
+    result.capacity += s.capacity;
+    result.size += s.size;
+    result.hits += s.hits;
+    result.misses += s.misses;
+    result.evictions += s.evictions;
+  }
+
+  return result;
+}
+
+static int hits(const std::string& name)
+{
+  return static_cast<int>(find(name).hits);
+}
+
+static int misses(const std::string& name)
+{
+  return static_cast<int>(find(name).misses);
+}
+
+static int size(const std::string& name)
+{
+  return static_cast<int>(find(name).size);
+}
+
+static std::string report()
+{
+  std::stringstream ss;
+  memoize::write_report(ss);
+  return ss.str();
+}
+
+} // namespace memoize_module
+
+} // namespace gonk
+
+static void register_memoize_functions(script::Namespace ns)
+{
+  using namespace gonk::memoize_module;
+
+  gonk::bind::free_function<int, const std::string&, &hits>(ns, "hits").create();
+  gonk::bind::free_function<int, const std::string&, &misses>(ns, "misses").create();
+  gonk::bind::free_function<int, const std::string&, &size>(ns, "size").create();
+  gonk::bind::free_function<std::string, &report>(ns, "report").create();
+}
+
+class GonkMemoizePlugin : public gonk::Plugin
+{
+public:
+
+  void load(script::Module m) override
+  {
+    // the caches count their hits and misses whether or not this module
+    // is imported, unlike gonk.stats this does not enable memstats
+    script::Namespace ns = m.root().getNamespace("gonk").getNamespace("memoize");
+    register_memoize_functions(ns);
+  }
+
+  void unload(script::Module m) override
+  {
+
+  }
+};
+
+gonk::Plugin* gonk_memoize_module()
+{
+  return new GonkMemoizePlugin();
+}
@@ -0,0 +1,18 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_GONK_STATS_DEFS_H
+#define GONK_GONK_STATS_DEFS_H
+
+#if (defined(WIN32) || defined(_WIN32))
+#if defined(GONK_GONK_STATS_COMPILE_LIBRARY)
+#  define GONK_GONK_STATS_API __declspec(dllexport)
+#else
+#  define GONK_GONK_STATS_API __declspec(dllimport)
+#endif
+#else
+#define GONK_GONK_STATS_API
+#endif
+
+#endif // GONK_GONK_STATS_DEFS_H
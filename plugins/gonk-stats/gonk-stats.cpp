@@ -0,0 +1,168 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk-stats.h"
+
+#include "gonk/common/binding/function.h"
+#include "gonk/memstats.h"
+
+#include <script/engine.h>
+#include <script/namespace.h>
+#include <script/typesystem.h>
+
+#include <sstream>
+
+namespace gonk
+{
+
+namespace stats
+{
+
+static script::Engine* g_engine = nullptr;
+
+static memstats::TypeCounters find_counters(const std::string& type_name)
+{
+  memstats::TypeCounters result;
+
+  for (const auto& p : memstats::counters())
+  {
+    if (g_engine->typeSystem()->typeName(script::Type(p.first)) == type_name)
+      return p.second;
+  }
+
+  return result;
+}
+
+static memstats::ContainerStats find_container(const std::string& name)
+{
+  for (const memstats::ContainerStats& c : memstats::containers())
+  {
+    if (c.name == name)
+      return c;
+  }
+
+  return memstats::ContainerStats();
+}
+
+static bool enabled()
+{
+  return memstats::enabled;
+}
+
+static void set_enabled(bool on)
+{
+  memstats::setEnabled(on);
+}
+
+static void reset()
+{
+  memstats::reset();
+}
+
+static int peak_rss()
+{
+  return static_cast<int>(memstats::peak_rss());
+}
+
+static int constructed()
+{
+  return static_cast<int>(memstats::total().constructed);
+}
+
+static int constructed_type(const std::string& type_name)
+{
+  return static_cast<int>(find_counters(type_name).constructed);
+}
+
+static int copied()
+{
+  return static_cast<int>(memstats::total().copied);
+}
+
+static int copied_type(const std::string& type_name)
+{
+  return static_cast<int>(find_counters(type_name).copied);
+}
+
+static int destroyed()
+{
+  return static_cast<int>(memstats::total().destroyed);
+}
+
+static int destroyed_type(const std::string& type_name)
+{
+  return static_cast<int>(find_counters(type_name).destroyed);
+}
+
+static int container_count(const std::string& name)
+{
+  return static_cast<int>(find_container(name).live);
+}
+
+static int container_size(const std::string& name)
+{
+  return static_cast<int>(find_container(name).elements);
+}
+
+static int container_capacity(const std::string& name)
+{
+  return static_cast<int>(find_container(name).capacity);
+}
+
+static std::string report()
+{
+  std::stringstream ss;
+  memstats::write_report(ss, *g_engine);
+  return ss.str();
+}
+
+} // namespace stats
+
+} // namespace gonk
+
+static void register_stats_functions(script::Namespace ns)
+{
+  using namespace gonk::stats;
+
+  gonk::bind::free_function<bool, &enabled>(ns, "enabled").create();
+  gonk::bind::void_function<bool, &set_enabled>(ns, "set_enabled").create();
+  gonk::bind::void_function<&reset>(ns, "reset").create();
+  gonk::bind::free_function<int, &peak_rss>(ns, "peak_rss").create();
+  gonk::bind::free_function<int, &constructed>(ns, "constructed").create();
+  gonk::bind::free_function<int, const std::string&, &constructed_type>(ns, "constructed").create();
+  gonk::bind::free_function<int, &copied>(ns, "copied").create();
+  gonk::bind::free_function<int, const std::string&, &copied_type>(ns, "copied").create();
+  gonk::bind::free_function<int, &destroyed>(ns, "destroyed").create();
+  gonk::bind::free_function<int, const std::string&, &destroyed_type>(ns, "destroyed").create();
+  gonk::bind::free_function<int, const std::string&, &container_count>(ns, "container_count").create();
+  gonk::bind::free_function<int, const std::string&, &container_size>(ns, "container_size").create();
+  gonk::bind::free_function<int, const std::string&, &container_capacity>(ns, "container_capacity").create();
+  gonk::bind::free_function<std::string, &report>(ns, "report").create();
+}
+
+class GonkStatsPlugin : public gonk::Plugin
+{
+public:
+
+  void load(script::Module m) override
+  {
+    gonk::stats::g_engine = m.engine();
+
+    // importing the module is a request for statistics
+    gonk::memstats::setEnabled(true);
+
+    script::Namespace ns = m.root().getNamespace("gonk").getNamespace("stats");
+    register_stats_functions(ns);
+  }
+
+  void unload(script::Module m) override
+  {
+
+  }
+};
+
+gonk::Plugin* gonk_stats_module()
+{
+  return new GonkStatsPlugin();
+}
@@ -0,0 +1,19 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_GONK_STATS_H
+#define GONK_GONK_STATS_H
+
+#include "gonk-stats-defs.h"
+
+#include "gonk/plugin.h"
+
+extern "C"
+{
+
+  GONK_GONK_STATS_API gonk::Plugin* gonk_stats_module();
+
+} // extern "C"
+
+#endif // GONK_GONK_STATS_H
@@ -29,6 +29,16 @@ public:
   {
 
   }
+
+  int value() const
+  {
+    return v;
+  }
+
+  void setValue(int val)
+  {
+    v = val;
+  }
 };
 
 extern "C"
@@ -39,13 +49,10 @@ GONK_TESTHYBRIDMODULE_API int custom_add(const int& a, const int& b)
     return a + b;
 }
 
-GONK_TESTHYBRIDMODULE_API int Integer_value(const Integer& self)
-{
-  return self.v;
-}
-
 } // extern "C"
 
+#include "test-hybrid-module-natives.h"
+
 class GonkTestHybridModulePlugin : public gonk::Plugin
 {
 private:
@@ -60,10 +67,7 @@ public:
     m_creator = std::make_unique<gonk::FunctionCreator>(m.engine(), *library);
     m.asScript().attach(*m_creator);
 
-    m_creator->addCreator<int, const int&, const int&>();
-
-    m_creator->addCtorCreator<Integer, int>();
-    m_creator->addCreator<int, const Integer&>();
+    gonk_test_hybrid_module_natives(*m_creator);
 
     script::Namespace ns = m.root();
 
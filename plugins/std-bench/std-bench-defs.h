@@ -0,0 +1,28 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_STD_BENCH_DEFS_H
+#define GONK_STD_BENCH_DEFS_H
+
+#if (defined(WIN32) || defined(_WIN32))
+#if defined(GONK_STD_BENCH_COMPILE_LIBRARY)
+#  define GONK_STD_BENCH_API __declspec(dllexport)
+#else
+#  define GONK_STD_BENCH_API __declspec(dllimport)
+#endif
+#else
+#define GONK_STD_BENCH_API
+#endif
+
+namespace gonk
+{
+
+namespace std_bench
+{
+
+} // namespace std_bench
+
+} // namespace gonk
+
+#endif // GONK_STD_BENCH_DEFS_H
\ No newline at end of file
@@ -0,0 +1,104 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "std-bench.h"
+
+#include "gonk/common/binding/function.h"
+
+#include <script/engine.h>
+#include <script/namespace.h>
+
+#include <chrono>
+#include <string>
+
+namespace gonk
+{
+
+namespace std_bench
+{
+
+using clock = std::chrono::steady_clock;
+
+// measured from the loading of the module so that doubles keep a
+// nanosecond resolution
+static clock::time_point g_epoch;
+
+static volatile int g_int_sink = 0;
+static volatile double g_double_sink = 0;
+static volatile const void* g_ptr_sink = nullptr;
+
+static double now()
+{
+  return std::chrono::duration<double>(clock::now() - g_epoch).count();
+}
+
+static double now_ns()
+{
+  return std::chrono::duration<double, std::nano>(clock::now() - g_epoch).count();
+}
+
+static double resolution_ns()
+{
+  return 1e9 * static_cast<double>(clock::period::num) / static_cast<double>(clock::period::den);
+}
+
+static void do_not_optimize_bool(bool value)
+{
+  g_int_sink = value;
+}
+
+static void do_not_optimize_int(int value)
+{
+  g_int_sink = value;
+}
+
+static void do_not_optimize_double(double value)
+{
+  g_double_sink = value;
+}
+
+static void do_not_optimize_string(const std::string& value)
+{
+  g_ptr_sink = value.data();
+}
+
+} // namespace std_bench
+
+} // namespace gonk
+
+static void register_bench_functions(script::Namespace ns)
+{
+  using namespace gonk::std_bench;
+
+  gonk::bind::free_function<double, &now>(ns, "now").create();
+  gonk::bind::free_function<double, &now_ns>(ns, "now_ns").create();
+  gonk::bind::free_function<double, &resolution_ns>(ns, "resolution_ns").create();
+  gonk::bind::void_function<bool, &do_not_optimize_bool>(ns, "do_not_optimize").create();
+  gonk::bind::void_function<int, &do_not_optimize_int>(ns, "do_not_optimize").create();
+  gonk::bind::void_function<double, &do_not_optimize_double>(ns, "do_not_optimize").create();
+  gonk::bind::void_function<const std::string&, &do_not_optimize_string>(ns, "do_not_optimize").create();
+}
+
+class StdBenchPlugin : public gonk::Plugin
+{
+public:
+
+  void load(script::Module m) override
+  {
+    gonk::std_bench::g_epoch = gonk::std_bench::clock::now();
+
+    script::Namespace ns = m.root().getNamespace("std").getNamespace("bench");
+    register_bench_functions(ns);
+  }
+
+  void unload(script::Module m) override
+  {
+
+  }
+};
+
+gonk::Plugin* gonk_std_bench_module()
+{
+  return new StdBenchPlugin();
+}
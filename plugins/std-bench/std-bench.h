@@ -0,0 +1,19 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_STD_BENCH_H
+#define GONK_STD_BENCH_H
+
+#include "std-bench-defs.h"
+
+#include "gonk/plugin.h"
+
+extern "C"
+{
+
+  GONK_STD_BENCH_API gonk::Plugin* gonk_std_bench_module();
+
+} // extern "C"
+
+#endif // GONK_STD_BENCH_H
@@ -4,6 +4,8 @@
 
 #include "map.h"
 
+#include "gonk/memstats.h"
+
 #include <script/classtemplateinstancebuilder.h>
 #include <script/namelookup.h>
 #include <script/namespace.h>
@@ -17,6 +19,22 @@ namespace gonk
 namespace std_map
 {
 
+static memstats::ContainerTrackerT<Map> map_tracker{ "std::map" };
+
+static size_t estimate_map_size(const script::Value& val)
+{
+  // a red-black tree node has three pointers and a color besides the key and element
+  constexpr size_t node_size = sizeof(Map::value_type) + 4 * sizeof(void*);
+
+  const Map& self = script::get<Map>(val);
+  size_t result = sizeof(self) + self.size() * node_size;
+
+  for (const auto& p : self)
+    result += memstats::estimate_size(p.first.value) + memstats::estimate_size(p.second.value);
+
+  return result;
+}
+
 namespace callbacks
 {
 
@@ -24,6 +42,7 @@ namespace callbacks
 static script::Value default_ctor(script::FunctionCall* c)
 {
   c->thisObject() = script::Value(new script::CppValue<Map>(c->engine(), c->callee().parameter(0).baseType(), Map()));
+  map_tracker.add(&script::get<Map>(c->thisObject()));
   return c->thisObject();
 }
 
@@ -31,13 +50,21 @@ static script::Value default_ctor(script::FunctionCall* c)
 static script::Value copy_ctor(script::FunctionCall* c)
 {
   const Map& other = script::get<Map>(c->arg(1));
-  c->thisObject() = script::Value(new script::CppValue<Map>(c->engine(), c->callee().parameter(0).baseType(), other));
+
+  {
+    memstats::CopyScope scope;
+    c->thisObject() = script::Value(new script::CppValue<Map>(c->engine(), c->callee().parameter(0).baseType(), other));
+  }
+
+  memstats::count(memstats::Copy, c->thisObject());
+  map_tracker.add(&script::get<Map>(c->thisObject()));
   return c->thisObject();
 }
 
 // ~std::map()
 static script::Value dtor(script::FunctionCall* c)
 {
+  map_tracker.remove(&script::get<Map>(c->thisObject()));
   c->thisObject().destroy<Map>();
   return script::Value::Void;
 }
@@ -245,7 +272,10 @@ Key::Key(const Key& other)
   : type(other.type)
 {
   if (type)
+  {
     value = engine()->copy(other.value);
+    memstats::count(memstats::Copy, value);
+  }
 }
 
 Key::Key(Key&& other)
@@ -259,7 +289,10 @@ Key::Key(Key&& other)
 Key::~Key()
 {
   if (type)
+  {
+    memstats::count(memstats::Destroy, type->type);
     engine()->destroy(value);
+  }
 }
 
 Key& Key::operator=(const Key& other)
@@ -274,7 +307,10 @@ Key& Key::operator=(const Key& other)
     type = other.type;
 
     if (type)
+    {
       value = engine()->copy(other.value);
+      memstats::count(memstats::Copy, value);
+    }
   }
 
   return *this;
@@ -363,7 +399,10 @@ Element::Element(const Element& other)
   : type(other.type)
 {
   if (type)
+  {
     value = engine()->copy(other.value);
+    memstats::count(memstats::Copy, value);
+  }
 }
 
 Element::Element(Element&& other)
@@ -377,7 +416,10 @@ Element::Element(Element&& other)
 Element::~Element()
 {
   if (type)
+  {
+    memstats::count(memstats::Destroy, type->type);
     engine()->destroy(value);
+  }
 }
 
 
@@ -385,13 +427,14 @@ Element::Element(std::shared_ptr<ElementType> t)
   : type(t)
 {
   value = t->engine->construct(t->type, std::vector<script::Value>());
+  memstats::count(memstats::Construct, t->type);
 }
 
 Element::Element(std::shared_ptr<ElementType> t, script::Value&& v)
   : type(t),
     value(v)
 {
-
+  memstats::count(memstats::Construct, t->type);
 }
 
 Element& Element::operator=(const Element& other)
@@ -406,7 +449,10 @@ Element& Element::operator=(const Element& other)
     type = other.type;
 
     if (type)
+    {
       value = engine()->copy(other.value);
+      memstats::count(memstats::Copy, value);
+    }
   }
 
   return *this;
@@ -449,6 +495,8 @@ script::Class MapTemplate::instantiate(script::ClassTemplateInstanceBuilder& bui
 
   gonk::std_map::fill_instance(map, key_type, element_type);
 
+  memstats::setSizeEstimator(map.id(), std_map::estimate_map_size);
+
   return map;
 }
 
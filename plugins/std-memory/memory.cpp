@@ -0,0 +1,326 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "memory.h"
+
+#include <script/class.h>
+#include <script/classtemplateinstancebuilder.h>
+#include <script/namespace.h>
+#include <script/operator.h>
+#include <script/symbol.h>
+#include <script/templatebuilder.h>
+
+#include <utility>
+#include <vector>
+
+namespace gonk
+{
+
+namespace std_memory
+{
+
+OwnedValue::OwnedValue(script::Value val)
+  : value(val)
+{
+
+}
+
+OwnedValue::~OwnedValue()
+{
+  if (value.type().isObjectType())
+    value.engine()->destroy(value);
+}
+
+namespace callbacks
+{
+
+static script::Value make_handle(script::Engine* e, const script::Type& t, OwnedValuePtr ptr)
+{
+  return script::Value(new script::CppValue<OwnedValuePtr>(e, t, std::move(ptr)));
+}
+
+static script::Value construct(script::FunctionCall* c, OwnedValuePtr ptr)
+{
+  c->thisObject() = make_handle(c->engine(), c->callee().parameter(0).baseType(), std::move(ptr));
+  return c->thisObject();
+}
+
+// shared_ptr<T>();
+static script::Value default_ctor(script::FunctionCall* c)
+{
+  return construct(c, nullptr);
+}
+
+// shared_ptr<T>(const shared_ptr<T>& other);
+static script::Value copy_ctor(script::FunctionCall* c)
+{
+  return construct(c, script::get<OwnedValuePtr>(c->arg(1)));
+}
+
+// shared_ptr<T>(const T& value);
+static script::Value ctor_value(script::FunctionCall* c)
+{
+  return construct(c, std::make_shared<OwnedValue>(c->engine()->copy(c->arg(1))));
+}
+
+// ~shared_ptr<T>();
+static script::Value dtor(script::FunctionCall* c)
+{
+  c->thisObject().destroy<OwnedValuePtr>();
+  return script::Value::Void;
+}
+
+// static shared_ptr<T> make(Args... args);
+static script::Value make(script::FunctionCall* c)
+{
+  std::vector<script::Value> args;
+
+  for (int i(0); i < c->callee().prototype().count(); ++i)
+    args.push_back(c->arg(i));
+
+  script::Value val = c->engine()->construct(MemoryTemplate::info(c).value_type, args);
+  return make_handle(c->engine(), c->callee().returnType().baseType(), std::make_shared<OwnedValue>(val));
+}
+
+// shared_ptr<T>& operator=(const shared_ptr<T>& other);
+static script::Value op_assign(script::FunctionCall* c)
+{
+  script::get<OwnedValuePtr>(c->arg(0)) = script::get<OwnedValuePtr>(c->arg(1));
+  return c->arg(0);
+}
+
+// T& get() const;
+static script::Value get(script::FunctionCall* c)
+{
+  const OwnedValuePtr& self = script::get<OwnedValuePtr>(c->arg(0));
+
+  if (!self)
+    throw script::RuntimeError{ "bad pointer access" };
+
+  return self->value;
+}
+
+// bool isNull() const;
+static script::Value is_null(script::FunctionCall* c)
+{
+  return c->engine()->newBool(script::get<OwnedValuePtr>(c->arg(0)) == nullptr);
+}
+
+// void reset();
+static script::Value reset(script::FunctionCall* c)
+{
+  script::get<OwnedValuePtr>(c->arg(0)).reset();
+  return script::Value::Void;
+}
+
+// int use_count() const;
+static script::Value use_count(script::FunctionCall* c)
+{
+  return c->engine()->newInt(static_cast<int>(script::get<OwnedValuePtr>(c->arg(0)).use_count()));
+}
+
+// void swap(unique_ptr<T>& other);
+static script::Value swap(script::FunctionCall* c)
+{
+  std::swap(script::get<OwnedValuePtr>(c->arg(0)), script::get<OwnedValuePtr>(c->arg(1)));
+  return script::Value::Void;
+}
+
+// void take(unique_ptr<T>& other);
+static script::Value take(script::FunctionCall* c)
+{
+  OwnedValuePtr& self = script::get<OwnedValuePtr>(c->arg(0));
+  OwnedValuePtr& other = script::get<OwnedValuePtr>(c->arg(1));
+
+  if (&self != &other)
+  {
+    self = std::move(other);
+    other.reset();
+  }
+
+  return script::Value::Void;
+}
+
+// bool operator==(const shared_ptr<T>& other) const;
+static script::Value eq(script::FunctionCall* c)
+{
+  return c->engine()->newBool(script::get<OwnedValuePtr>(c->arg(0)) == script::get<OwnedValuePtr>(c->arg(1)));
+}
+
+// bool operator!=(const shared_ptr<T>& other) const;
+static script::Value neq(script::FunctionCall* c)
+{
+  return c->engine()->newBool(script::get<OwnedValuePtr>(c->arg(0)) != script::get<OwnedValuePtr>(c->arg(1)));
+}
+
+// bool operator<(const shared_ptr<T>& other) const;
+static script::Value less(script::FunctionCall* c)
+{
+  return c->engine()->newBool(std::owner_less<OwnedValuePtr>()(script::get<OwnedValuePtr>(c->arg(0)), script::get<OwnedValuePtr>(c->arg(1))));
+}
+
+} // namespace callbacks
+
+// a static 'make' function is created for each constructor of T,
+// the value is constructed in place
+static void fill_make_functions(script::Class& c, script::Type t)
+{
+  if (!t.isObjectType())
+  {
+    // static shared_ptr<T> make();
+    script::FunctionBuilder::Fun(c, "make").setCallback(callbacks::make)
+      .setStatic()
+      .returns(c.id())
+      .create();
+    // static shared_ptr<T> make(const T& value);
+    script::FunctionBuilder::Fun(c, "make").setCallback(callbacks::make)
+      .setStatic()
+      .returns(c.id())
+      .params(script::Type::cref(t))
+      .create();
+
+    return;
+  }
+
+  script::Class value_class = c.engine()->typeSystem()->getClass(t);
+
+  for (const script::Function& ctor : value_class.constructors())
+  {
+    if (ctor.isDeleted())
+      continue;
+
+    script::FunctionBuilder builder = script::FunctionBuilder::Fun(c, "make").setCallback(callbacks::make)
+      .setStatic()
+      .returns(c.id());
+
+    // the first parameter is the object being constructed
+    for (int i(1); i < ctor.prototype().count(); ++i)
+      builder.addParam(ctor.parameter(i));
+
+    builder.create();
+  }
+}
+
+static void fill_instance(script::Class& c, script::Type t, bool shared)
+{
+  // shared_ptr<T>();
+  script::FunctionBuilder::Constructor(c).setCallback(callbacks::default_ctor).create();
+  // shared_ptr<T>(const T& value);
+  script::FunctionBuilder::Constructor(c).setCallback(callbacks::ctor_value)
+    .params(script::Type::cref(t)).create();
+  // ~shared_ptr<T>();
+  script::FunctionBuilder::Destructor(c).setCallback(callbacks::dtor).create();
+
+  fill_make_functions(c, t);
+
+  // T& get() const;
+  script::FunctionBuilder::Fun(c, "get").setCallback(callbacks::get)
+    .returns(script::Type::ref(t))
+    .setConst()
+    .create();
+  // operator T&() const;
+  script::FunctionBuilder::Cast(c).setCallback(callbacks::get)
+    .returns(script::Type::ref(t))
+    .setConst()
+    .create();
+
+  // bool isNull() const;
+  script::FunctionBuilder::Fun(c, "isNull").setCallback(callbacks::is_null)
+    .returns(script::Type::Boolean)
+    .setConst()
+    .create();
+  // void reset();
+  script::FunctionBuilder::Fun(c, "reset").setCallback(callbacks::reset)
+    .create();
+
+  // bool operator==(const shared_ptr<T>& other) const;
+  script::FunctionBuilder::Op(c, script::EqualOperator).setCallback(callbacks::eq)
+    .returns(script::Type::Boolean)
+    .params(script::Type::cref(c.id()))
+    .setConst()
+    .create();
+  // bool operator!=(const shared_ptr<T>& other) const;
+  script::FunctionBuilder::Op(c, script::InequalOperator).setCallback(callbacks::neq)
+    .returns(script::Type::Boolean)
+    .params(script::Type::cref(c.id()))
+    .setConst()
+    .create();
+
+  if (shared)
+  {
+    // bool operator<(const shared_ptr<T>& other) const, so that handles can be stored in containers
+    script::FunctionBuilder::Op(c, script::LessOperator).setCallback(callbacks::less)
+      .returns(script::Type::Boolean)
+      .params(script::Type::cref(c.id()))
+      .setConst()
+      .create();
+    // shared_ptr<T>(const shared_ptr<T>& other);
+    script::FunctionBuilder::Constructor(c).setCallback(callbacks::copy_ctor)
+      .params(script::Type::cref(c.id())).create();
+    // shared_ptr<T>& operator=(const shared_ptr<T>& other);
+    script::FunctionBuilder::Op(c, script::AssignmentOperator).setCallback(callbacks::op_assign)
+      .returns(script::Type::ref(c.id()))
+      .params(script::Type::cref(c.id()))
+      .create();
+    // int use_count() const;
+    script::FunctionBuilder::Fun(c, "use_count").setCallback(callbacks::use_count)
+      .returns(script::Type::Int)
+      .setConst()
+      .create();
+  }
+  else
+  {
+    // unique_ptr<T> can neither be copied nor assigned, ownership is
+    // transferred explicitly
+
+    // void swap(unique_ptr<T>& other);
+    script::FunctionBuilder::Fun(c, "swap").setCallback(callbacks::swap)
+      .params(script::Type::ref(c.id()))
+      .create();
+    // void take(unique_ptr<T>& other);
+    script::FunctionBuilder::Fun(c, "take").setCallback(callbacks::take)
+      .params(script::Type::ref(c.id()))
+      .create();
+  }
+}
+
+} // namespace std_memory
+
+MemoryTemplate::InstanceInfo& MemoryTemplate::info(script::FunctionCall* c)
+{
+  return static_cast<InstanceInfo&>(*c->callee().memberOf().data());
+}
+
+script::Class MemoryTemplate::instantiate(script::ClassTemplateInstanceBuilder& builder)
+{
+  builder.setFinal();
+  const script::Type value_type = builder.arguments().front().type.baseType();
+
+  auto instance_info = std::make_shared<InstanceInfo>();
+  instance_info->value_type = value_type;
+  builder.setData(instance_info);
+
+  script::Class handle = builder.get();
+
+  std_memory::fill_instance(handle, value_type, isShared());
+
+  return handle;
+}
+
+} // namespace gonk
+
+void register_memory_file(script::Namespace ns)
+{
+  script::ClassTemplateBuilder(script::Symbol(ns), "shared_ptr")
+    .params(script::TemplateParameter(script::TemplateParameter::TypeParameter{}, "T"))
+    .setScope(script::Scope(ns))
+    .withBackend<gonk::SharedPtrTemplate>()
+    .get();
+
+  script::ClassTemplateBuilder(script::Symbol(ns), "unique_ptr")
+    .params(script::TemplateParameter(script::TemplateParameter::TypeParameter{}, "T"))
+    .setScope(script::Scope(ns))
+    .withBackend<gonk::UniquePtrTemplate>()
+    .get();
+}
@@ -0,0 +1,83 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_STD_MEMORY_MEMORY_H
+#define GONK_STD_MEMORY_MEMORY_H
+
+#include "std-memory-defs.h"
+
+#include <script/interpreter/executioncontext.h>
+
+#include <script/classtemplate.h>
+#include <script/classtemplatenativebackend.h>
+#include <script/engine.h>
+#include <script/functionbuilder.h>
+#include <script/typesystem.h>
+#include <script/userdata.h>
+
+#include <memory>
+
+namespace gonk
+{
+
+namespace std_memory
+{
+
+/*!
+ * \class OwnedValue
+ * \brief value allocated by a std::shared_ptr or a std::unique_ptr
+ *
+ * The value is destroyed with its last owner.
+ */
+class GONK_STD_MEMORY_API OwnedValue
+{
+public:
+  script::Value value;
+
+public:
+  explicit OwnedValue(script::Value val);
+  OwnedValue(const OwnedValue&) = delete;
+  ~OwnedValue();
+
+  OwnedValue& operator=(const OwnedValue&) = delete;
+};
+
+// storage of both std::shared_ptr<T> and std::unique_ptr<T>, the latter has
+// no copy constructor so its storage is never shared
+using OwnedValuePtr = std::shared_ptr<OwnedValue>;
+
+} // namespace std_memory
+
+class MemoryTemplate : public script::ClassTemplateNativeBackend
+{
+public:
+
+  struct InstanceInfo : public script::UserData
+  {
+    script::Type value_type;
+  };
+
+  static InstanceInfo& info(script::FunctionCall* c);
+
+  script::Class instantiate(script::ClassTemplateInstanceBuilder& builder) override;
+
+protected:
+  virtual bool isShared() const = 0;
+};
+
+class SharedPtrTemplate : public MemoryTemplate
+{
+protected:
+  bool isShared() const override { return true; }
+};
+
+class UniquePtrTemplate : public MemoryTemplate
+{
+protected:
+  bool isShared() const override { return false; }
+};
+
+} // namespace gonk
+
+#endif // GONK_STD_MEMORY_MEMORY_H
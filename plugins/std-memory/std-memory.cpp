@@ -0,0 +1,32 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "std-memory.h"
+
+#include <script/engine.h>
+#include <script/namespace.h>
+
+extern void register_memory_file(script::Namespace ns); // defined in memory.cpp
+
+class StdMemoryPlugin : public gonk::Plugin
+{
+public:
+
+  void load(script::Module m) override
+  {
+    script::Namespace ns = m.root().getNamespace("std");
+
+    register_memory_file(ns);
+  }
+
+  void unload(script::Module m) override
+  {
+
+  }
+};
+
+gonk::Plugin* gonk_std_memory_module()
+{
+  return new StdMemoryPlugin();
+}
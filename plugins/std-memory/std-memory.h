@@ -0,0 +1,19 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_STD_MEMORY_H
+#define GONK_STD_MEMORY_H
+
+#include "std-memory-defs.h"
+
+#include "gonk/plugin.h"
+
+extern "C"
+{
+
+  GONK_STD_MEMORY_API gonk::Plugin* gonk_std_memory_module();
+
+} // extern "C"
+
+#endif // GONK_STD_MEMORY_H
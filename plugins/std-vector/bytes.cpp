@@ -0,0 +1,118 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "bytes.h"
+
+#include "gonk/common/binding/class.h"
+#include "gonk/common/span.h"
+
+#include <script/classbuilder.h>
+#include <script/engine.h>
+#include <script/interpreter/executioncontext.h>
+
+#include <string>
+
+namespace gonk
+{
+
+namespace std_vector
+{
+
+namespace callbacks
+{
+
+// bytes(const String& str);
+static script::Value bytes_ctor_string(script::FunctionCall* c)
+{
+  const std::string& str = script::get<std::string>(c->arg(1));
+  c->thisObject().init<Bytes>(str.begin(), str.end());
+  return c->thisObject();
+}
+
+static int bytes_size(const Bytes& self)
+{
+  return static_cast<int>(self.size());
+}
+
+// scripts can catch a RuntimeError, not a std::out_of_range
+static size_t checked_index(const Bytes& self, int index)
+{
+  if (index < 0 || static_cast<size_t>(index) >= self.size())
+    throw script::RuntimeError{ "bytes: index " + std::to_string(index) + " out of range" };
+
+  return static_cast<size_t>(index);
+}
+
+static int bytes_at(const Bytes& self, int index)
+{
+  return self[checked_index(self, index)];
+}
+
+static void bytes_set(Bytes& self, int index, int value)
+{
+  self[checked_index(self, index)] = static_cast<unsigned char>(value);
+}
+
+static void bytes_push_back(Bytes& self, int value)
+{
+  self.push_back(static_cast<unsigned char>(value));
+}
+
+static void bytes_resize(Bytes& self, int size)
+{
+  self.resize(static_cast<size_t>(size));
+}
+
+static std::string bytes_to_string(const Bytes& self)
+{
+  return std::string(self.begin(), self.end());
+}
+
+} // namespace callbacks
+
+void register_bytes_class(script::Namespace ns)
+{
+  script::Type t = ns.engine()->registerType<Bytes>();
+  script::Class bytes = ns.newClass("bytes").setId(t.data()).setFinal().get();
+
+  // bytes();
+  gonk::bind::default_constructor<Bytes>(bytes).create();
+  // bytes(const bytes& other);
+  gonk::bind::copy_constructor<Bytes>(bytes).create();
+  // bytes(int size);
+  gonk::bind::constructor<Bytes, int>(bytes).create();
+  // bytes(const String& str);
+  gonk::bind::custom_constructor<Bytes, const std::string&>(bytes, callbacks::bytes_ctor_string).create();
+  // ~bytes();
+  gonk::bind::destructor<Bytes>(bytes).create();
+
+  // bytes& operator=(const bytes& other);
+  gonk::bind::memop_assign<Bytes, const Bytes&>(bytes);
+
+  // int size() const;
+  gonk::bind::fn_as_memfn<Bytes, int, &callbacks::bytes_size>(bytes, "size").create();
+  // bool empty() const;
+  gonk::bind::member_function<Bytes, bool, &Bytes::empty>(bytes, "empty").create();
+  // int at(int index) const;
+  gonk::bind::fn_as_memfn<Bytes, int, int, &callbacks::bytes_at>(bytes, "at").create();
+  // void set(int index, int value);
+  gonk::bind::void_fn_as_memfn<Bytes, int, int, &callbacks::bytes_set>(bytes, "set").create();
+  // void push_back(int value);
+  gonk::bind::void_fn_as_memfn<Bytes, int, &callbacks::bytes_push_back>(bytes, "push_back").create();
+  // void resize(int size);
+  gonk::bind::void_fn_as_memfn<Bytes, int, &callbacks::bytes_resize>(bytes, "resize").create();
+  // void clear();
+  gonk::bind::void_member_function<Bytes, &Bytes::clear>(bytes, "clear").create();
+  // String toString() const;
+  gonk::bind::fn_as_memfn<Bytes, std::string, &callbacks::bytes_to_string>(bytes, "toString").create();
+
+  // bool operator==(const bytes& lhs, const bytes& rhs);
+  gonk::bind::op_eq<const Bytes&, const Bytes&>(ns);
+  // bool operator!=(const bytes& lhs, const bytes& rhs);
+  gonk::bind::op_neq<const Bytes&, const Bytes&>(ns);
+}
+
+} // namespace std_vector
+
+} // namespace gonk
@@ -0,0 +1,25 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONK_STD_VECTOR_BYTES_H
+#define GONK_STD_VECTOR_BYTES_H
+
+#include "std-vector-defs.h"
+
+#include <script/namespace.h>
+
+namespace gonk
+{
+
+namespace std_vector
+{
+
+// registers 'std::bytes', a buffer whose storage is a gonk::Bytes
+void register_bytes_class(script::Namespace ns);
+
+} // namespace std_vector
+
+} // namespace gonk
+
+#endif // GONK_STD_VECTOR_BYTES_H
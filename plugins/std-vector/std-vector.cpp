@@ -4,6 +4,8 @@
 
 #include "std-vector.h"
 
+#include "bytes.h"
+
 #include <script/engine.h>
 #include <script/namespace.h>
 #include <script/typesystem.h>
@@ -46,6 +48,7 @@ public:
     script::Namespace ns = m.root().getNamespace("std");
 
     register_vector_file(ns);
+    gonk::std_vector::register_bytes_class(ns);
   }
 
   void unload(script::Module m) override
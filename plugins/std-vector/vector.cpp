@@ -4,6 +4,8 @@
 
 #include "vector.h"
 
+#include "gonk/memstats.h"
+
 #include <script/classtemplateinstancebuilder.h>
 #include <script/namespace.h>
 #include <script/symbol.h>
@@ -15,6 +17,45 @@ namespace gonk
 namespace std_vector
 {
 
+static memstats::ContainerTrackerT<std::vector<SemValue>> vector_tracker{ "std::vector" };
+
+namespace callbacks
+{
+
+template<>
+memstats::ContainerTrackerT<std::vector<int>>& tracker<int>()
+{
+  static memstats::ContainerTrackerT<std::vector<int>> t{ "std::vector<int>" };
+  return t;
+}
+
+template<>
+memstats::ContainerTrackerT<std::vector<double>>& tracker<double>()
+{
+  static memstats::ContainerTrackerT<std::vector<double>> t{ "std::vector<double>" };
+  return t;
+}
+
+template<>
+memstats::ContainerTrackerT<std::vector<std::string>>& tracker<std::string>()
+{
+  static memstats::ContainerTrackerT<std::vector<std::string>> t{ "std::vector<String>" };
+  return t;
+}
+
+} // namespace callbacks
+
+static size_t estimate_vector_size(const script::Value& val)
+{
+  const std::vector<SemValue>& self = script::get<std::vector<SemValue>>(val);
+  size_t result = sizeof(self) + self.capacity() * sizeof(SemValue);
+
+  for (const SemValue& elem : self)
+    result += memstats::estimate_size(elem.get());
+
+  return result;
+}
+
 namespace callbacks
 {
 
@@ -22,6 +63,7 @@ namespace callbacks
 static script::Value default_ctor(script::FunctionCall* c)
 {
   c->thisObject() = script::Value(new script::CppValue<std::vector<SemValue>>(c->engine(), c->callee().parameter(0).baseType(), std::vector<SemValue>()));
+  vector_tracker.add(&script::get<std::vector<SemValue>>(c->thisObject()));
   return c->thisObject();
 }
 
@@ -29,13 +71,21 @@ static script::Value default_ctor(script::FunctionCall* c)
 static script::Value copy_ctor(script::FunctionCall* c)
 {
   const std::vector<SemValue>& other = script::get<std::vector<SemValue>>(c->arg(1));
-  c->thisObject() = script::Value(new script::CppValue<std::vector<SemValue>>(c->engine(), c->callee().parameter(0).baseType(), other));
+
+  {
+    memstats::CopyScope scope;
+    c->thisObject() = script::Value(new script::CppValue<std::vector<SemValue>>(c->engine(), c->callee().parameter(0).baseType(), other));
+  }
+
+  memstats::count(memstats::Copy, c->thisObject());
+  vector_tracker.add(&script::get<std::vector<SemValue>>(c->thisObject()));
   return c->thisObject();
 }
 
 // ~std::vector()
 static script::Value dtor(script::FunctionCall* c)
 {
+  vector_tracker.remove(&script::get<std::vector<SemValue>>(c->thisObject()));
   c->thisObject().destroy<std::vector<SemValue>>();
   return script::Value::Void;
 }
@@ -46,6 +96,7 @@ static script::Value ctor_int(script::FunctionCall* c)
   const int count = script::get<int>(c->arg(1));
   SemValue value{ VectorTemplate::info(c).element_type->defaultConstruct() };
   c->thisObject() = script::Value(new script::CppValue<std::vector<SemValue>>(c->engine(), c->callee().parameter(0).baseType(), std::vector<SemValue>(static_cast<size_t>(count), value)));
+  vector_tracker.add(&script::get<std::vector<SemValue>>(c->thisObject()));
   return c->thisObject();
 }
 
@@ -55,6 +106,7 @@ static script::Value ctor_int_T(script::FunctionCall* c)
   const int size = script::get<int>(c->arg(1));
   ObserverValue value{ VectorTemplate::info(c).element_type, c->arg(2) };
   c->thisObject() = script::Value(new script::CppValue<std::vector<SemValue>>(c->engine(), c->callee().parameter(0).baseType(), std::vector<SemValue>(static_cast<size_t>(size), value)));
+  vector_tracker.add(&script::get<std::vector<SemValue>>(c->thisObject()));
   return c->thisObject();
 }
 
@@ -387,6 +439,8 @@ script::Class VectorTemplate::instantiate(script::ClassTemplateInstanceBuilder&
 
   gonk::std_vector::fill_instance(vector, element_type);
 
+  memstats::setSizeEstimator(vector.id(), std_vector::estimate_vector_size);
+
   return vector;
 }
 
@@ -404,6 +458,12 @@ void register_vector_file(script::Namespace ns)
     .withBackend<gonk::VectorTemplate>()
     .get();
     
+  // the trackers are listed in the reports even before a vector is created
+  gonk::std_vector::callbacks::tracker<int>();
+  gonk::std_vector::callbacks::tracker<double>();
+  gonk::std_vector::callbacks::tracker<std::string>();
+
   gonk::std_vector::register_specialization<int>(vector_template, e->registerType<std::vector<int>>());
+  gonk::std_vector::register_specialization<double>(vector_template, e->registerType<std::vector<double>>());
   gonk::std_vector::register_specialization<std::string>(vector_template, e->registerType<std::vector<std::string>>());
 }
@@ -7,6 +7,7 @@
 #include "gonk/common/binding/class.h"
 #include "gonk/common/semvalue.h"
 #include "gonk/common/types.h"
+#include "gonk/memstats.h"
 
 #include <script/interpreter/executioncontext.h>
 
@@ -122,22 +123,47 @@ void resize_int_T(std::vector<T>& self, int size, const T& value)
   self.resize(static_cast<size_t>(size), value);
 }
 
+// the native specializations have their own trackers, defined in vector.cpp
+template<typename T>
+memstats::ContainerTrackerT<std::vector<T>>& tracker();
+
+template<> memstats::ContainerTrackerT<std::vector<int>>& tracker<int>();
+template<> memstats::ContainerTrackerT<std::vector<double>>& tracker<double>();
+template<> memstats::ContainerTrackerT<std::vector<std::string>>& tracker<std::string>();
+
+template<typename T, script::NativeFunctionSignature F>
+script::Value tracked_ctor(script::FunctionCall* c)
+{
+  script::Value result = F(c);
+  tracker<T>().add(&script::get<std::vector<T>>(c->thisObject()));
+  return result;
+}
+
+template<typename T>
+script::Value tracked_dtor(script::FunctionCall* c)
+{
+  tracker<T>().remove(&script::get<std::vector<T>>(c->thisObject()));
+  return gonk::bind::destructor_binder<std::vector<T>>::destructor(c);
+}
+
 } // namespace callbacks
 
 template<typename T>
 void fill_instance(script::Class& c)
 {
+  using binder = gonk::bind::constructor_binder<std::vector<T>>;
+
   // std::vector();
-  gonk::bind::default_constructor<std::vector<T>>(c).create();
+  gonk::bind::custom_constructor<std::vector<T>>(c, callbacks::tracked_ctor<T, binder::default_ctor>).create();
   // std::vector(const std::vector<T>& other);
-  gonk::bind::copy_constructor<std::vector<T>>(c).create();
+  gonk::bind::custom_constructor<std::vector<T>, const std::vector<T>&>(c, callbacks::tracked_ctor<T, binder::copy_ctor>).create();
   // ~std::vector();
-  gonk::bind::destructor<std::vector<T>>(c).create();
+  script::FunctionBuilder::Destructor(c).setCallback(callbacks::tracked_dtor<T>).create();
 
   // std::vector(int count);
-  gonk::bind::constructor<std::vector<T>, int>(c).create();
+  gonk::bind::custom_constructor<std::vector<T>, int>(c, callbacks::tracked_ctor<T, binder::template generic_ctor<int>>).create();
   // std::vector(int size, const T& value);
-  gonk::bind::constructor<std::vector<T>, int, const T&>(c).create();
+  gonk::bind::custom_constructor<std::vector<T>, int, const T&>(c, callbacks::tracked_ctor<T, binder::template generic_ctor<int, const T&>>).create();
 
   // std::vector<T>& operator=(const std::vector<T>& other);
   gonk::bind::memop_assign<std::vector<T>, const std::vector<T>&>(c);
@@ -5,7 +5,11 @@
 #include "gonk/cli.h"
 
 #include "gonk/cli-parser.h"
+#include "gonk/sampling-profiler.h"
 
+#include <algorithm>
+
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
@@ -63,6 +67,79 @@ public:
       {
         cli.debugbuild = true;
       }
+      else if (arg == "--debug-attach")
+      {
+        cli.debug_attach = true;
+      }
+      else if (arg == "--debug-port")
+      {
+        const std::string port = readValue(arg);
+
+        if (port.empty() || port.size() > 5 || !std::all_of(port.begin(), port.end(), [](char c) { return c >= '0' && c <= '9'; })
+          || std::stoi(port) < 1 || std::stoi(port) > 65535)
+        {
+          throw std::runtime_error("Invalid port for --debug-port: " + port + " (expected a number between 1 and 65535)");
+        }
+
+        cli.debug_port = std::stoi(port);
+      }
+      else if (arg == "--debug-socket")
+      {
+        cli.debug_socket = readValue(arg);
+      }
+      else if (arg == "--profile")
+      {
+        cli.profile = "gonk-profile";
+      }
+      else if (arg.rfind("--profile=", 0) == 0)
+      {
+        cli.profile = arg.substr(std::strlen("--profile="));
+      }
+      else if (arg == "--sample-profile")
+      {
+        cli.sample_profile = 1000;
+      }
+      else if (arg.rfind("--sample-profile=", 0) == 0)
+      {
+        const std::string hz = arg.substr(std::strlen("--sample-profile="));
+
+        if (hz.empty() || hz.size() > 9 || !std::all_of(hz.begin(), hz.end(), [](char c) { return c >= '0' && c <= '9'; }))
+          throw std::runtime_error("Invalid frequency for --sample-profile: " + hz);
+
+        cli.sample_profile = std::min(std::max(1, std::stoi(hz)), SamplingProfiler::MaxFrequency);
+      }
+      else if (arg == "--sample-profile-output")
+      {
+        cli.sample_profile_output = readValue(arg);
+      }
+      else if (arg == "--coverage")
+      {
+        cli.coverage = readValue(arg);
+      }
+      else if (arg == "--coverage-counts")
+      {
+        cli.coverage_counts = true;
+      }
+      else if (arg == "--memstats")
+      {
+        cli.memstats = true;
+      }
+      else if (arg == "--copy-audit")
+      {
+        cli.copy_audit = true;
+      }
+      else if (arg == "--bench")
+      {
+        cli.bench = true;
+      }
+      else if (arg == "--bench-filter")
+      {
+        cli.bench_filter = readValue(arg);
+      }
+      else if (arg == "--trace")
+      {
+        cli.trace = readValue(arg);
+      }
       else
       {
         if (isOption(arg))
@@ -78,6 +155,14 @@ public:
   }
 
 protected:
+  std::string readValue(const std::string& option)
+  {
+    if (atEnd())
+      throw std::runtime_error("Missing value for option " + option);
+
+    return read();
+  }
+
   void parseExtras()
   {
     while(!atEnd())
@@ -114,6 +199,26 @@ void CLI::displayHelp()
   std::cout << "  gonk --interactive" << std::endl;
   std::cout << "Execute program:" << std::endl;
   std::cout << "  gonk [--debug] file [options]" << std::endl;
+  std::cout << "Debugger options:" << std::endl;
+  std::cout << "  --debug-port <port>    listen on the given TCP port (default: 24242, env: GONK_DEBUG_PORT)" << std::endl;
+  std::cout << "  --debug-socket <path>  listen on a Unix domain socket (env: GONK_DEBUG_SOCKET)" << std::endl;
+  std::cout << "  --debug-attach         do not wait for a client, run until one attaches (env: GONK_DEBUG_ATTACH=1)" << std::endl;
+  std::cout << "Profiling options:" << std::endl;
+  std::cout << "  --profile[=<prefix>]   write <prefix>.txt and <prefix>.folded (default prefix: gonk-profile)" << std::endl;
+  std::cout << "  --sample-profile[=hz]  sample the callstack hz times per second (default: 1000, at most 100000)," << std::endl;
+  std::cout << "                         write <prefix>.txt and <prefix>.folded" << std::endl;
+  std::cout << "  --sample-profile-output <prefix>" << std::endl;
+  std::cout << "                         prefix of the sampling profiler output (default: gonk-sample-profile)" << std::endl;
+  std::cout << "  --trace <file.json>    write a Chrome trace-event timeline of the execution" << std::endl;
+  std::cout << "Coverage options:" << std::endl;
+  std::cout << "  --coverage <out.info>  write the executed lines as an lcov tracefile" << std::endl;
+  std::cout << "  --coverage-counts      count every execution of a line instead of only the first" << std::endl;
+  std::cout << "Memory options:" << std::endl;
+  std::cout << "  --memstats             print value and container allocation statistics at exit" << std::endl;
+  std::cout << "  --copy-audit           print the script lines and native functions making the most deep copies" << std::endl;
+  std::cout << "Benchmark options:" << std::endl;
+  std::cout << "  --bench                run the functions annotated [[bench]] instead of main()" << std::endl;
+  std::cout << "  --bench-filter <text>  only run the benchmarks whose name contains text" << std::endl;
   std::cout << "Print version:" << std::endl;
   std::cout << "  gonk -v" << std::endl;
   std::cout << "  gonk --version" << std::endl;
@@ -4,6 +4,8 @@
 
 #include "gonk/common/semvalue.h"
 
+#include "gonk/memstats.h"
+
 #include <script/class.h>
 #include <script/engine.h>
 #include <script/initialization.h>
@@ -53,22 +55,23 @@ static bool check_op_less(const script::Type & t, const script::Function & op)
   return true;
 }
 
-static void get_hash(TypeInfo & info)
+
+script::Function TypeInfo::get_hash(script::Engine* e, const script::Type& t)
 {
-  script::Engine *e = info.engine;
+  const script::Type type = t.baseType();
 
-  script::Scope scp{ script::Scope::enclosingNamespace(info.type, e) };
+  script::Scope scp{ script::Scope::enclosingNamespace(type, e) };
   std::vector<script::Function> funcs = script::NameLookup::resolve("hash", scp).functions();
-  auto resol = script::resolve_overloads(funcs, std::vector<script::Type>{script::Type::cref(info.type)});
+  auto resol = script::resolve_overloads(funcs, std::vector<script::Type>{script::Type::cref(type)});
   if (!resol)
-    return;
+    return script::Function();
 
   if (resol.function.returnType() != script::Type::Int)
-    return;
-  else if (resol.function.parameter(0) != script::Type::cref(info.type))
-    return;
+    return script::Function();
+  else if (resol.function.parameter(0) != script::Type::cref(type))
+    return script::Function();
 
-  info.hash = resol.function;
+  return resol.function;
 }
 
 script::Function TypeInfo::get_eq(script::Engine* e, const script::Type& t)
@@ -135,7 +138,7 @@ std::shared_ptr<TypeInfo> TypeInfo::get(script::Engine *e, const script::Type &
     ret->assign = get_assign(e, t);
     ret->less = get_less(e, t);
 
-    get_hash(*ret);
+    ret->hash = get_hash(e, t);
   }
   else
   {
@@ -162,7 +165,10 @@ SemValue::SemValue(const SemValue& other)
   : typeinfo_(other.typeinfo_)
 {
   if (other.isValid())
+  {
     value_ = engine()->copy(other.value_);
+    memstats::count(memstats::Copy, value_);
+  }
 }
 
 SemValue::SemValue(SemValue&& other)
@@ -177,31 +183,37 @@ SemValue::SemValue(const std::shared_ptr<TypeInfo> & ti, const script::Value & v
   : typeinfo_(ti)
 {
   value_ = engine()->copy(val);
+  memstats::count(memstats::Copy, value_);
 }
 
 SemValue::SemValue(const std::shared_ptr<TypeInfo> & ti, script::Value && val)
   : typeinfo_(ti)
   , value_(val)
 {
-
+  memstats::count(memstats::Construct, value_);
 }
 
 SemValue::SemValue(const script::Value & val)
 {
   typeinfo_ = TypeInfo::get(val.engine(), val.type());
   value_ = engine()->copy(val);
+  memstats::count(memstats::Copy, value_);
 }
 
 SemValue::SemValue(script::Value && val)
   : value_(val)
 {
   typeinfo_ = TypeInfo::get(val.engine(), val.type());
+  memstats::count(memstats::Construct, value_);
 }
 
 SemValue::~SemValue()
 {
   if (isValid())
+  {
+    memstats::count(memstats::Destroy, value_);
     engine()->destroy(value_);
+  }
   value_ = script::Value{};
 }
 
@@ -235,11 +247,17 @@ SemValue& SemValue::operator=(const SemValue& other)
     return *(this);
 
   if (isValid())
+  {
+    memstats::count(memstats::Destroy, value_);
     engine()->destroy(value_);
+  }
 
   typeinfo_ = other.typeinfo_;
   if(isValid())
+  {
     value_ = engine()->copy(other.value_);
+    memstats::count(memstats::Copy, value_);
+  }
 
   return *(this);
 }
@@ -0,0 +1,175 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/copy-audit.h"
+
+#include <script/engine.h>
+#include <script/interpreter/executioncontext.h>
+#include <script/program/statements.h>
+#include <script/script.h>
+#include <script/typesystem.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+namespace gonk
+{
+
+CopyAudit::CopyAudit()
+{
+
+}
+
+CopyAudit::~CopyAudit()
+{
+  stop();
+}
+
+void CopyAudit::start()
+{
+  m_was_enabled = memstats::enabled;
+  memstats::setEnabled(true);
+  memstats::copy_observer = this;
+}
+
+void CopyAudit::stop()
+{
+  if (memstats::copy_observer != this)
+    return;
+
+  memstats::copy_observer = nullptr;
+  memstats::setEnabled(m_was_enabled);
+}
+
+void CopyAudit::interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& /* info */)
+{
+  // the callstack is walked when a copy happens, nothing else is needed here
+  m_context = call.executionContext();
+}
+
+void CopyAudit::copied(const script::Value& copy)
+{
+  const script::Type t = copy.type().baseType();
+
+  // copying a fundamental value is cheap and never hidden
+  if (t != script::Type::String && (t.isFundamentalType() || t.isEnumType()))
+    return;
+
+  Site site;
+  site.type = t.data();
+
+  if (m_context)
+  {
+    script::interpreter::Callstack& cs = m_context->callstack;
+
+    for (size_t i(cs.size()); i-- > 0; )
+    {
+      const script::Function& f = cs[i]->callee();
+
+      if (f.isNative())
+      {
+        if (!site.native)
+          site.native = key(f);
+
+        continue;
+      }
+
+      site.function = key(f);
+      site.line = cs[i]->last_breakpoint ? cs[i]->last_breakpoint->line : -1;
+      break;
+    }
+  }
+
+  SiteStats& stats = m_sites[site];
+  stats.count += 1;
+  stats.bytes += memstats::estimate_size(copy);
+}
+
+const std::map<CopyAudit::Site, CopyAudit::SiteStats>& CopyAudit::sites() const
+{
+  return m_sites;
+}
+
+const void* CopyAudit::key(const script::Function& f)
+{
+  const void* k = f.impl().get();
+
+  if (m_functions.find(k) == m_functions.end())
+    m_functions[k] = f;
+
+  return k;
+}
+
+std::string CopyAudit::location(const Site& site) const
+{
+  auto it = m_functions.find(site.function);
+
+  if (it == m_functions.end())
+    return "<unknown>";
+
+  const script::Function& f = it->second;
+  std::string result = f.engine()->toString(f);
+
+  if (!f.script().isNull())
+    result += " at " + f.script().path() + ":" + std::to_string(site.line + 1);
+
+  return result;
+}
+
+void CopyAudit::writeReport(std::ostream& out, script::Engine& e, size_t limit) const
+{
+  std::vector<std::pair<Site, SiteStats>> entries{ m_sites.begin(), m_sites.end() };
+
+  size_t total_count = 0;
+  size_t total_bytes = 0;
+
+  for (const auto& p : entries)
+  {
+    total_count += p.second.count;
+    total_bytes += p.second.bytes;
+  }
+
+  auto print = [&](const char* title) {
+    out << std::setw(10) << "count" << std::setw(14) << "bytes" << "  " << title << std::endl;
+
+    for (size_t i(0); i < std::min(limit, entries.size()); ++i)
+    {
+      const Site& site = entries.at(i).first;
+      const SiteStats& stats = entries.at(i).second;
+
+      out << std::setw(10) << stats.count << std::setw(14) << stats.bytes << "  " << location(site) << std::endl;
+      out << std::setw(26) << "" << "  copy of " << e.typeSystem()->typeName(script::Type(site.type));
+
+      auto it = m_functions.find(site.native);
+
+      if (it != m_functions.end())
+        out << " in " << e.toString(it->second);
+
+      out << std::endl;
+    }
+  };
+
+  out << "copy audit: " << total_count << " deep copies, " << total_bytes << " bytes" << std::endl;
+
+  if (entries.empty())
+    return;
+
+  std::sort(entries.begin(), entries.end(), [](const std::pair<Site, SiteStats>& a, const std::pair<Site, SiteStats>& b) {
+    return a.second.bytes > b.second.bytes;
+    });
+
+  out << std::endl;
+  print("top sites by bytes");
+
+  std::sort(entries.begin(), entries.end(), [](const std::pair<Site, SiteStats>& a, const std::pair<Site, SiteStats>& b) {
+    return a.second.count > b.second.count;
+    });
+
+  out << std::endl;
+  print("top sites by count");
+}
+
+} // namespace gonk
@@ -0,0 +1,205 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/coverage.h"
+
+#include <script/interpreter/executioncontext.h>
+#include <script/program/statements.h>
+#include <script/sourcefile.h>
+
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#include <set>
+
+namespace gonk
+{
+
+static Coverage* g_active_coverage = nullptr;
+
+static int count_lines(const std::string& content)
+{
+  return static_cast<int>(std::count(content.begin(), content.end(), '\n')) + 1;
+}
+
+bool Coverage::ScriptCoverage::isExecuted(int line) const
+{
+  if (line < 0 || static_cast<size_t>(line / 64) >= executed.size())
+    return false;
+
+  return (executed[line / 64] >> (line % 64)) & 1;
+}
+
+Coverage::Coverage(bool count_hits)
+  : m_count_hits(count_hits)
+{
+
+}
+
+Coverage::~Coverage()
+{
+  if (g_active_coverage == this)
+    g_active_coverage = nullptr;
+}
+
+Coverage* Coverage::active()
+{
+  return g_active_coverage;
+}
+
+void Coverage::start()
+{
+  g_active_coverage = this;
+}
+
+void Coverage::stop()
+{
+  if (g_active_coverage == this)
+    g_active_coverage = nullptr;
+}
+
+bool Coverage::countsHits() const
+{
+  return m_count_hits;
+}
+
+void Coverage::addScript(const script::Script& s)
+{
+  getScript(s);
+}
+
+void Coverage::interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info)
+{
+  // consecutive breakpoints are usually in the same function
+  const void* f = call.callee().impl().get();
+  ScriptCoverage* sc = (f == m_last_function) ? m_last_script : findScript(call);
+
+  m_last_function = f;
+  m_last_script = sc;
+
+  const int line = info.line;
+
+  if (!sc || line < 0)
+    return;
+
+  const size_t word = static_cast<size_t>(line) / 64;
+
+  if (word >= sc->executed.size())
+    sc->executed.resize(word + 1, 0);
+
+  sc->executed[word] |= (uint64_t(1) << (line % 64));
+
+  if (m_count_hits)
+  {
+    if (static_cast<size_t>(line) >= sc->hits.size())
+      sc->hits.resize(line + 1, 0);
+
+    sc->hits[line] += 1;
+  }
+}
+
+const std::map<std::string, std::unique_ptr<Coverage::ScriptCoverage>>& Coverage::scripts() const
+{
+  return m_scripts;
+}
+
+Coverage::ScriptCoverage* Coverage::getScript(const script::Script& s)
+{
+  if (s.isNull() || s.path().empty())
+    return nullptr;
+
+  auto it = m_scripts.find(s.path());
+
+  if (it != m_scripts.end())
+    return it->second.get();
+
+  auto sc = std::make_unique<ScriptCoverage>();
+  sc->script = s;
+
+  // sized once so that the bitmap is never reallocated while running
+  if (s.source().isLoaded())
+  {
+    const size_t nblines = static_cast<size_t>(count_lines(s.source().content()));
+    sc->executed.resize(nblines / 64 + 1, 0);
+
+    if (m_count_hits)
+      sc->hits.resize(nblines, 0);
+  }
+
+  ScriptCoverage* result = sc.get();
+  m_scripts[s.path()] = std::move(sc);
+  return result;
+}
+
+Coverage::ScriptCoverage* Coverage::findScript(script::interpreter::FunctionCall& call)
+{
+  const void* f = call.callee().impl().get();
+  auto it = m_functions.find(f);
+
+  if (it != m_functions.end())
+    return it->second;
+
+  ScriptCoverage* sc = getScript(call.callee().script());
+  m_functions[f] = sc;
+  return sc;
+}
+
+void Coverage::writeLcov(std::ostream& out) const
+{
+  for (const auto& entry : m_scripts)
+  {
+    const ScriptCoverage& sc = *entry.second;
+    script::Script s = sc.script;
+
+    // the lines that can be executed are the ones with a breakpoint
+    std::set<int> lines;
+
+    if (s.source().isLoaded())
+    {
+      const int nblines = count_lines(s.source().content());
+
+      for (int l(0); l < nblines; ++l)
+      {
+        for (const auto& bp : s.breakpoints(l))
+          lines.insert(bp.second->line);
+      }
+    }
+
+    out << "TN:\n";
+    out << "SF:" << entry.first << "\n";
+
+    int nb_hit = 0;
+
+    for (int l : lines)
+    {
+      size_t hits = sc.isExecuted(l) ? 1 : 0;
+
+      if (m_count_hits && static_cast<size_t>(l) < sc.hits.size())
+        hits = sc.hits[l];
+
+      if (hits > 0)
+        ++nb_hit;
+
+      // lines are 0-based in the program and 1-based in lcov
+      out << "DA:" << (l + 1) << "," << hits << "\n";
+    }
+
+    out << "LF:" << lines.size() << "\n";
+    out << "LH:" << nb_hit << "\n";
+    out << "end_of_record\n";
+  }
+}
+
+bool Coverage::save(const std::string& path) const
+{
+  std::ofstream file{ path };
+
+  if (!file.is_open())
+    return false;
+
+  writeLcov(file);
+  return file.good();
+}
+
+} // namespace gonk
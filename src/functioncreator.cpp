@@ -4,9 +4,11 @@
 
 #include "gonk/functioncreator.h"
 
+#include "gonk/memoize.h"
+
 #include <script/ast/node.h>
 
-#include <iostream>
+#include <algorithm>
 #include <sstream>
 
 namespace gonk
@@ -17,6 +19,120 @@ CFunctionCreator::~CFunctionCreator()
 
 }
 
+int NativeSignatureTable::key(const script::Type& t)
+{
+  // the implicit object parameter of constructors is flagged
+  return t.data() & ~static_cast<int>(script::Type::ThisFlag);
+}
+
+size_t NativeSignatureTable::hash(const script::Prototype& proto)
+{
+  // FNV-1a
+  size_t h = static_cast<size_t>(14695981039346656037ULL);
+
+  auto combine = [&h](int value) {
+    h ^= static_cast<size_t>(static_cast<unsigned int>(value));
+    h *= static_cast<size_t>(1099511628211ULL);
+  };
+
+  combine(key(proto.returnType()));
+
+  for (int i(0); i < proto.count(); ++i)
+    combine(key(proto.at(i)));
+
+  return h;
+}
+
+bool NativeSignatureTable::matches(const Slot& slot, const script::Prototype& proto)
+{
+  if (slot.types.size() != static_cast<size_t>(proto.count()) + 1 || slot.types.front() != key(proto.returnType()))
+    return false;
+
+  for (int i(0); i < proto.count(); ++i)
+  {
+    if (slot.types.at(i + 1) != key(proto.at(i)))
+      return false;
+  }
+
+  return true;
+}
+
+void NativeSignatureTable::insert(const script::Prototype& proto, std::unique_ptr<CFunctionCreator> creator)
+{
+  // keep the load factor under 1/2
+  if (2 * (m_size + 1) > m_slots.size())
+    rehash(std::max<size_t>(16, 2 * m_slots.size()));
+
+  const size_t h = hash(proto);
+  const size_t mask = m_slots.size() - 1;
+
+  for (size_t i = h & mask; ; i = (i + 1) & mask)
+  {
+    Slot& slot = m_slots[i];
+
+    if (!slot.creator)
+    {
+      slot.hash = h;
+      slot.types.push_back(key(proto.returnType()));
+      for (int j(0); j < proto.count(); ++j)
+        slot.types.push_back(key(proto.at(j)));
+      slot.creator = std::move(creator);
+      ++m_size;
+      return;
+    }
+    else if (slot.hash == h && matches(slot, proto))
+    {
+      slot.creator = std::move(creator);
+      return;
+    }
+  }
+}
+
+CFunctionCreator* NativeSignatureTable::find(const script::Prototype& proto) const
+{
+  if (m_size == 0)
+    return nullptr;
+
+  const size_t h = hash(proto);
+  const size_t mask = m_slots.size() - 1;
+
+  for (size_t i = h & mask; ; i = (i + 1) & mask)
+  {
+    const Slot& slot = m_slots[i];
+
+    if (!slot.creator)
+      return nullptr;
+    else if (slot.hash == h && matches(slot, proto))
+      return slot.creator.get();
+  }
+}
+
+size_t NativeSignatureTable::size() const
+{
+  return m_size;
+}
+
+void NativeSignatureTable::rehash(size_t capacity)
+{
+  std::vector<Slot> slots{ std::move(m_slots) };
+  m_slots = std::vector<Slot>(capacity);
+
+  const size_t mask = capacity - 1;
+
+  for (Slot& slot : slots)
+  {
+    if (!slot.creator)
+      continue;
+
+    size_t i = slot.hash & mask;
+
+    while (m_slots[i].creator)
+      i = (i + 1) & mask;
+
+    m_slots[i] = std::move(slot);
+  }
+}
+
 FunctionCreator::FunctionCreator(script::Engine* e, dynlib::Library& lib)
   : m_engine(e),
     m_library(lib)
@@ -33,6 +149,8 @@ script::Function FunctionCreator::create(script::FunctionBlueprint& blueprint, c
 {
   if (blueprint.name().kind() == script::SymbolKind::Constructor)
     return create_ctor(blueprint, fdecl, attrs);
+  else if (blueprint.name().kind() == script::SymbolKind::Destructor)
+    return create_dtor(blueprint, fdecl, attrs);
   else
     return create_function(blueprint, fdecl, attrs);
 }
@@ -58,14 +176,42 @@ std::string FunctionCreator::stringify(const script::Prototype& proto)
   return ss.str();
 }
 
-void FunctionCreator::addCreator(const std::string& key, std::unique_ptr<CFunctionCreator> creator)
+void FunctionCreator::addCreator(const script::Prototype& proto, std::unique_ptr<CFunctionCreator> creator)
+{
+  m_function_creators.insert(proto, std::move(creator));
+}
+
+void FunctionCreator::addCCreator(const script::Prototype& proto, std::unique_ptr<CFunctionCreator> creator)
 {
-  m_function_creators[key] = std::move(creator);
+  m_ctor_creators.insert(proto, std::move(creator));
 }
 
-void FunctionCreator::addCCreator(const std::string& key, std::unique_ptr<CFunctionCreator> creator)
+void FunctionCreator::addDCreator(const script::Prototype& proto, std::unique_ptr<CFunctionCreator> creator)
 {
-  m_ctor_creators[key] = std::move(creator);
+  m_dtor_creators.insert(proto, std::move(creator));
+}
+
+void FunctionCreator::addMemberCreator(const std::string& name, const script::Prototype& proto, std::unique_ptr<CFunctionCreator> creator)
+{
+  m_members[name].insert(proto, std::move(creator));
+}
+
+void FunctionCreator::addSymbols(const NativeSymbol* symbols, size_t count)
+{
+  m_symbols.reserve(m_symbols.size() + count);
+
+  for (size_t i(0); i < count; ++i)
+    m_symbols[symbols[i].name] = symbols[i].proc;
+}
+
+void (*FunctionCreator::resolve(const std::string& name))()
+{
+  auto it = m_symbols.find(name);
+
+  if (it != m_symbols.end())
+    return it->second;
+
+  return m_library.resolve(name.c_str());
 }
 
 static bool get_callback_name(std::vector<script::Attribute>& attrs, std::string& out)
@@ -91,33 +237,38 @@ script::Function FunctionCreator::create_function(script::FunctionBlueprint& blu
 
   if (get_callback_name(attrs, callback_name))
   {
-    void(*proc)() = m_library.resolve(callback_name.c_str());
+    auto member = m_members.find(callback_name);
 
-    if (!proc)
+    if (member != m_members.end())
     {
-      std::cerr << "Unknown procedure: " << callback_name << std::endl;
+      CFunctionCreator* creator = member->second.find(blueprint.prototype_);
+
+      if (!creator)
+        throw NativeSignatureError("signature '" + stringify(blueprint.prototype_) + "' of native function " + blueprint.name().string() + " does not match member '" + callback_name + "'");
+
+      return creator->create(nullptr, blueprint);
     }
 
-    std::string key = stringify(blueprint.prototype_);
+    void(*proc)() = resolve(callback_name);
 
-    auto it = m_function_creators.find(key);
+    if (!proc)
+      throw NativeSignatureError("unknown procedure '" + callback_name + "' for native function " + blueprint.name().string());
 
-    if (it == m_function_creators.end())
-    {
-      std::cerr << "Unknown function signature: " << key << std::endl;
-      return script::FunctionCreator::create(blueprint, fdecl, attrs);
-    }
+    CFunctionCreator* creator = m_function_creators.find(blueprint.prototype_);
+
+    if (!creator)
+      throw NativeSignatureError("no creator registered for signature '" + stringify(blueprint.prototype_) + "' of native function " + blueprint.name().string());
 
-    std::unique_ptr<CFunctionCreator>& creator = it->second;
     return creator->create(proc, blueprint);
   }
   else
   {
-    return script::FunctionCreator::create(blueprint, fdecl, attrs);
+    script::Function f = script::FunctionCreator::create(blueprint, fdecl, attrs);
+    return memoize::apply(blueprint, f, attrs);
   }
 }
 
-static bool ctor_has_native_attr(std::vector<script::Attribute>& attrs)
+static bool has_native_attr(std::vector<script::Attribute>& attrs)
 {
   if (attrs.empty())
     return false;
@@ -145,19 +296,30 @@ static bool ctor_has_native_attr(std::vector<script::Attribute>& attrs)
 
 script::Function FunctionCreator::create_ctor(script::FunctionBlueprint& blueprint, const std::shared_ptr<script::ast::FunctionDecl>& fdecl, std::vector<script::Attribute>& attrs)
 {
-  if (ctor_has_native_attr(attrs))
+  if (has_native_attr(attrs))
   {
-    std::string key = stringify(blueprint.prototype_);
+    CFunctionCreator* creator = m_ctor_creators.find(blueprint.prototype_);
 
-    auto it = m_ctor_creators.find(key);
+    if (!creator)
+      throw NativeSignatureError("no creator registered for constructor signature '" + stringify(blueprint.prototype_) + "'");
 
-    if (it == m_ctor_creators.end())
-    {
-      std::cerr << "Unknown ctor signature: " << key << std::endl;
-      return script::FunctionCreator::create(blueprint, fdecl, attrs);
-    }
+    return creator->create(nullptr, blueprint);
+  }
+  else
+  {
+    return script::FunctionCreator::create(blueprint, fdecl, attrs);
+  }
+}
+
+script::Function FunctionCreator::create_dtor(script::FunctionBlueprint& blueprint, const std::shared_ptr<script::ast::FunctionDecl>& fdecl, std::vector<script::Attribute>& attrs)
+{
+  if (has_native_attr(attrs))
+  {
+    CFunctionCreator* creator = m_dtor_creators.find(blueprint.prototype_);
+
+    if (!creator)
+      throw NativeSignatureError("no creator registered for destructor signature '" + stringify(blueprint.prototype_) + "'");
 
-    std::unique_ptr<CFunctionCreator>& creator = it->second;
     return creator->create(nullptr, blueprint);
   }
   else
@@ -5,6 +5,8 @@
 #include "gonk/gonk.h"
 
 #include "gonk/builtins.h"
+#include "gonk/lazy-members.h"
+#include "gonk/memoize.h"
 #include "gonk/modules.h"
 #include "gonk/pretty-print.h"
 #include "gonk/script-runner.h"
@@ -69,6 +71,8 @@ Gonk::Gonk(int & argc, char **argv)
 
 Gonk::~Gonk()
 {
+  gonk::LazyMembers::release(&m_engine);
+  gonk::memoize::clear();
   m_engine.tearDown();
 
   m_instance = nullptr;
@@ -210,6 +214,7 @@ void Gonk::eval(std::string cmd)
 {
   try
   {
+    gonk::LazyMembers::of(scriptEngine()).demandSource(cmd);
     script::Value v = scriptEngine()->eval(cmd);
     display(v);
   }
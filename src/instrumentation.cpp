@@ -0,0 +1,89 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/instrumentation.h"
+
+#include <algorithm>
+
+namespace gonk
+{
+
+void DebugHandlerList::add(std::shared_ptr<script::interpreter::DebugHandler> handler)
+{
+  m_handlers.push_back(handler);
+}
+
+bool DebugHandlerList::empty() const
+{
+  return m_handlers.empty();
+}
+
+void DebugHandlerList::interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info)
+{
+  for (const auto& h : m_handlers)
+    h->interrupt(call, info);
+}
+
+NativeCallObserver::~NativeCallObserver()
+{
+
+}
+
+namespace instrumentation
+{
+
+NativeCallObserver* native_call_observer = nullptr;
+
+class NativeCallObserverList : public NativeCallObserver
+{
+public:
+  std::vector<NativeCallObserver*> observers;
+
+  void enter(script::interpreter::FunctionCall* c) override
+  {
+    for (NativeCallObserver* o : observers)
+      o->enter(c);
+  }
+
+  void leave(script::interpreter::FunctionCall* c) override
+  {
+    for (auto it = observers.rbegin(); it != observers.rend(); ++it)
+      (*it)->leave(c);
+  }
+};
+
+static NativeCallObserverList& observer_list()
+{
+  static NativeCallObserverList list;
+  return list;
+}
+
+static void update_native_call_observer()
+{
+  std::vector<NativeCallObserver*>& observers = observer_list().observers;
+
+  if (observers.empty())
+    native_call_observer = nullptr;
+  else if (observers.size() == 1)
+    native_call_observer = observers.front();
+  else
+    native_call_observer = &observer_list();
+}
+
+void addNativeCallObserver(NativeCallObserver* observer)
+{
+  observer_list().observers.push_back(observer);
+  update_native_call_observer();
+}
+
+void removeNativeCallObserver(NativeCallObserver* observer)
+{
+  std::vector<NativeCallObserver*>& observers = observer_list().observers;
+  observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+  update_native_call_observer();
+}
+
+} // namespace instrumentation
+
+} // namespace gonk
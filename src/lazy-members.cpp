@@ -0,0 +1,123 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/lazy-members.h"
+
+#include <script/engine.h>
+
+#include <cctype>
+#include <map>
+#include <memory>
+
+namespace gonk
+{
+
+static std::map<script::Engine*, std::unique_ptr<LazyMembers>>& get_registries()
+{
+  static std::map<script::Engine*, std::unique_ptr<LazyMembers>> map = {};
+  return map;
+}
+
+static bool is_ident_char(char c)
+{
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+LazyMembers& LazyMembers::of(script::Engine* e)
+{
+  std::unique_ptr<LazyMembers>& result = get_registries()[e];
+
+  if (!result)
+    result = std::make_unique<LazyMembers>();
+
+  return *result;
+}
+
+void LazyMembers::release(script::Engine* e)
+{
+  get_registries().erase(e);
+}
+
+void LazyMembers::add(script::Class cla, const std::string& name, Creator creator)
+{
+  Entry entry{ cla, creator };
+
+  if (m_demanded.find(name) != m_demanded.end())
+    create(entry, name);
+  else
+    m_pending[name].push_back(entry);
+}
+
+void LazyMembers::demand(const std::string& name)
+{
+  if (!m_demanded.insert(name).second)
+    return;
+
+  auto it = m_pending.find(name);
+
+  if (it == m_pending.end())
+    return;
+
+  std::vector<Entry> entries = std::move(it->second);
+  m_pending.erase(it);
+
+  for (Entry& entry : entries)
+    create(entry, name);
+}
+
+void LazyMembers::demandSource(const std::string& source)
+{
+  size_t i = 0;
+
+  while (i < source.size())
+  {
+    if (!is_ident_char(source[i]))
+    {
+      ++i;
+      continue;
+    }
+
+    size_t j = i;
+
+    while (j < source.size() && is_ident_char(source[j]))
+      ++j;
+
+    if (!std::isdigit(static_cast<unsigned char>(source[i])))
+      demand(source.substr(i, j - i));
+
+    i = j;
+  }
+}
+
+void LazyMembers::materializeAll()
+{
+  std::unordered_map<std::string, std::vector<Entry>> pending = std::move(m_pending);
+  m_pending.clear();
+
+  for (auto& p : pending)
+  {
+    m_demanded.insert(p.first);
+
+    for (Entry& entry : p.second)
+      create(entry, p.first);
+  }
+}
+
+size_t LazyMembers::pendingCount() const
+{
+  size_t n = 0;
+
+  for (const auto& p : m_pending)
+    n += p.second.size();
+
+  return n;
+}
+
+void LazyMembers::create(Entry& entry, const std::string& name)
+{
+  entry.creator(entry.cla, name);
+  ++m_created;
+}
+
+} // namespace gonk
@@ -0,0 +1,564 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/memoize.h"
+
+#include "gonk/common/semvalue.h"
+
+#include <script/ast/node.h>
+#include <script/engine.h>
+#include <script/enumerator.h>
+#include <script/function-impl.h>
+#include <script/interpreter/executioncontext.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <list>
+#include <unordered_map>
+
+namespace gonk
+{
+
+enum class MemoArgKind
+{
+  Scalar,
+  Floating,
+  String,
+  Enum,
+  Object,
+};
+
+struct MemoArg
+{
+  uint64_t bits = 0;
+  std::string str;
+  // borrowed from the caller while a key is looked up,
+  // copied when the key is inserted in the cache
+  script::Value object;
+  const TypeInfo* type = nullptr;
+};
+
+static bool invoke_bool(const script::Function& f, const script::Value& a, const script::Value& b)
+{
+  script::Value ret = f.invoke({ a, b });
+  bool result = ret.toBool();
+  f.engine()->destroy(ret);
+  return result;
+}
+
+struct MemoKey
+{
+  std::vector<MemoArg> args;
+  size_t hash = 0;
+};
+
+struct MemoKeyHash
+{
+  size_t operator()(const MemoKey* key) const
+  {
+    return key->hash;
+  }
+};
+
+struct MemoKeyEq
+{
+  bool operator()(const MemoKey* a, const MemoKey* b) const
+  {
+    if (a->hash != b->hash)
+      return false;
+
+    for (size_t i(0); i < a->args.size(); ++i)
+    {
+      const MemoArg& x = a->args.at(i);
+      const MemoArg& y = b->args.at(i);
+
+      if (x.bits != y.bits || x.str != y.str)
+        return false;
+
+      if (x.type && !invoke_bool(x.type->eq, x.object, y.object))
+        return false;
+    }
+
+    return true;
+  }
+};
+
+/*!
+ * \class MemoCache
+ * \brief LRU cache of the results of a [[memoize]] function
+ */
+class MemoCache
+{
+public:
+  MemoCache(std::string name, size_t capacity);
+  MemoCache(const MemoCache&) = delete;
+  ~MemoCache();
+
+  const script::Value* find(const MemoKey& key);
+  void insert(MemoKey key, script::Value result);
+  void clear();
+
+  MemoStats stats() const;
+
+  MemoCache& operator=(const MemoCache&) = delete;
+
+private:
+  struct Entry
+  {
+    MemoKey key;
+    script::Value result;
+  };
+
+  void destroy(Entry& entry);
+
+private:
+  std::string m_name;
+  size_t m_capacity;
+  // most recently used first
+  std::list<Entry> m_entries;
+  std::unordered_map<const MemoKey*, std::list<Entry>::iterator, MemoKeyHash, MemoKeyEq> m_index;
+  size_t m_hits = 0;
+  size_t m_misses = 0;
+  size_t m_evictions = 0;
+};
+
+static std::vector<MemoCache*>& get_caches()
+{
+  static std::vector<MemoCache*> list = {};
+  return list;
+}
+
+MemoCache::MemoCache(std::string name, size_t capacity)
+  : m_name(std::move(name)),
+    m_capacity(capacity)
+{
+  m_index.reserve(capacity);
+  get_caches().push_back(this);
+}
+
+MemoCache::~MemoCache()
+{
+  clear();
+
+  auto& caches = get_caches();
+  caches.erase(std::remove(caches.begin(), caches.end(), this), caches.end());
+}
+
+const script::Value* MemoCache::find(const MemoKey& key)
+{
+  auto it = m_index.find(&key);
+
+  if (it == m_index.end())
+  {
+    ++m_misses;
+    return nullptr;
+  }
+
+  ++m_hits;
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return &it->second->result;
+}
+
+void MemoCache::insert(MemoKey key, script::Value result)
+{
+  if (m_entries.size() == m_capacity)
+  {
+    Entry& lru = m_entries.back();
+    m_index.erase(&lru.key);
+    destroy(lru);
+    m_entries.pop_back();
+    ++m_evictions;
+  }
+
+  for (MemoArg& arg : key.args)
+  {
+    if (arg.type)
+      arg.object = arg.type->engine->copy(arg.object);
+  }
+
+  m_entries.push_front(Entry{ std::move(key), result });
+  m_index[&m_entries.front().key] = m_entries.begin();
+}
+
+void MemoCache::clear()
+{
+  m_index.clear();
+
+  for (Entry& e : m_entries)
+    destroy(e);
+
+  m_entries.clear();
+}
+
+void MemoCache::destroy(Entry& entry)
+{
+  for (MemoArg& arg : entry.key.args)
+  {
+    if (arg.type)
+      arg.type->engine->destroy(arg.object);
+  }
+
+  if (entry.result.type().isObjectType())
+    entry.result.engine()->destroy(entry.result);
+}
+
+MemoStats MemoCache::stats() const
+{
+  MemoStats result;
+  result.name = m_name;
+  result.capacity = m_capacity;
+  result.size = m_entries.size();
+  result.hits = m_hits;
+  result.misses = m_misses;
+  result.evictions = m_evictions;
+  return result;
+}
+
+static void combine(size_t& h, size_t value)
+{
+  h ^= value + 0x9e3779b9 + (h << 6) + (h >> 2);
+}
+
+/*!
+ * \class MemoizedFunction
+ * \brief function returning the cached result of a script function
+ *
+ * The compiled body is given to the wrapped function, which is invoked
+ * through the interpreter when the arguments are not in the cache.
+ */
+class MemoizedFunction : public script::FunctionImpl
+{
+public:
+  script::Function m_function;
+  script::Name m_name;
+  std::vector<MemoArgKind> m_kinds;
+  std::vector<std::shared_ptr<TypeInfo>> m_typeinfos;
+  MemoCache m_cache;
+
+public:
+  MemoizedFunction(script::FunctionBlueprint& blueprint, const script::Function& f, std::vector<MemoArgKind> kinds, std::vector<std::shared_ptr<TypeInfo>> typeinfos, size_t capacity)
+    : FunctionImpl(blueprint.engine(), blueprint.flags()),
+      m_function(f),
+      m_name(blueprint.name()),
+      m_kinds(std::move(kinds)),
+      m_typeinfos(std::move(typeinfos)),
+      m_cache(blueprint.name().string(), capacity)
+  {
+    enclosing_symbol = blueprint.parent().impl();
+  }
+
+  script::SymbolKind get_kind() const override
+  {
+    return m_name.kind();
+  }
+
+  const std::string& name() const override
+  {
+    return m_name.string();
+  }
+
+  script::Name get_name() const override
+  {
+    return m_name;
+  }
+
+  bool is_native() const override
+  {
+    return true;
+  }
+
+  void set_body(std::shared_ptr<script::program::Statement> body) override
+  {
+    m_function.impl()->set_body(body);
+  }
+
+  const script::Prototype& prototype() const override
+  {
+    return m_function.impl()->prototype();
+  }
+
+  // returns false if the value cannot be looked up, i.e. NaN
+  bool fill(MemoArg& arg, size_t i, const script::Value& val)
+  {
+    switch (m_kinds[i])
+    {
+    case MemoArgKind::Scalar:
+    {
+      const script::Type t = val.type().baseType();
+      arg.bits = static_cast<uint64_t>(t == script::Type::Boolean ? val.toBool() : (t == script::Type::Char ? val.toChar() : val.toInt()));
+      break;
+    }
+    case MemoArgKind::Floating:
+    {
+      double d = val.type().baseType() == script::Type::Float ? val.toFloat() : val.toDouble();
+
+      if (std::isnan(d))
+        return false;
+
+      // the keys are compared bitwise, -0.0 must match 0.0
+      if (d == 0)
+        d = 0.0;
+
+      std::memcpy(&arg.bits, &d, sizeof(d));
+      break;
+    }
+    case MemoArgKind::String:
+      arg.str = val.toString();
+      break;
+    case MemoArgKind::Enum:
+      arg.bits = static_cast<uint64_t>(val.toEnumerator().value());
+      break;
+    case MemoArgKind::Object:
+      arg.object = val;
+      arg.type = m_typeinfos[i].get();
+      break;
+    }
+
+    return true;
+  }
+
+  size_t hash(const MemoArg& arg, size_t i) const
+  {
+    switch (m_kinds[i])
+    {
+    case MemoArgKind::String:
+      return std::hash<std::string>()(arg.str);
+    case MemoArgKind::Object:
+    {
+      // values of a type without hash() all fall in the same bucket
+      if (!m_typeinfos[i]->supportsHashing())
+        return 0;
+
+      script::Value ret = m_typeinfos[i]->hash.invoke({ arg.object });
+      const size_t h = static_cast<size_t>(ret.toInt());
+      ret.engine()->destroy(ret);
+      return h;
+    }
+    default:
+      return std::hash<uint64_t>()(arg.bits);
+    }
+  }
+
+  script::Value invoke(script::FunctionCall* c) override
+  {
+    MemoKey key;
+    key.args.resize(m_kinds.size());
+
+    bool cacheable = true;
+
+    for (size_t i(0); i < m_kinds.size() && cacheable; ++i)
+    {
+      cacheable = fill(key.args[i], i, c->arg(static_cast<int>(i)));
+      combine(key.hash, hash(key.args[i], i));
+    }
+
+    if (cacheable)
+    {
+      if (const script::Value* cached = m_cache.find(key))
+        return c->engine()->copy(*cached);
+    }
+
+    std::vector<script::Value> args;
+    args.reserve(m_kinds.size());
+
+    for (size_t i(0); i < m_kinds.size(); ++i)
+      args.push_back(c->arg(static_cast<int>(i)));
+
+    script::Value result = m_function.invoke(args);
+
+    // a NaN argument never equals a cached one
+    if (!cacheable)
+      return result;
+
+    m_cache.insert(std::move(key), c->engine()->copy(result));
+    return result;
+  }
+
+  void clear()
+  {
+    m_cache.clear();
+  }
+};
+
+// returns true if attr is [[memoize]] or [[memoize(capacity)]];
+// capacity is set to 0 if the argument is not a positive integer
+static bool is_memoize_attr(const script::Attribute& attr, size_t& capacity)
+{
+  if (attr->is<script::ast::SimpleIdentifier>())
+  {
+    capacity = memoize::DefaultCapacity;
+    return attr->as<script::ast::SimpleIdentifier>().source().toString() == "memoize";
+  }
+  else if (attr->is<script::ast::FunctionCall>())
+  {
+    const auto& fcall = attr->as<script::ast::FunctionCall>();
+
+    if (fcall.callee->source().toString() != "memoize")
+      return false;
+
+    const std::string arg = fcall.arguments.size() == 1 ? fcall.arguments.front()->source().toString() : std::string();
+    const bool is_number = !arg.empty() && arg.size() < 10 && std::all_of(arg.begin(), arg.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+
+    capacity = is_number ? std::stoul(arg) : 0;
+    return true;
+  }
+
+  return false;
+}
+
+static bool get_arg_kind(const script::Type& t, MemoArgKind& kind)
+{
+  if (t.isReference() && !t.isConst())
+    return false;
+
+  switch (t.baseType().data())
+  {
+  case script::Type::Boolean:
+  case script::Type::Char:
+  case script::Type::Int:
+    kind = MemoArgKind::Scalar;
+    return true;
+  case script::Type::Float:
+  case script::Type::Double:
+    kind = MemoArgKind::Floating;
+    return true;
+  case script::Type::String:
+    kind = MemoArgKind::String;
+    return true;
+  default:
+    break;
+  }
+
+  if (t.isEnumType())
+    kind = MemoArgKind::Enum;
+  else if (t.isObjectType())
+    kind = MemoArgKind::Object;
+  else
+    return false;
+
+  return true;
+}
+
+namespace memoize
+{
+
+static std::vector<std::weak_ptr<MemoizedFunction>>& get_functions()
+{
+  static std::vector<std::weak_ptr<MemoizedFunction>> list = {};
+  return list;
+}
+
+script::Function apply(script::FunctionBlueprint& blueprint, const script::Function& f, const std::vector<script::Attribute>& attrs)
+{
+  size_t capacity = 0;
+
+  auto it = std::find_if(attrs.begin(), attrs.end(), [&capacity](const script::Attribute& attr) {
+    return is_memoize_attr(attr, capacity);
+  });
+
+  if (it == attrs.end())
+    return f;
+
+  const std::string name = blueprint.name().string();
+  const script::Prototype& proto = f.prototype();
+
+  if (capacity == 0)
+    throw MemoizeError("[[memoize]] function " + name + ": the capacity must be a positive integer");
+
+  if (proto.returnType().baseType() == script::Type::Void || proto.returnType().isReference())
+    throw MemoizeError("[[memoize]] function " + name + " must return a value");
+
+  std::vector<MemoArgKind> kinds;
+  std::vector<std::shared_ptr<TypeInfo>> typeinfos;
+
+  for (int i(0); i < proto.count(); ++i)
+  {
+    MemoArgKind k;
+
+    if (!get_arg_kind(proto.at(i), k))
+      throw MemoizeError("[[memoize]] function " + name + ": parameter " + std::to_string(i + 1) + " cannot be used as a key");
+
+    std::shared_ptr<TypeInfo> ti;
+
+    if (k == MemoArgKind::Object)
+    {
+      // the keys are only compared and hashed, no need for operator= or operator<
+      ti = std::make_shared<TypeInfo>();
+      ti->type = proto.at(i).baseType();
+      ti->engine = blueprint.engine();
+
+      try
+      {
+        ti->eq = TypeInfo::get_eq(ti->engine, ti->type);
+        ti->hash = TypeInfo::get_hash(ti->engine, ti->type);
+      }
+      catch (const std::runtime_error& err)
+      {
+        throw MemoizeError("[[memoize]] function " + name + ": parameter " + std::to_string(i + 1) + " cannot be used as a key (" + err.what() + ")");
+      }
+    }
+
+    kinds.push_back(k);
+    typeinfos.push_back(std::move(ti));
+  }
+
+  auto impl = std::make_shared<MemoizedFunction>(blueprint, f, std::move(kinds), std::move(typeinfos), capacity);
+  get_functions().push_back(impl);
+  return script::Function(impl);
+}
+
+std::vector<MemoStats> stats()
+{
+  std::vector<MemoStats> result;
+
+  for (const MemoCache* c : get_caches())
+    result.push_back(c->stats());
+
+  return result;
+}
+
+void clear()
+{
+  for (const std::weak_ptr<MemoizedFunction>& f : get_functions())
+  {
+    if (auto impl = f.lock())
+      impl->clear();
+  }
+
+  get_functions().clear();
+}
+
+void write_report(std::ostream& out)
+{
+  out << std::left << std::setw(32) << "function" << std::right
+    << std::setw(10) << "size" << std::setw(10) << "capacity"
+    << std::setw(12) << "hits" << std::setw(12) << "misses"
+    << std::setw(10) << "hit rate" << std::setw(12) << "evictions" << std::endl;
+
+  for (const MemoStats& s : stats())
+  {
+    const size_t calls = s.hits + s.misses;
+
+    out << std::left << std::setw(32) << s.name << std::right
+      << std::setw(10) << s.size << std::setw(10) << s.capacity
+      << std::setw(12) << s.hits << std::setw(12) << s.misses
+      << std::setw(9) << std::fixed << std::setprecision(1) << (calls > 0 ? 100.0 * s.hits / calls : 0.0) << "%"
+      << std::defaultfloat << std::setw(12) << s.evictions << std::endl;
+  }
+}
+
+} // namespace memoize
+
+script::Function MemoizeCreator::create(script::FunctionBlueprint& blueprint, const std::shared_ptr<script::ast::FunctionDecl>& fdecl, std::vector<script::Attribute>& attrs)
+{
+  script::Function f = script::FunctionCreator::create(blueprint, fdecl, attrs);
+  return memoize::apply(blueprint, f, attrs);
+}
+
+} // namespace gonk
@@ -0,0 +1,317 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/memstats.h"
+
+#include <script/engine.h>
+#include <script/typesystem.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace gonk
+{
+
+namespace memstats
+{
+
+std::atomic<bool> enabled{ false };
+std::atomic<bool> track_containers{ false };
+CopyObserver* copy_observer = nullptr;
+int copy_scope_depth = 0;
+
+static void merge(std::map<int, TypeCounters>& result, const std::map<int, TypeCounters>& counters)
+{
+  for (const auto& p : counters)
+  {
+    TypeCounters& c = result[p.first];
+    c.constructed += p.second.constructed;
+    c.copied += p.second.copied;
+    c.destroyed += p.second.destroyed;
+  }
+}
+
+// the mutex of a shard is only contended while the counters are read
+struct Shard
+{
+  std::mutex mutex;
+  std::map<int, TypeCounters> counters;
+};
+
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<Shard*> shards;
+  std::map<int, TypeCounters> retired; // what the threads that exited had counted
+};
+
+static Registry& registry()
+{
+  static Registry r;
+  return r;
+}
+
+struct ShardHandle
+{
+  Shard* shard;
+
+  ShardHandle()
+    : shard(new Shard)
+  {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock{ r.mutex };
+    r.shards.push_back(shard);
+  }
+
+  ~ShardHandle()
+  {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock{ r.mutex };
+    merge(r.retired, shard->counters);
+    r.shards.erase(std::remove(r.shards.begin(), r.shards.end(), shard), r.shards.end());
+    delete shard;
+  }
+};
+
+static Shard& local_shard()
+{
+  thread_local ShardHandle handle;
+  return *handle.shard;
+}
+
+static std::map<int, SizeEstimator>& get_size_estimators()
+{
+  static std::map<int, SizeEstimator> map = {};
+  return map;
+}
+
+static std::vector<ContainerTracker*>& get_trackers()
+{
+  static std::vector<ContainerTracker*> list = {};
+  return list;
+}
+
+void setEnabled(bool on)
+{
+  enabled.store(on);
+}
+
+void setTrackContainers(bool on)
+{
+  static std::mutex mutex;
+  static int users = 0;
+
+  std::lock_guard<std::mutex> lock{ mutex };
+
+  if (on)
+    ++users;
+  else if (users > 0)
+    --users;
+
+  track_containers.store(users > 0);
+}
+
+void reset()
+{
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock{ r.mutex };
+
+  for (Shard* shard : r.shards)
+  {
+    std::lock_guard<std::mutex> shard_lock{ shard->mutex };
+    shard->counters.clear();
+  }
+
+  r.retired.clear();
+}
+
+void record(Operation op, int type_id)
+{
+  Shard& shard = local_shard();
+  std::lock_guard<std::mutex> lock{ shard.mutex };
+  TypeCounters& c = shard.counters[type_id];
+
+  switch (op)
+  {
+  case Construct:
+    c.constructed += 1;
+    break;
+  case Copy:
+    c.copied += 1;
+    break;
+  case Destroy:
+    c.destroyed += 1;
+    break;
+  }
+}
+
+void record_copy(const script::Value& copy)
+{
+  record(Copy, copy.type().baseType().data());
+
+  if (copy_observer && copy_scope_depth == 0)
+    copy_observer->copied(copy);
+}
+
+CopyObserver::~CopyObserver()
+{
+  if (copy_observer == this)
+    copy_observer = nullptr;
+}
+
+void setSizeEstimator(const script::Type& t, SizeEstimator fn)
+{
+  get_size_estimators()[t.baseType().data()] = fn;
+}
+
+size_t estimate_size(const script::Value& val)
+{
+  if (val.isNull())
+    return 0;
+
+  const script::Type t = val.type().baseType();
+
+  if (t == script::Type::String)
+    return sizeof(std::string) + val.toString().capacity();
+  else if (t.isFundamentalType() || t.isEnumType())
+    return sizeof(int);
+
+  auto& estimators = get_size_estimators();
+  auto it = estimators.find(t.data());
+
+  if (it != estimators.end())
+    return it->second(val);
+
+  // the size of native objects is unknown, count at least the reference
+  return sizeof(void*);
+}
+
+std::map<int, TypeCounters> counters()
+{
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock{ r.mutex };
+
+  std::map<int, TypeCounters> result = r.retired;
+
+  for (Shard* shard : r.shards)
+  {
+    std::lock_guard<std::mutex> shard_lock{ shard->mutex };
+    merge(result, shard->counters);
+  }
+
+  return result;
+}
+
+TypeCounters total()
+{
+  TypeCounters result;
+
+  for (const auto& p : counters())
+  {
+    result.constructed += p.second.constructed;
+    result.copied += p.second.copied;
+    result.destroyed += p.second.destroyed;
+  }
+
+  return result;
+}
+
+ContainerTracker::ContainerTracker(std::string name)
+  : m_name(std::move(name))
+{
+  get_trackers().push_back(this);
+}
+
+ContainerTracker::~ContainerTracker()
+{
+  auto& list = get_trackers();
+  list.erase(std::remove(list.begin(), list.end(), this), list.end());
+}
+
+const std::string& ContainerTracker::name() const
+{
+  return m_name;
+}
+
+std::vector<ContainerStats> containers()
+{
+  std::vector<ContainerStats> result;
+
+  for (ContainerTracker* t : get_trackers())
+    result.push_back(t->stats());
+
+  return result;
+}
+
+size_t peak_rss()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return static_cast<size_t>(pmc.PeakWorkingSetSize / 1024);
+  return 0;
+#elif defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return static_cast<size_t>(usage.ru_maxrss / 1024);
+#else
+  return static_cast<size_t>(usage.ru_maxrss);
+#endif // defined(__APPLE__)
+#else
+  return 0;
+#endif // defined(_WIN32)
+}
+
+void write_report(std::ostream& out, script::Engine& e)
+{
+  const std::map<int, TypeCounters> all = counters();
+  std::vector<std::pair<int, TypeCounters>> entries{ all.begin(), all.end() };
+
+  std::sort(entries.begin(), entries.end(), [](const std::pair<int, TypeCounters>& a, const std::pair<int, TypeCounters>& b) {
+    return (a.second.constructed + a.second.copied) > (b.second.constructed + b.second.copied);
+    });
+
+  out << "memory statistics" << std::endl;
+  out << std::setw(12) << "constructed" << std::setw(12) << "copied"
+    << std::setw(12) << "destroyed" << "  type" << std::endl;
+
+  for (const auto& p : entries)
+  {
+    out << std::setw(12) << p.second.constructed << std::setw(12) << p.second.copied
+      << std::setw(12) << p.second.destroyed << "  " << e.typeSystem()->typeName(script::Type(p.first)) << std::endl;
+  }
+
+  std::vector<ContainerStats> list = containers();
+
+  if (!list.empty())
+  {
+    out << std::endl;
+    out << std::setw(10) << "live" << std::setw(10) << "created"
+      << std::setw(12) << "elements" << std::setw(12) << "capacity" << "  container" << std::endl;
+
+    for (const ContainerStats& c : list)
+    {
+      out << std::setw(10) << c.live << std::setw(10) << c.created
+        << std::setw(12) << c.elements << std::setw(12) << c.capacity << "  " << c.name << std::endl;
+    }
+  }
+
+  out << std::endl;
+  out << "peak RSS: " << peak_rss() << " KB" << std::endl;
+}
+
+} // namespace memstats
+
+} // namespace gonk
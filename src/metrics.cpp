@@ -0,0 +1,323 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/metrics.h"
+
+#include "gonk/memstats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+
+namespace gonk
+{
+
+namespace metrics
+{
+
+bool enabled = false;
+
+// only the owning thread writes to a shard, relaxed loads and stores
+// are enough for the snapshots taken from other threads
+struct Shard
+{
+  std::array<std::atomic<uint64_t>, Metrics::CounterCount> counters{};
+
+  struct Histogram
+  {
+    std::array<std::atomic<uint64_t>, Metrics::BucketCount> buckets{};
+    std::atomic<uint64_t> count{ 0 };
+    std::atomic<double> sum{ 0 };
+  };
+
+  std::array<Histogram, Metrics::HistogramCount> histograms{};
+};
+
+static void add(std::atomic<uint64_t>& counter, uint64_t n)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+static void add(std::atomic<double>& value, double n)
+{
+  value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+static void merge(Metrics::Snapshot& result, const Shard& shard)
+{
+  for (size_t i(0); i < Metrics::CounterCount; ++i)
+    result.counters[i] += shard.counters[i].load(std::memory_order_relaxed);
+
+  for (size_t i(0); i < Metrics::HistogramCount; ++i)
+  {
+    Metrics::HistogramData& h = result.histograms[i];
+    const Shard::Histogram& sh = shard.histograms[i];
+
+    for (size_t j(0); j < Metrics::BucketCount; ++j)
+      h.buckets[j] += sh.buckets[j].load(std::memory_order_relaxed);
+
+    h.count += sh.count.load(std::memory_order_relaxed);
+    h.sum += sh.sum.load(std::memory_order_relaxed);
+  }
+}
+
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<Shard*> shards;
+  Metrics::Snapshot retired; // what the threads that exited had counted
+};
+
+static Registry& registry()
+{
+  static Registry r;
+  return r;
+}
+
+struct ShardHandle
+{
+  Shard* shard;
+
+  ShardHandle()
+    : shard(new Shard)
+  {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock{ r.mutex };
+    r.shards.push_back(shard);
+  }
+
+  ~ShardHandle()
+  {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock{ r.mutex };
+    merge(r.retired, *shard);
+    r.shards.erase(std::remove(r.shards.begin(), r.shards.end(), shard), r.shards.end());
+    delete shard;
+  }
+};
+
+static Shard& local_shard()
+{
+  thread_local ShardHandle handle;
+  return *handle.shard;
+}
+
+} // namespace metrics
+
+const std::array<double, Metrics::BucketCount - 1>& Metrics::bucketBounds()
+{
+  static const std::array<double, BucketCount - 1> bounds = { 1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1.0, 10.0 };
+  return bounds;
+}
+
+void Metrics::setEnabled(bool on)
+{
+  // the element counts are read from the live containers
+  if (metrics::enabled != on)
+    memstats::setTrackContainers(on);
+
+  metrics::enabled = on;
+}
+
+void Metrics::increment(Counter c, uint64_t n)
+{
+  metrics::add(metrics::local_shard().counters[c], n);
+}
+
+void Metrics::observe(Histogram h, double seconds)
+{
+  metrics::Shard::Histogram& data = metrics::local_shard().histograms[h];
+
+  const auto& bounds = bucketBounds();
+  const size_t bucket = static_cast<size_t>(std::lower_bound(bounds.begin(), bounds.end(), seconds) - bounds.begin());
+
+  metrics::add(data.buckets[bucket], 1);
+  metrics::add(data.count, 1);
+  metrics::add(data.sum, seconds);
+}
+
+Metrics::Snapshot Metrics::snapshot()
+{
+  metrics::Registry& r = metrics::registry();
+
+  Snapshot result;
+
+  {
+    std::lock_guard<std::mutex> lock{ r.mutex };
+
+    result = r.retired;
+
+    for (const metrics::Shard* shard : r.shards)
+      metrics::merge(result, *shard);
+  }
+
+  for (const memstats::ContainerStats& c : memstats::containers())
+    result.container_elements.emplace_back(c.name, c.elements);
+
+  return result;
+}
+
+void Metrics::reset()
+{
+  metrics::Registry& r = metrics::registry();
+  std::lock_guard<std::mutex> lock{ r.mutex };
+
+  r.retired = Snapshot();
+
+  // racy with respect to the owning threads, which is fine for a reset
+  for (metrics::Shard* shard : r.shards)
+  {
+    for (auto& c : shard->counters)
+      c.store(0, std::memory_order_relaxed);
+
+    for (auto& h : shard->histograms)
+    {
+      for (auto& b : h.buckets)
+        b.store(0, std::memory_order_relaxed);
+
+      h.count.store(0, std::memory_order_relaxed);
+      h.sum.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+const char* Metrics::name(Counter c)
+{
+  switch (c)
+  {
+  case ScriptsCompiled: return "scripts_compiled";
+  case CompileErrors: return "compile_errors";
+  case ScriptsRun: return "scripts_run";
+  case ModulesDiscovered: return "modules_discovered";
+  case ModuleImports: return "module_imports";
+  case ModuleLoads: return "module_loads";
+  case ModuleLoadFailures: return "module_load_failures";
+  case NativeCalls: return "native_calls";
+  case RuntimeErrors: return "runtime_errors";
+  case UncaughtErrors: return "uncaught_errors";
+  default: return "unknown";
+  }
+}
+
+const char* Metrics::name(Histogram h)
+{
+  switch (h)
+  {
+  case CompileTime: return "compile_time_seconds";
+  case RunTime: return "run_time_seconds";
+  case ModuleLoadTime: return "module_load_time_seconds";
+  default: return "unknown";
+  }
+}
+
+void Metrics::writePrometheus(std::ostream& out, const Snapshot& s)
+{
+  for (size_t i(0); i < CounterCount; ++i)
+  {
+    const std::string n = std::string("gonk_") + name(static_cast<Counter>(i)) + "_total";
+    out << "# TYPE " << n << " counter\n";
+    out << n << " " << s.counters[i] << "\n";
+  }
+
+  for (size_t i(0); i < HistogramCount; ++i)
+  {
+    const std::string n = std::string("gonk_") + name(static_cast<Histogram>(i));
+    const HistogramData& h = s.histograms[i];
+    const auto& bounds = bucketBounds();
+
+    out << "# TYPE " << n << " histogram\n";
+
+    // prometheus buckets are cumulative
+    uint64_t cumulated = 0;
+
+    for (size_t j(0); j < BucketCount; ++j)
+    {
+      cumulated += h.buckets[j];
+      out << n << "_bucket{le=\"";
+
+      if (j < bounds.size())
+        out << bounds[j];
+      else
+        out << "+Inf";
+
+      out << "\"} " << cumulated << "\n";
+    }
+
+    out << n << "_sum " << h.sum << "\n";
+    out << n << "_count " << h.count << "\n";
+  }
+
+  if (!s.container_elements.empty())
+  {
+    out << "# TYPE gonk_container_elements gauge\n";
+
+    for (const auto& c : s.container_elements)
+      out << "gonk_container_elements{container=\"" << c.first << "\"} " << c.second << "\n";
+  }
+}
+
+void Metrics::writeJson(std::ostream& out, const Snapshot& s)
+{
+  out << "{\"counters\":{";
+
+  for (size_t i(0); i < CounterCount; ++i)
+  {
+    if (i > 0)
+      out << ",";
+
+    out << "\"" << name(static_cast<Counter>(i)) << "\":" << s.counters[i];
+  }
+
+  out << "},\"histograms\":{";
+
+  for (size_t i(0); i < HistogramCount; ++i)
+  {
+    const HistogramData& h = s.histograms[i];
+
+    if (i > 0)
+      out << ",";
+
+    out << "\"" << name(static_cast<Histogram>(i)) << "\":{\"count\":" << h.count << ",\"sum\":" << h.sum << ",\"buckets\":[";
+
+    for (size_t j(0); j < BucketCount; ++j)
+    {
+      if (j > 0)
+        out << ",";
+
+      out << h.buckets[j];
+    }
+
+    out << "]}";
+  }
+
+  out << "},\"container_elements\":{";
+
+  for (size_t i(0); i < s.container_elements.size(); ++i)
+  {
+    if (i > 0)
+      out << ",";
+
+    out << "\"" << s.container_elements[i].first << "\":" << s.container_elements[i].second;
+  }
+
+  out << "}}";
+}
+
+std::string Metrics::toPrometheus()
+{
+  std::stringstream ss;
+  writePrometheus(ss, snapshot());
+  return ss.str();
+}
+
+std::string Metrics::toJson()
+{
+  std::stringstream ss;
+  writeJson(ss, snapshot());
+  return ss.str();
+}
+
+} // namespace gonk
@@ -6,10 +6,18 @@
 
 #include "gonk/gonk.h"
 #include "gonk/gonkmodule.h"
+#include "gonk/coverage.h"
+#include "gonk/functioncreator.h"
+#include "gonk/lazy-members.h"
+#include "gonk/memoize.h"
+#include "gonk/metrics.h"
 #include "gonk/plugin.h"
+#include "gonk/tracer.h"
 
 #include <dynlib/dynlib.h>
 
+#include <script/interpreter/interpreter.h>
+
 #include <algorithm>
 #include <filesystem>
 
@@ -100,6 +108,7 @@ protected:
       module_info.dependencies = gonkmodulefile.dependencies.value_or(std::vector<std::string>());
 
       m_modules.push_back(module_info);
+      Metrics::count(Metrics::ModulesDiscovered);
     }
   }
 
@@ -179,16 +188,50 @@ bool GonkModuleInterface::is_loaded() const
 }
 
 void GonkModuleInterface::load()
+{
+  TraceScope trace{ Tracer::Module, "load " + info.fullname };
+  MetricsTimer timer{ Metrics::ModuleLoadTime };
+
+  try
+  {
+    loadModule();
+  }
+  catch (const script::RuntimeError&)
+  {
+    // raised while running the module script
+    Metrics::count(Metrics::RuntimeErrors);
+    Metrics::count(Metrics::ModuleLoadFailures);
+    throw;
+  }
+  catch (...)
+  {
+    Metrics::count(Metrics::ModuleLoadFailures);
+    throw;
+  }
+
+  Metrics::count(Metrics::ModuleLoads);
+  loaded = true;
+}
+
+void GonkModuleInterface::loadModule()
 {
   loadDependencies();
-  loadPlugin();
 
-  plugin->load(script::Module(shared_from_this()));
+  {
+    TraceScope trace_plugin{ Tracer::Module, "plugin " + info.fullname };
+    loadPlugin();
+    plugin->load(script::Module(shared_from_this()));
+  }
 
-  loadChildren();
-  loadScript();
+  {
+    TraceScope trace_children{ Tracer::Module, "children " + info.fullname };
+    loadChildren();
+  }
 
-  loaded = true;
+  {
+    TraceScope trace_script{ Tracer::Module, "compile " + info.fullname };
+    loadScript();
+  }
 }
 
 void GonkModuleInterface::unload()
@@ -231,7 +274,48 @@ void GonkModuleInterface::loadScript()
   if (script.source().content().empty())
     return;
 
-  compile(script);
+  ModuleManager& manager = Gonk::Instance().moduleManager();
+
+  {
+    MetricsTimer timer{ Metrics::CompileTime };
+    LazyMembers::of(Gonk::Instance().scriptEngine()).demandSource(script.source().content());
+
+    try
+    {
+      if (manager.scriptCompileMode() == script::CompileMode::Release)
+      {
+        compile(script);
+      }
+      else if (!script.compile(manager.scriptCompileMode()))
+      {
+        Metrics::count(Metrics::CompileErrors);
+
+        std::string message = "Could not compile module script " + script.path();
+
+        for (const auto& m : script.messages())
+          message += "\n" + m.to_string();
+
+        throw script::ModuleLoadingError{ message };
+      }
+    }
+    catch (const NativeSignatureError& err)
+    {
+      // raised by the FunctionCreator of hybrid modules
+      Metrics::count(Metrics::CompileErrors);
+      throw script::ModuleLoadingError{ "Could not compile module script " + script.path() + "\n" + err.what() };
+    }
+    catch (const MemoizeError& err)
+    {
+      Metrics::count(Metrics::CompileErrors);
+      throw script::ModuleLoadingError{ "Could not compile module script " + script.path() + "\n" + err.what() };
+    }
+  }
+
+  Metrics::count(Metrics::ScriptsCompiled);
+
+  // module scripts must be listed even if none of their lines are executed
+  if (Coverage* coverage = Coverage::active())
+    coverage->addScript(script);
 }
 
 void GonkModuleInterface::loadChildren()
@@ -364,8 +448,26 @@ static void load_module(script::Engine& engine, std::vector<std::string>::const_
 
 void ModuleManager::loadModule(const std::string& name)
 {
+  Metrics::count(Metrics::ModuleImports);
+
   auto names = split_module_name(name);
   load_module(*m_script_engine, names.cbegin(), names.cend(), script::Module());
 }
 
+script::CompileMode ModuleManager::scriptCompileMode() const
+{
+  return m_script_compile_mode;
+}
+
+/*!
+ * \brief sets the mode used to compile the scripts of the modules loaded afterwards
+ *
+ * Instrumentation tools need the scripts of the modules to be compiled in
+ * debug mode.
+ */
+void ModuleManager::setScriptCompileMode(script::CompileMode mode)
+{
+  m_script_compile_mode = mode;
+}
+
 } // namespace gonk
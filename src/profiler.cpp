@@ -0,0 +1,325 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/profiler.h"
+
+#include <script/interpreter/executioncontext.h>
+#include <script/program/statements.h>
+#include <script/engine.h>
+#include <script/script.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+namespace gonk
+{
+
+static double to_ms(Profiler::clock::duration d)
+{
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+Profiler::Profiler()
+{
+  // root of the call tree
+  m_nodes.push_back(Node{ 0, 0 });
+}
+
+Profiler::~Profiler()
+{
+
+}
+
+void Profiler::interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info)
+{
+  const clock::time_point now = clock::now();
+
+  if (!m_stack.empty())
+  {
+    // the time since the previous breakpoint is charged to the previous top frame
+    const clock::duration elapsed = now - m_last;
+    const Frame& top = m_stack.back();
+    m_functions[top.function].exclusive += elapsed;
+    m_lines[top.line].exclusive += elapsed;
+    m_nodes[top.node].self += elapsed;
+    m_total += elapsed;
+  }
+
+  script::interpreter::Callstack& cs = call.executionContext()->callstack;
+  const size_t depth = cs.size();
+
+  size_t common = 0;
+
+  while (common < depth && common < m_stack.size()
+    && m_stack[common].call == cs[common] && m_stack[common].callee == cs[common]->callee().impl().get())
+  {
+    ++common;
+  }
+
+  // the slot of a returned call is reused by the next call at the same depth,
+  // reaching the entry breakpoint of the top frame again means a new call
+  if (common == depth && depth > 0 && m_stack[depth - 1].entry == &info)
+    common -= 1;
+
+  while (m_stack.size() > common)
+    pop(now);
+
+  for (size_t i(common); i < depth; ++i)
+    push(cs[i], cs[i]->last_breakpoint ? cs[i]->last_breakpoint->line : -1, now);
+
+  if (common < depth)
+    m_stack.back().entry = &info;
+
+  if (!m_stack.empty())
+  {
+    Frame& top = m_stack.back();
+    setLine(top, lineIndex(top.function, info.line), now);
+    m_lines[top.line].hits += 1;
+  }
+
+  m_last = clock::now();
+}
+
+void Profiler::stop()
+{
+  const clock::time_point now = clock::now();
+
+  if (!m_stack.empty())
+  {
+    const clock::duration elapsed = now - m_last;
+    const Frame& top = m_stack.back();
+    m_functions[top.function].exclusive += elapsed;
+    m_lines[top.line].exclusive += elapsed;
+    m_nodes[top.node].self += elapsed;
+    m_total += elapsed;
+  }
+
+  while (!m_stack.empty())
+    pop(now);
+}
+
+const std::vector<Profiler::FunctionStats>& Profiler::functions() const
+{
+  return m_functions;
+}
+
+const std::vector<Profiler::LineStats>& Profiler::lines() const
+{
+  return m_lines;
+}
+
+size_t Profiler::functionIndex(const script::Function& f)
+{
+  auto it = m_function_indexes.find(f.impl().get());
+
+  if (it != m_function_indexes.end())
+    return it->second;
+
+  FunctionStats stats;
+  stats.function = f;
+  stats.name = f.engine()->toString(f);
+  stats.path = f.script().isNull() ? std::string() : f.script().path();
+
+  m_functions.push_back(stats);
+  m_function_indexes[f.impl().get()] = m_functions.size() - 1;
+  return m_functions.size() - 1;
+}
+
+size_t Profiler::lineIndex(size_t function, int line)
+{
+  const uint64_t key = (static_cast<uint64_t>(function) << 32) | static_cast<uint32_t>(line);
+  auto it = m_line_indexes.find(key);
+
+  if (it != m_line_indexes.end())
+    return it->second;
+
+  LineStats stats;
+  stats.function = function;
+  stats.line = line;
+
+  m_lines.push_back(stats);
+  m_line_indexes[key] = m_lines.size() - 1;
+  return m_lines.size() - 1;
+}
+
+size_t Profiler::childNode(size_t parent, size_t function)
+{
+  auto it = m_nodes[parent].children.find(function);
+
+  if (it != m_nodes[parent].children.end())
+    return it->second;
+
+  m_nodes.push_back(Node{ parent, function });
+  m_nodes[parent].children[function] = m_nodes.size() - 1;
+  return m_nodes.size() - 1;
+}
+
+void Profiler::push(script::interpreter::FunctionCall* call, int line, clock::time_point now)
+{
+  Frame frame;
+  frame.call = call;
+  frame.callee = call->callee().impl().get();
+  frame.function = functionIndex(call->callee());
+  frame.line = lineIndex(frame.function, line);
+  frame.node = childNode(m_stack.empty() ? 0 : m_stack.back().node, frame.function);
+  frame.entry = nullptr;
+
+  // recursive calls are only counted once in the inclusive time
+  FunctionStats& f = m_functions[frame.function];
+  f.calls += 1;
+
+  if (f.active++ == 0)
+    f.start = now;
+
+  LineStats& l = m_lines[frame.line];
+
+  if (l.active++ == 0)
+    l.start = now;
+
+  m_stack.push_back(frame);
+}
+
+void Profiler::pop(clock::time_point now)
+{
+  const Frame& frame = m_stack.back();
+
+  FunctionStats& f = m_functions[frame.function];
+
+  if (--f.active == 0)
+    f.inclusive += now - f.start;
+
+  LineStats& l = m_lines[frame.line];
+
+  if (--l.active == 0)
+    l.inclusive += now - l.start;
+
+  m_stack.pop_back();
+}
+
+void Profiler::setLine(Frame& frame, size_t line, clock::time_point now)
+{
+  if (frame.line == line)
+    return;
+
+  LineStats& prev = m_lines[frame.line];
+
+  if (--prev.active == 0)
+    prev.inclusive += now - prev.start;
+
+  LineStats& next = m_lines[line];
+
+  if (next.active++ == 0)
+    next.start = now;
+
+  frame.line = line;
+}
+
+void Profiler::writeReport(std::ostream& out) const
+{
+  const double total = to_ms(m_total);
+
+  auto percent = [total](clock::duration d) -> double {
+    return total > 0 ? 100.0 * to_ms(d) / total : 0.0;
+  };
+
+  std::vector<size_t> functions(m_functions.size());
+
+  for (size_t i(0); i < functions.size(); ++i)
+    functions[i] = i;
+
+  std::sort(functions.begin(), functions.end(), [this](size_t a, size_t b) {
+    return m_functions[a].exclusive > m_functions[b].exclusive;
+    });
+
+  out << std::fixed << std::setprecision(3);
+
+  out << "Total: " << total << " ms" << std::endl;
+  out << std::endl;
+
+  out << "Functions (sorted by exclusive time)" << std::endl;
+  out << std::setw(12) << "excl (ms)" << std::setw(8) << "excl %" << std::setw(12) << "incl (ms)" << std::setw(8) << "incl %" << std::setw(10) << "calls" << "  function" << std::endl;
+
+  for (size_t i : functions)
+  {
+    const FunctionStats& f = m_functions[i];
+
+    out << std::setw(12) << to_ms(f.exclusive) << std::setw(8) << std::setprecision(1) << percent(f.exclusive)
+      << std::setw(12) << std::setprecision(3) << to_ms(f.inclusive) << std::setw(8) << std::setprecision(1) << percent(f.inclusive)
+      << std::setw(10) << f.calls << "  " << f.name;
+
+    if (!f.path.empty())
+      out << " [" << f.path << "]";
+
+    out << std::setprecision(3) << std::endl;
+  }
+
+  std::vector<size_t> lines;
+
+  for (size_t i(0); i < m_lines.size(); ++i)
+  {
+    if (m_lines[i].hits > 0)
+      lines.push_back(i);
+  }
+
+  std::sort(lines.begin(), lines.end(), [this](size_t a, size_t b) {
+    return m_lines[a].exclusive > m_lines[b].exclusive;
+    });
+
+  out << std::endl;
+  out << "Lines (sorted by exclusive time)" << std::endl;
+  out << std::setw(12) << "excl (ms)" << std::setw(8) << "excl %" << std::setw(12) << "incl (ms)" << std::setw(10) << "hits" << "  location" << std::endl;
+
+  for (size_t i : lines)
+  {
+    const LineStats& l = m_lines[i];
+    const FunctionStats& f = m_functions[l.function];
+
+    // lines are 0-based in the program
+    out << std::setw(12) << to_ms(l.exclusive) << std::setw(8) << std::setprecision(1) << percent(l.exclusive)
+      << std::setw(12) << std::setprecision(3) << to_ms(l.inclusive)
+      << std::setw(10) << l.hits << "  " << f.path << ":" << (l.line + 1) << " (" << f.name << ")" << std::endl;
+  }
+
+  out << std::defaultfloat;
+}
+
+std::string Profiler::collapsedStack(size_t node) const
+{
+  std::vector<size_t> path;
+
+  for (; node != 0; node = m_nodes[node].parent)
+    path.push_back(m_nodes[node].function);
+
+  std::string result;
+
+  for (auto it = path.rbegin(); it != path.rend(); ++it)
+  {
+    if (!result.empty())
+      result += ';';
+
+    // ';' separates frames and ' ' the sample count in the collapsed format
+    std::string name = m_functions[*it].name;
+    std::replace(name.begin(), name.end(), ';', ',');
+    std::replace(name.begin(), name.end(), ' ', '_');
+    result += name;
+  }
+
+  return result;
+}
+
+void Profiler::writeCollapsedStacks(std::ostream& out) const
+{
+  // one line per call path with the exclusive time in microseconds,
+  // as expected by flamegraph.pl and speedscope
+  for (size_t i(1); i < m_nodes.size(); ++i)
+  {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(m_nodes[i].self).count();
+
+    if (us > 0)
+      out << collapsedStack(i) << " " << us << "\n";
+  }
+}
+
+} // namespace gonk
@@ -0,0 +1,256 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/sampling-profiler.h"
+
+#include <script/interpreter/executioncontext.h>
+#include <script/program/statements.h>
+#include <script/engine.h>
+#include <script/script.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+namespace gonk
+{
+
+SamplingProfiler::SamplingProfiler(int frequency)
+  : m_frequency(std::min(std::max(1, frequency), MaxFrequency)),
+    m_ring(new Sample[RingSize])
+{
+
+}
+
+SamplingProfiler::~SamplingProfiler()
+{
+  stop();
+}
+
+int SamplingProfiler::frequency() const
+{
+  return m_frequency;
+}
+
+void SamplingProfiler::start()
+{
+  if (m_running.exchange(true))
+    return;
+
+  m_watcher = std::thread([this]() {
+    run();
+    });
+}
+
+void SamplingProfiler::stop()
+{
+  if (!m_running.exchange(false))
+    return;
+
+  if (m_watcher.joinable())
+    m_watcher.join();
+
+  drain();
+}
+
+void SamplingProfiler::interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info)
+{
+  if (!m_sample_requested.load(std::memory_order_relaxed))
+    return;
+
+  m_sample_requested.store(false, std::memory_order_relaxed);
+  capture(call, info);
+}
+
+size_t SamplingProfiler::sampleCount() const
+{
+  return m_samples;
+}
+
+size_t SamplingProfiler::droppedSamples() const
+{
+  return m_dropped.load();
+}
+
+void SamplingProfiler::capture(script::interpreter::FunctionCall& call, script::program::Breakpoint& info)
+{
+  const size_t head = m_head.load(std::memory_order_relaxed);
+
+  if (head - m_tail.load(std::memory_order_acquire) >= RingSize)
+  {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  Sample& sample = m_ring[head % RingSize];
+
+  script::interpreter::Callstack& cs = call.executionContext()->callstack;
+  const size_t depth = cs.size();
+  const size_t first = depth > MaxDepth ? depth - MaxDepth : 0;
+
+  sample.depth = depth - first;
+  sample.truncated = first > 0;
+
+  for (size_t i(first); i < depth; ++i)
+  {
+    const script::Function& f = cs[i]->callee();
+    const void* key = f.impl().get();
+
+    // names are resolved at the end, on this thread
+    if (m_functions.find(key) == m_functions.end())
+      m_functions[key] = f;
+
+    Frame& frame = sample.frames[i - first];
+    frame.function = key;
+    frame.line = cs[i]->last_breakpoint ? cs[i]->last_breakpoint->line : -1;
+  }
+
+  if (sample.depth > 0)
+    sample.frames[sample.depth - 1].line = info.line;
+
+  m_head.store(head + 1, std::memory_order_release);
+}
+
+void SamplingProfiler::run()
+{
+  const auto period = std::chrono::microseconds(1000000 / m_frequency);
+  auto next = std::chrono::steady_clock::now() + period;
+
+  while (m_running.load())
+  {
+    std::this_thread::sleep_until(next);
+    next += period;
+
+    m_sample_requested.store(true, std::memory_order_relaxed);
+    drain();
+  }
+}
+
+void SamplingProfiler::drain()
+{
+  size_t tail = m_tail.load(std::memory_order_relaxed);
+  const size_t head = m_head.load(std::memory_order_acquire);
+
+  std::vector<Frame> key;
+
+  for (; tail != head; ++tail)
+  {
+    const Sample& sample = m_ring[tail % RingSize];
+
+    key.clear();
+
+    if (sample.truncated)
+      key.push_back(Frame());
+
+    key.insert(key.end(), sample.frames.begin(), sample.frames.begin() + sample.depth);
+
+    m_histogram[key] += 1;
+    m_samples += 1;
+  }
+
+  m_tail.store(tail, std::memory_order_release);
+}
+
+std::string SamplingProfiler::functionName(const void* f) const
+{
+  auto it = m_functions.find(f);
+
+  if (it == m_functions.end())
+    return "[truncated]";
+
+  return it->second.engine()->toString(it->second);
+}
+
+void SamplingProfiler::writeReport(std::ostream& out) const
+{
+  // self samples per function and per line
+  std::map<const void*, size_t> functions;
+  std::map<Frame, size_t> lines;
+
+  for (const auto& entry : m_histogram)
+  {
+    if (entry.first.empty())
+      continue;
+
+    functions[entry.first.back().function] += entry.second;
+    lines[entry.first.back()] += entry.second;
+  }
+
+  auto percent = [this](size_t n) -> double {
+    return m_samples > 0 ? 100.0 * static_cast<double>(n) / static_cast<double>(m_samples) : 0.0;
+  };
+
+  std::vector<std::pair<const void*, size_t>> sorted_functions{ functions.begin(), functions.end() };
+  std::sort(sorted_functions.begin(), sorted_functions.end(), [](const auto& a, const auto& b) {
+    return a.second > b.second;
+    });
+
+  std::vector<std::pair<Frame, size_t>> sorted_lines{ lines.begin(), lines.end() };
+  std::sort(sorted_lines.begin(), sorted_lines.end(), [](const auto& a, const auto& b) {
+    return a.second > b.second;
+    });
+
+  out << "Samples: " << m_samples << " at " << m_frequency << " Hz";
+
+  if (droppedSamples() > 0)
+    out << " (" << droppedSamples() << " dropped)";
+
+  out << std::endl << std::endl;
+
+  out << std::fixed << std::setprecision(1);
+
+  out << "Functions (self samples)" << std::endl;
+
+  for (const auto& e : sorted_functions)
+    out << std::setw(10) << e.second << std::setw(8) << percent(e.second) << "%  " << functionName(e.first) << std::endl;
+
+  out << std::endl;
+  out << "Lines (self samples)" << std::endl;
+
+  for (const auto& e : sorted_lines)
+  {
+    auto it = m_functions.find(e.first.function);
+    std::string path = (it == m_functions.end() || it->second.script().isNull()) ? std::string() : it->second.script().path();
+
+    // lines are 0-based in the program
+    out << std::setw(10) << e.second << std::setw(8) << percent(e.second) << "%  "
+      << path << ":" << (e.first.line + 1) << " (" << functionName(e.first.function) << ")" << std::endl;
+  }
+
+  out << std::defaultfloat;
+}
+
+void SamplingProfiler::writeCollapsedStacks(std::ostream& out) const
+{
+  std::unordered_map<const void*, std::string> names;
+
+  for (const auto& entry : m_histogram)
+  {
+    std::string line;
+
+    for (const Frame& frame : entry.first)
+    {
+      auto it = names.find(frame.function);
+
+      if (it == names.end())
+      {
+        // ';' separates frames and ' ' the sample count in the collapsed format
+        std::string name = functionName(frame.function);
+        std::replace(name.begin(), name.end(), ';', ',');
+        std::replace(name.begin(), name.end(), ' ', '_');
+        it = names.emplace(frame.function, name).first;
+      }
+
+      if (!line.empty())
+        line += ';';
+
+      line += it->second;
+    }
+
+    out << line << " " << entry.second << "\n";
+  }
+}
+
+} // namespace gonk
@@ -0,0 +1,247 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/script-bench.h"
+
+#include <script/ast/node.h>
+#include <script/engine.h>
+#include <script/interpreter/interpreter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace gonk
+{
+
+// returns true if attr is [[bench]] or [[bench("name")]]
+static bool is_bench_attr(const script::Attribute& attr, std::string& name)
+{
+  if (attr->is<script::ast::SimpleIdentifier>())
+  {
+    return attr->as<script::ast::SimpleIdentifier>().source().toString() == "bench";
+  }
+  else if (attr->is<script::ast::FunctionCall>())
+  {
+    const auto& fcall = attr->as<script::ast::FunctionCall>();
+
+    if (fcall.callee->source().toString() != "bench" || fcall.arguments.size() != 1 || !fcall.arguments.at(0)->is<script::ast::StringLiteral>())
+      return false;
+
+    const auto& strliteral = fcall.arguments.front()->as<script::ast::StringLiteral>();
+    name = strliteral.source().toString();
+    name = std::string(name.begin() + 1, name.end() - 1);
+
+    return true;
+  }
+
+  return false;
+}
+
+ScriptBench::ScriptBench()
+{
+
+}
+
+script::Function ScriptBench::create(script::FunctionBlueprint& blueprint, const std::shared_ptr<script::ast::FunctionDecl>& fdecl, std::vector<script::Attribute>& attrs)
+{
+  script::Function f = MemoizeCreator::create(blueprint, fdecl, attrs);
+
+  for (const script::Attribute& attr : attrs)
+  {
+    std::string name;
+
+    if (!is_bench_attr(attr, name))
+      continue;
+
+    if (f.prototype().size() != 0)
+      throw BenchError("[[bench]] function " + f.name() + " must not take any parameter");
+
+    Entry e;
+    e.name = name.empty() ? f.name() : name;
+    e.function = f;
+    m_entries.push_back(e);
+
+    break;
+  }
+
+  return f;
+}
+
+const std::vector<ScriptBench::Entry>& ScriptBench::entries() const
+{
+  return m_entries;
+}
+
+void ScriptBench::setFilter(const std::string& filter)
+{
+  m_filter = filter;
+}
+
+void ScriptBench::setRepetitions(int n)
+{
+  m_repetitions = std::max(n, 1);
+}
+
+void ScriptBench::setSampleTime(std::chrono::milliseconds t)
+{
+  m_sample_time = t;
+}
+
+std::chrono::nanoseconds ScriptBench::sampleTime() const
+{
+  return m_sample_time;
+}
+
+BenchResult ScriptBench::run(const Entry& entry) const
+{
+  using clock = std::chrono::steady_clock;
+
+  BenchResult result;
+  result.name = entry.name;
+  result.repetitions = m_repetitions;
+
+  // the results are not used, but they must be released
+  script::Engine* e = entry.function.engine();
+  const script::Type rtype = entry.function.returnType();
+  const bool owns_result = rtype.baseType() != script::Type::Void && !rtype.isReference();
+
+  auto call = [&entry, e, owns_result]() {
+    script::Value ret = entry.function.invoke({});
+
+    if (owns_result)
+      e->destroy(ret);
+  };
+
+  // warm-up, also gives a first estimate of the cost of a call
+  uint64_t calls = 0;
+  auto start = clock::now();
+  auto elapsed = clock::duration::zero();
+
+  do
+  {
+    call();
+    ++calls;
+    elapsed = clock::now() - start;
+  } while (elapsed < m_sample_time);
+
+  const double ns_per_call = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(calls);
+  result.iterations = std::max<uint64_t>(1, static_cast<uint64_t>(static_cast<double>(m_sample_time.count()) / ns_per_call));
+
+  std::vector<double> samples;
+  samples.reserve(m_repetitions);
+
+  for (int rep(0); rep < m_repetitions; ++rep)
+  {
+    start = clock::now();
+
+    for (uint64_t i(0); i < result.iterations; ++i)
+      call();
+
+    samples.push_back(std::chrono::duration<double, std::nano>(clock::now() - start).count() / static_cast<double>(result.iterations));
+  }
+
+  std::sort(samples.begin(), samples.end());
+
+  double total = 0;
+  for (double s : samples)
+    total += s;
+
+  auto percentile = [&samples](double p) -> double {
+    size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(samples.size())));
+    return samples.at(std::min(samples.size(), std::max<size_t>(rank, 1)) - 1);
+  };
+
+  // with a few dozen repetitions a high percentile is just the slowest one
+  result.mean = total / static_cast<double>(samples.size());
+  result.median = percentile(0.5);
+  result.max = samples.back();
+  result.ops_per_second = result.mean > 0 ? 1e9 / result.mean : 0;
+
+  return result;
+}
+
+int ScriptBench::runAll(std::ostream& out)
+{
+  if (m_entries.empty())
+  {
+    std::cerr << "no [[bench]] function found" << std::endl;
+    return 1;
+  }
+
+  int failures = 0;
+
+  writeHeader(out);
+
+  for (const Entry& e : m_entries)
+  {
+    if (!m_filter.empty() && e.name.find(m_filter) == std::string::npos)
+      continue;
+
+    try
+    {
+      BenchResult r = run(e);
+      writeResult(out, r);
+      m_results.push_back(r);
+    }
+    catch (script::RuntimeError& err)
+    {
+      std::cerr << e.name << ": " << err.message << std::endl;
+      ++failures;
+    }
+    catch (std::exception& ex)
+    {
+      std::cerr << e.name << ": " << ex.what() << std::endl;
+      ++failures;
+    }
+  }
+
+  return failures > 0 ? 1 : 0;
+}
+
+const std::vector<BenchResult>& ScriptBench::results() const
+{
+  return m_results;
+}
+
+static std::string format_duration(double ns)
+{
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(ns < 1e3 ? 1 : 2);
+
+  if (ns < 1e3)
+    ss << ns << " ns";
+  else if (ns < 1e6)
+    ss << (ns / 1e3) << " us";
+  else if (ns < 1e9)
+    ss << (ns / 1e6) << " ms";
+  else
+    ss << (ns / 1e9) << " s";
+
+  return ss.str();
+}
+
+void ScriptBench::writeHeader(std::ostream& out)
+{
+  out << std::left << std::setw(32) << "benchmark" << std::right
+    << std::setw(14) << "iterations"
+    << std::setw(14) << "mean"
+    << std::setw(14) << "median"
+    << std::setw(14) << "max"
+    << std::setw(16) << "ops/s" << std::endl;
+}
+
+void ScriptBench::writeResult(std::ostream& out, const BenchResult& r)
+{
+  out << std::left << std::setw(32) << r.name << std::right
+    << std::setw(14) << (std::to_string(r.repetitions) + "x" + std::to_string(r.iterations))
+    << std::setw(14) << format_duration(r.mean)
+    << std::setw(14) << format_duration(r.median)
+    << std::setw(14) << format_duration(r.max)
+    << std::setw(16) << static_cast<uint64_t>(r.ops_per_second) << std::endl;
+}
+
+} // namespace gonk
@@ -4,12 +4,24 @@
 
 #include "gonk/script-runner.h"
 
+#include "gonk/copy-audit.h"
+#include "gonk/coverage.h"
 #include "gonk/gonk.h"
+#include "gonk/instrumentation.h"
+#include "gonk/lazy-members.h"
+#include "gonk/memoize.h"
+#include "gonk/memstats.h"
+#include "gonk/metrics.h"
 #include "gonk/modules.h"
+#include "gonk/profiler.h"
+#include "gonk/sampling-profiler.h"
+#include "gonk/script-bench.h"
+#include "gonk/tracer.h"
 
 #include <script/class.h>
 #include <script/classtemplate.h>
 #include <script/engine.h>
+#include <script/interpreter/interpreter.h>
 #include <script/module.h>
 #include <script/namelookup.h>
 #include <script/script.h>
@@ -30,16 +42,52 @@ ScriptRunner::ScriptRunner(Gonk& gnk)
 
 int ScriptRunner::run()
 {
-  return runScript();
+  if (instrumented() && m_gonk.cli().debug)
+  {
+    std::cerr << "--profile, --sample-profile, --trace, --coverage and --copy-audit cannot be used together with --debug" << std::endl;
+    return 1;
+  }
+
+  if (m_gonk.cli().memstats)
+    memstats::setEnabled(true);
+
+  int result = runScript();
+
+  if (m_debug_handlers)
+    m_gonk.scriptEngine()->interpreter()->setDebugHandler(nullptr);
+
+  if (m_profiler)
+    writeProfile();
+
+  if (m_sampling_profiler)
+    writeSamplingProfile();
+
+  if (m_tracer)
+    writeTrace();
+
+  if (m_coverage)
+    writeCoverage();
+
+  if (m_copy_audit)
+    writeCopyAudit();
+
+  if (m_gonk.cli().memstats)
+    memstats::write_report(std::cerr, *m_gonk.scriptEngine());
+
+  return result;
 }
 
 int ScriptRunner::runScript()
 {
-  if (m_gonk.cli().debug || m_gonk.cli().debugbuild)
+  // instrumentation relies on the breakpoints inserted in debug mode
+  if (m_gonk.cli().debug || m_gonk.cli().debugbuild || instrumented())
   {
     m_mode = script::CompileMode::Debug;
   }
 
+  if (instrumented())
+    m_gonk.moduleManager().setScriptCompileMode(script::CompileMode::Debug);
+
   std::string path = m_gonk.cli().script.value();
 
   {
@@ -60,10 +108,57 @@ int ScriptRunner::runScript()
     return 1;
   }
 
+  // started before compiling to capture the loading of the imported modules
+  if (m_gonk.cli().trace.has_value())
+    startTracer();
+
+  if (m_gonk.cli().coverage.has_value())
+    startCoverage();
+
+  if (m_gonk.cli().copy_audit)
+    startCopyAudit();
+
   script::Script s = m_gonk.scriptEngine()->newScript(src);
 
-  if (!s.compile(m_mode))
+  if (m_gonk.cli().bench)
+  {
+    m_bench = std::make_shared<ScriptBench>();
+    s.attach(*m_bench);
+  }
+  else
+  {
+    m_memoize = std::make_shared<MemoizeCreator>();
+    s.attach(*m_memoize);
+  }
+
+  bool compiled = false;
+
+  {
+    MetricsTimer timer{ Metrics::CompileTime };
+    gonk::LazyMembers::of(m_gonk.scriptEngine()).demandSource(src.content());
+
+    try
+    {
+      compiled = s.compile(m_mode);
+    }
+    catch (const MemoizeError& err)
+    {
+      std::cerr << err.what() << std::endl;
+      Metrics::count(Metrics::CompileErrors);
+      return -1;
+    }
+    catch (const BenchError& err)
+    {
+      std::cerr << err.what() << std::endl;
+      Metrics::count(Metrics::CompileErrors);
+      return -1;
+    }
+  }
+
+  if (!compiled)
   {
+    Metrics::count(Metrics::CompileErrors);
+
     for (const auto& e : s.messages())
     {
       std::cerr << e.to_string() << std::endl;
@@ -72,6 +167,11 @@ int ScriptRunner::runScript()
     return -1;
   }
 
+  Metrics::count(Metrics::ScriptsCompiled);
+
+  if (m_coverage)
+    m_coverage->addScript(s);
+
   if (m_gonk.cli().debug)
   {
     script::Module debugger_module = m_gonk.moduleManager().getModule("gonk.debugger");
@@ -80,12 +180,23 @@ int ScriptRunner::runScript()
       debugger_module.load();
   }
 
+  if (m_gonk.cli().profile.has_value())
+    startProfiler();
+
+  if (m_gonk.cli().sample_profile.has_value())
+    startSamplingProfiler();
+
+  Metrics::count(Metrics::ScriptsRun);
+  MetricsTimer timer{ Metrics::RunTime };
+
   try
   {
     s.run();
   }
   catch (script::RuntimeError& err)
   {
+    Metrics::count(Metrics::RuntimeErrors);
+    Metrics::count(Metrics::UncaughtErrors);
     std::cerr << err.message << std::endl;
     return 1;
   }
@@ -95,6 +206,13 @@ int ScriptRunner::runScript()
     return 1;
   }
 
+  // do not charge the time spent between the two calls to the script
+  if (m_profiler)
+    m_profiler->stop();
+
+  if (m_bench)
+    return runBenchmarks();
+
   return invokeMain(s);
 }
 
@@ -190,6 +308,123 @@ script::Value ScriptRunner::invokeMain(const script::Function& f)
   return f.invoke({args});
 }
 
+bool ScriptRunner::instrumented() const
+{
+  const CLI& cli = m_gonk.cli();
+  return cli.profile.has_value() || cli.sample_profile.has_value() || cli.trace.has_value() || cli.coverage.has_value() || cli.copy_audit;
+}
+
+void ScriptRunner::installDebugHandler(std::shared_ptr<script::interpreter::DebugHandler> handler)
+{
+  if (!m_debug_handlers)
+  {
+    m_debug_handlers = std::make_shared<DebugHandlerList>();
+    m_gonk.scriptEngine()->interpreter()->setDebugHandler(m_debug_handlers);
+  }
+
+  m_debug_handlers->add(handler);
+}
+
+void ScriptRunner::startProfiler()
+{
+  m_profiler = std::make_shared<Profiler>();
+  installDebugHandler(m_profiler);
+}
+
+void ScriptRunner::writeProfile()
+{
+  m_profiler->stop();
+
+  const std::string prefix = m_gonk.cli().profile.value();
+
+  {
+    std::ofstream file{ prefix + ".txt" };
+    m_profiler->writeReport(file);
+  }
+
+  {
+    std::ofstream file{ prefix + ".folded" };
+    m_profiler->writeCollapsedStacks(file);
+  }
+
+  std::cerr << "profile written to " << prefix << ".txt and " << prefix << ".folded" << std::endl;
+}
+
+void ScriptRunner::startSamplingProfiler()
+{
+  m_sampling_profiler = std::make_shared<SamplingProfiler>(m_gonk.cli().sample_profile.value());
+  installDebugHandler(m_sampling_profiler);
+  m_sampling_profiler->start();
+}
+
+void ScriptRunner::writeSamplingProfile()
+{
+  m_sampling_profiler->stop();
+
+  const std::string& prefix = m_gonk.cli().sample_profile_output;
+
+  {
+    std::ofstream file{ prefix + ".txt" };
+    m_sampling_profiler->writeReport(file);
+  }
+
+  {
+    std::ofstream file{ prefix + ".folded" };
+    m_sampling_profiler->writeCollapsedStacks(file);
+  }
+
+  std::cerr << m_sampling_profiler->sampleCount() << " samples written to " << prefix << ".txt and " << prefix << ".folded" << std::endl;
+}
+
+void ScriptRunner::startTracer()
+{
+  m_tracer = std::make_shared<Tracer>();
+  m_tracer->start();
+  installDebugHandler(m_tracer);
+}
+
+void ScriptRunner::writeTrace()
+{
+  m_tracer->stop();
+
+  const std::string& path = m_gonk.cli().trace.value();
+
+  if (m_tracer->save(path))
+    std::cerr << "trace written to " << path << " (" << m_tracer->events().size() << " events)" << std::endl;
+  else
+    std::cerr << "could not write trace to " << path << std::endl;
+}
+
+void ScriptRunner::startCoverage()
+{
+  m_coverage = std::make_shared<Coverage>(m_gonk.cli().coverage_counts);
+  m_coverage->start();
+  installDebugHandler(m_coverage);
+}
+
+void ScriptRunner::writeCoverage()
+{
+  m_coverage->stop();
+
+  const std::string& path = m_gonk.cli().coverage.value();
+
+  if (!m_coverage->save(path))
+    std::cerr << "could not write coverage to " << path << std::endl;
+}
+
+void ScriptRunner::startCopyAudit()
+{
+  m_copy_audit = std::make_shared<CopyAudit>();
+  m_copy_audit->start();
+  installDebugHandler(m_copy_audit);
+}
+
+void ScriptRunner::writeCopyAudit()
+{
+  m_copy_audit->stop();
+  m_copy_audit->writeReport(std::cerr, *m_gonk.scriptEngine());
+}
+
 int ScriptRunner::invokeMain(const script::Script& s)
 {
   script::Function func = findMain(s);
@@ -206,6 +441,8 @@ int ScriptRunner::invokeMain(const script::Script& s)
   }
   catch (script::RuntimeError& err)
   {
+    Metrics::count(Metrics::RuntimeErrors);
+    Metrics::count(Metrics::UncaughtErrors);
     std::cerr << err.message << std::endl;
     return 1;
   }
@@ -218,5 +455,12 @@ int ScriptRunner::invokeMain(const script::Script& s)
   return 0;
 }
 
+int ScriptRunner::runBenchmarks()
+{
+  if (m_gonk.cli().bench_filter.has_value())
+    m_bench->setFilter(m_gonk.cli().bench_filter.value());
+
+  return m_bench->runAll(std::cout);
+}
 
 } // namespace gonk
@@ -6,11 +6,17 @@
 
 #include <script/class.h>
 #include <script/classtemplate.h>
+#include <script/classtemplateinstancebuilder.h>
 #include <script/engine.h>
+#include <script/functionbuilder.h>
+#include <script/interpreter/executioncontext.h>
 #include <script/namespace.h>
+#include <script/operator.h>
 #include <script/templatebuilder.h>
 #include <script/typesystem.h>
 
+#include <functional>
+
 namespace gonk
 {
 
@@ -28,9 +34,174 @@ void register_pointer_template(script::Namespace ns)
     .get();
 }
 
+namespace pointer_template
+{
+
+namespace callbacks
+{
+
+static script::Value construct(script::FunctionCall* c, ValuePointer ptr)
+{
+  c->thisObject() = script::Value(new script::CppValue<ValuePointer>(c->engine(), c->callee().parameter(0).baseType(), std::move(ptr)));
+  return c->thisObject();
+}
+
+// Pointer<T>();
+static script::Value default_ctor(script::FunctionCall* c)
+{
+  return construct(c, ValuePointer());
+}
+
+// Pointer<T>(const Pointer<T>& other);
+static script::Value copy_ctor(script::FunctionCall* c)
+{
+  return construct(c, script::get<ValuePointer>(c->arg(1)));
+}
+
+// Pointer<T>(T& target);
+static script::Value ctor_ref(script::FunctionCall* c)
+{
+  return construct(c, ValuePointer{ c->arg(1) });
+}
+
+// ~Pointer<T>();
+static script::Value dtor(script::FunctionCall* c)
+{
+  c->thisObject().destroy<ValuePointer>();
+  return script::Value::Void;
+}
+
+// Pointer<T>& operator=(const Pointer<T>& other);
+static script::Value op_assign(script::FunctionCall* c)
+{
+  script::get<ValuePointer>(c->arg(0)) = script::get<ValuePointer>(c->arg(1));
+  return c->arg(0);
+}
+
+// T& get() const;
+static script::Value get(script::FunctionCall* c)
+{
+  const ValuePointer& self = script::get<ValuePointer>(c->arg(0));
+
+  if (self.target.isNull())
+    throw script::RuntimeError{ "bad pointer access" };
+
+  return self.target;
+}
+
+// bool isNull() const;
+static script::Value is_null(script::FunctionCall* c)
+{
+  return c->engine()->newBool(script::get<ValuePointer>(c->arg(0)).target.isNull());
+}
+
+// void reset();
+static script::Value reset(script::FunctionCall* c)
+{
+  script::get<ValuePointer>(c->arg(0)).target = script::Value();
+  return script::Value::Void;
+}
+
+// two pointers are equal if they reference the same value
+static bool same_target(script::FunctionCall* c)
+{
+  return script::get<ValuePointer>(c->arg(0)).target.impl() == script::get<ValuePointer>(c->arg(1)).target.impl();
+}
+
+// bool operator==(const Pointer<T>& other) const;
+static script::Value eq(script::FunctionCall* c)
+{
+  return c->engine()->newBool(same_target(c));
+}
+
+// bool operator!=(const Pointer<T>& other) const;
+static script::Value neq(script::FunctionCall* c)
+{
+  return c->engine()->newBool(!same_target(c));
+}
+
+// bool operator<(const Pointer<T>& other) const;
+static script::Value less(script::FunctionCall* c)
+{
+  const ValuePointer& self = script::get<ValuePointer>(c->arg(0));
+  const ValuePointer& other = script::get<ValuePointer>(c->arg(1));
+  return c->engine()->newBool(std::less<>()(self.target.impl(), other.target.impl()));
+}
+
+} // namespace callbacks
+
+static void fill_instance(script::Class& c, script::Type t)
+{
+  // Pointer<T>();
+  script::FunctionBuilder::Constructor(c).setCallback(callbacks::default_ctor).create();
+  // Pointer<T>(const Pointer<T>& other);
+  script::FunctionBuilder::Constructor(c).setCallback(callbacks::copy_ctor)
+    .params(script::Type::cref(c.id())).create();
+  // Pointer<T>(T& target);
+  script::FunctionBuilder::Constructor(c).setCallback(callbacks::ctor_ref)
+    .params(script::Type::ref(t)).create();
+  // ~Pointer<T>();
+  script::FunctionBuilder::Destructor(c).setCallback(callbacks::dtor).create();
+
+  // Pointer<T>& operator=(const Pointer<T>& other);
+  script::FunctionBuilder::Op(c, script::AssignmentOperator).setCallback(callbacks::op_assign)
+    .returns(script::Type::ref(c.id()))
+    .params(script::Type::cref(c.id()))
+    .create();
+
+  // T& get() const;
+  script::FunctionBuilder::Fun(c, "get").setCallback(callbacks::get)
+    .returns(script::Type::ref(t))
+    .setConst()
+    .create();
+  // operator T&() const;
+  script::FunctionBuilder::Cast(c).setCallback(callbacks::get)
+    .returns(script::Type::ref(t))
+    .setConst()
+    .create();
+
+  // bool isNull() const;
+  script::FunctionBuilder::Fun(c, "isNull").setCallback(callbacks::is_null)
+    .returns(script::Type::Boolean)
+    .setConst()
+    .create();
+  // void reset();
+  script::FunctionBuilder::Fun(c, "reset").setCallback(callbacks::reset)
+    .create();
+
+  // bool operator==(const Pointer<T>& other) const;
+  script::FunctionBuilder::Op(c, script::EqualOperator).setCallback(callbacks::eq)
+    .returns(script::Type::Boolean)
+    .params(script::Type::cref(c.id()))
+    .setConst()
+    .create();
+  // bool operator!=(const Pointer<T>& other) const;
+  script::FunctionBuilder::Op(c, script::InequalOperator).setCallback(callbacks::neq)
+    .returns(script::Type::Boolean)
+    .params(script::Type::cref(c.id()))
+    .setConst()
+    .create();
+  // bool operator<(const Pointer<T>& other) const, orders pointers by the
+  // address of their target so that they can be stored in containers
+  script::FunctionBuilder::Op(c, script::LessOperator).setCallback(callbacks::less)
+    .returns(script::Type::Boolean)
+    .params(script::Type::cref(c.id()))
+    .setConst()
+    .create();
+}
+
+} // namespace pointer_template
+
 script::Class PointerTemplate::instantiate(script::ClassTemplateInstanceBuilder& builder)
 {
-  return script::Class{};
+  builder.setFinal();
+  const script::Type target_type = builder.arguments().front().type.baseType();
+
+  script::Class ptr = builder.get();
+
+  pointer_template::fill_instance(ptr, target_type);
+
+  return ptr;
 }
 
 } // namespace gonk
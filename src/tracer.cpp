@@ -0,0 +1,226 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "gonk/tracer.h"
+
+#include <script/interpreter/executioncontext.h>
+#include <script/engine.h>
+
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+
+namespace gonk
+{
+
+static Tracer* g_active_tracer = nullptr;
+
+static const char* category_name(Tracer::Category cat)
+{
+  switch (cat)
+  {
+  case Tracer::Script:
+    return "script";
+  case Tracer::Native:
+    return "native";
+  case Tracer::Module:
+    return "module";
+  default:
+    return "";
+  }
+}
+
+static void write_json_string(std::ostream& out, const std::string& str)
+{
+  out << '"';
+
+  for (char c : str)
+  {
+    if (c == '"' || c == '\\')
+      out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      out << ' ';
+    else
+      out << c;
+  }
+
+  out << '"';
+}
+
+Tracer::Tracer()
+  : m_start(clock::now())
+{
+  // enough for a short script without reallocating
+  m_events.reserve(1 << 16);
+}
+
+Tracer::~Tracer()
+{
+  if (g_active_tracer == this)
+    stop();
+}
+
+Tracer* Tracer::active()
+{
+  return g_active_tracer;
+}
+
+void Tracer::start()
+{
+  g_active_tracer = this;
+  instrumentation::addNativeCallObserver(this);
+}
+
+void Tracer::stop()
+{
+  // close the frames that are still open so that the timeline is balanced
+  const clock::duration now = clock::now() - m_start;
+
+  while (!m_stack.empty())
+  {
+    m_events.push_back(Event{ 'E', m_stack.back().category, m_stack.back().name, now });
+    m_stack.pop_back();
+  }
+
+  instrumentation::removeNativeCallObserver(this);
+
+  if (g_active_tracer == this)
+    g_active_tracer = nullptr;
+}
+
+void Tracer::begin(Category cat, const std::string& name)
+{
+  m_events.push_back(Event{ 'B', cat, intern(name), clock::now() - m_start });
+}
+
+void Tracer::end(Category cat, const std::string& name)
+{
+  m_events.push_back(Event{ 'E', cat, intern(name), clock::now() - m_start });
+}
+
+void Tracer::interrupt(script::interpreter::FunctionCall& call, script::program::Breakpoint& info)
+{
+  sync(&call, call.executionContext()->callstack.size(), &info);
+}
+
+void Tracer::enter(script::interpreter::FunctionCall* c)
+{
+  // the native call is on top of the callstack
+  sync(c, c->executionContext()->callstack.size());
+}
+
+void Tracer::leave(script::interpreter::FunctionCall* c)
+{
+  // everything above the native call has returned, including the call itself
+  const size_t depth = c->executionContext()->callstack.size();
+  sync(c, depth > 0 ? depth - 1 : 0);
+}
+
+const std::vector<Tracer::Event>& Tracer::events() const
+{
+  return m_events;
+}
+
+uint32_t Tracer::intern(const std::string& name)
+{
+  auto it = m_name_ids.find(name);
+
+  if (it != m_name_ids.end())
+    return it->second;
+
+  uint32_t id = static_cast<uint32_t>(m_names.size());
+  m_names.push_back(name);
+  m_name_ids[name] = id;
+  return id;
+}
+
+uint32_t Tracer::functionName(script::interpreter::FunctionCall* call)
+{
+  const void* key = call->callee().impl().get();
+  auto it = m_function_names.find(key);
+
+  if (it != m_function_names.end())
+    return it->second;
+
+  uint32_t id = intern(call->engine()->toString(call->callee()));
+  m_function_names[key] = id;
+  return id;
+}
+
+void Tracer::sync(script::interpreter::FunctionCall* call, size_t depth, const void* breakpoint)
+{
+  script::interpreter::Callstack& cs = call->executionContext()->callstack;
+  const clock::duration now = clock::now() - m_start;
+
+  size_t common = 0;
+
+  while (common < depth && common < m_stack.size()
+    && m_stack[common].call == cs[common] && m_stack[common].callee == cs[common]->callee().impl().get())
+  {
+    ++common;
+  }
+
+  // the slot of a returned call is reused by the next call at the same depth,
+  // reaching the entry breakpoint of the top frame again means a new call
+  if (breakpoint && common == depth && depth > 0 && m_stack[depth - 1].entry == breakpoint)
+    common -= 1;
+
+  while (m_stack.size() > common)
+  {
+    m_events.push_back(Event{ 'E', m_stack.back().category, m_stack.back().name, now });
+    m_stack.pop_back();
+  }
+
+  for (size_t i(common); i < depth; ++i)
+  {
+    Frame frame;
+    frame.call = cs[i];
+    frame.callee = cs[i]->callee().impl().get();
+    frame.category = cs[i]->callee().isNative() ? Category::Native : Category::Script;
+    frame.name = functionName(cs[i]);
+    frame.entry = i + 1 == depth ? breakpoint : nullptr;
+
+    m_events.push_back(Event{ 'B', frame.category, frame.name, now });
+    m_stack.push_back(frame);
+  }
+}
+
+void Tracer::write(std::ostream& out) const
+{
+  out << "{\"traceEvents\":[\n";
+
+  out << std::fixed << std::setprecision(3);
+
+  for (size_t i(0); i < m_events.size(); ++i)
+  {
+    const Event& ev = m_events[i];
+
+    out << "{\"name\":";
+    write_json_string(out, m_names[ev.name]);
+    out << ",\"cat\":\"" << category_name(ev.category) << "\"";
+    out << ",\"ph\":\"" << ev.phase << "\"";
+    out << ",\"ts\":" << std::chrono::duration<double, std::micro>(ev.timestamp).count();
+    out << ",\"pid\":1,\"tid\":1}";
+
+    if (i + 1 < m_events.size())
+      out << ",";
+
+    out << "\n";
+  }
+
+  out << "],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool Tracer::save(const std::string& path) const
+{
+  std::ofstream file{ path };
+
+  if (!file.is_open())
+    return false;
+
+  write(file);
+  return file.good();
+}
+
+} // namespace gonk
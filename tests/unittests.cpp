@@ -15,6 +15,15 @@
 #include "gonk/common/binding/staticmemberfunction.h"
 #include "gonk/common/binding/operators.h"
 #include "gonk/common/binding/pointer.h"
+#include "gonk/common/span.h"
+#include "gonk/copy-audit.h"
+#include "gonk/coverage.h"
+#include "gonk/lazy-members.h"
+#include "gonk/memstats.h"
+#include "gonk/metrics.h"
+#include "gonk/profiler.h"
+#include "gonk/sampling-profiler.h"
+#include "gonk/tracer.h"
 
 #include "gonk/templates/pointer-template.h"
 
@@ -27,9 +36,15 @@
 #include <script/operator.h>
 
 #include <script/private/value_p.h>
+#include <script/script.h>
+#include <script/sourcefile.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <type_traits>
 
 int guaranteed_random()
@@ -99,6 +114,22 @@ int point_y(const Point & pt)
   return pt.y();
 }
 
+int span_sum(gonk::Span<const int> values)
+{
+  int result = 0;
+
+  for (int v : values)
+    result += v;
+
+  return result;
+}
+
+void span_double(gonk::Span<int> values)
+{
+  for (int& v : values)
+    v *= 2;
+}
+
 TEST_CASE("Test simple binding", "[binding]")
 {
   using namespace script;
@@ -319,6 +350,29 @@ TEST_CASE("Test simple binding", "[binding]")
   REQUIRE(assign.memberOf() == pt);
 }
 
+TEST_CASE("Test callable binding", "[binding]")
+{
+  using namespace script;
+
+  script::Engine e;
+  e.setup();
+
+  Namespace ns = e.rootNamespace();
+
+  int calls = 0;
+  Function f = gonk::bind::function(ns, "add_and_count", [&calls](int a, int b) { ++calls; return a + b; });
+  REQUIRE(f.returnType() == Type::Int);
+  REQUIRE(f.prototype().size() == 2);
+
+  script::Locals locals;
+  locals.push(e.newInt(2));
+  locals.push(e.newInt(3));
+
+  script::Value val = f.invoke(locals.data());
+  REQUIRE(val.toInt() == 5);
+  REQUIRE(calls == 1);
+}
+
 TEST_CASE("Test enum binding", "[binding]")
 {
   using namespace script;
@@ -345,3 +399,426 @@ TEST_CASE("Test enum binding", "[binding]")
   val = favcoord.invoke({});
   REQUIRE(gonk::value_cast<CoordinateSystem>(val) == CoordinateSystem::Cartesian);
 }
+
+TEST_CASE("Test span binding", "[binding]")
+{
+  using namespace script;
+
+  script::Engine e;
+  e.setup();
+
+  Namespace ns = e.rootNamespace();
+
+  Class vec = ns.newClass("IntVector").setId(e.registerType<std::vector<int>>().data()).get();
+
+  Function sum = gonk::bind::free_function<&span_sum>(ns, "sum").get();
+  REQUIRE(sum.parameter(0) == Type::cref(vec.id()));
+
+  Function twice = gonk::bind::free_function<&span_double>(ns, "twice").get();
+  REQUIRE(twice.parameter(0) == Type::ref(vec.id()));
+
+  std::vector<int> values{ 1, 2, 3 };
+  script::Value val = e.expose(values);
+
+  REQUIRE(sum.invoke({ val }).toInt() == 6);
+
+  // the function works on the elements of the vector, not on a copy
+  twice.invoke({ val });
+  REQUIRE(values.at(2) == 6);
+}
+
+TEST_CASE("Test lazy members", "[binding]")
+{
+  using namespace script;
+
+  script::Engine e;
+  e.setup();
+
+  Class widget = e.rootNamespace().newClass("Widget").get();
+
+  static std::vector<std::string> created;
+  created.clear();
+
+  auto create = [](script::Class& cla, const std::string& name) {
+    created.push_back(name);
+    gonk::bind::function(cla, name, []() { return 7; });
+  };
+
+  gonk::LazyMembers& lazy = gonk::LazyMembers::of(&e);
+  lazy.add(widget, "width", create);
+  lazy.add(widget, "height", create);
+  lazy.add(widget, "depth", create);
+  REQUIRE(lazy.pendingCount() == 3);
+  REQUIRE(created.empty());
+
+  lazy.demandSource("Widget w; int h = w.height(); // 2d only");
+  REQUIRE(created == std::vector<std::string>{ "height" });
+  REQUIRE(lazy.pendingCount() == 2);
+
+  // a name that was already demanded is created as soon as it is added
+  lazy.add(widget, "h", create);
+  REQUIRE(created.back() == "h");
+
+  lazy.materializeAll();
+  REQUIRE(lazy.pendingCount() == 0);
+  REQUIRE(lazy.createdCount() == 4);
+
+  gonk::LazyMembers::release(&e);
+}
+
+TEST_CASE("Test copy audit of containers", "[memstats]")
+{
+  using namespace script;
+
+  script::Engine e;
+  e.setup();
+
+  Class vec = e.rootNamespace().newClass("IntVector").setId(e.registerType<std::vector<int>>().data()).get();
+  gonk::bind::default_constructor<std::vector<int>>(vec).create();
+  gonk::bind::copy_constructor<std::vector<int>>(vec).create();
+  gonk::bind::destructor<std::vector<int>>(vec).create();
+
+  auto audit = std::make_shared<gonk::CopyAudit>();
+  audit->start();
+  e.interpreter()->setDebugHandler(audit);
+
+  const char* src =
+    "int first(IntVector v) { return 0; } \n"
+    "IntVector a;                         \n"
+    "int n = first(a);                    \n";
+
+  script::Script s = e.newScript(script::SourceFile::fromString(src));
+  REQUIRE(s.compile(script::CompileMode::Debug));
+  s.run();
+
+  e.interpreter()->setDebugHandler(nullptr);
+  audit->stop();
+
+  // passing the vector by value is a single deep copy, charged to the caller
+  REQUIRE(audit->sites().size() == 1);
+  const gonk::CopyAudit::Site& site = audit->sites().begin()->first;
+  REQUIRE(site.type == script::Type(vec.id()).data());
+  REQUIRE(site.function != nullptr);
+  REQUIRE(site.line == 2);
+  REQUIRE(audit->sites().begin()->second.count == 1);
+
+  std::stringstream report;
+  audit->writeReport(report, e);
+  REQUIRE(report.str().find("copy audit: 1 deep copies") != std::string::npos);
+  REQUIRE(report.str().find("copy of IntVector") != std::string::npos);
+}
+
+TEST_CASE("Test profiler", "[profiler]")
+{
+  using namespace script;
+
+  script::Engine e;
+  e.setup();
+
+  auto profiler = std::make_shared<gonk::Profiler>();
+  e.interpreter()->setDebugHandler(profiler);
+
+  const char* src =
+    "int g(int x) { return x; }  \n"
+    "int n = g(1) + g(2);        \n";
+
+  script::Script s = e.newScript(script::SourceFile::fromString(src));
+  REQUIRE(s.compile(script::CompileMode::Debug));
+  s.run();
+
+  e.interpreter()->setDebugHandler(nullptr);
+  profiler->stop();
+
+  // both calls reuse the same callstack slot but are two activations
+  auto it = std::find_if(profiler->functions().begin(), profiler->functions().end(), [](const gonk::Profiler::FunctionStats& f) {
+    return f.name.find("g(int)") != std::string::npos;
+    });
+
+  REQUIRE(it != profiler->functions().end());
+  REQUIRE(it->calls == 2);
+  REQUIRE(it->inclusive >= it->exclusive);
+
+  std::stringstream report;
+  profiler->writeReport(report);
+  REQUIRE(report.str().find("Functions (sorted by exclusive time)") != std::string::npos);
+  REQUIRE(report.str().find(it->name) != std::string::npos);
+
+  // the folded stacks are "frame;frame;... count" lines
+  std::stringstream folded;
+  profiler->writeCollapsedStacks(folded);
+
+  std::string line;
+
+  while (std::getline(folded, line))
+  {
+    size_t sep = line.rfind(' ');
+    REQUIRE(sep != std::string::npos);
+    REQUIRE(std::stoll(line.substr(sep + 1)) > 0);
+  }
+}
+
+TEST_CASE("Test tracer", "[tracer]")
+{
+  using namespace script;
+
+  script::Engine e;
+  e.setup();
+
+  auto tracer = std::make_shared<gonk::Tracer>();
+  tracer->start();
+  e.interpreter()->setDebugHandler(tracer);
+
+  const char* src =
+    "int g(int x) { return x; }  \n"
+    "int n = g(1) + g(2);        \n";
+
+  script::Script s = e.newScript(script::SourceFile::fromString(src));
+  REQUIRE(s.compile(script::CompileMode::Debug));
+  s.run();
+
+  e.interpreter()->setDebugHandler(nullptr);
+  tracer->stop();
+
+  std::stringstream json;
+  tracer->write(json);
+  REQUIRE(json.str().find("{\"traceEvents\":[") == 0);
+  REQUIRE(json.str().find("],\"displayTimeUnit\":\"ms\"}") != std::string::npos);
+
+  // one event per line, each call of g is a begin/end pair
+  std::vector<char> phases;
+  std::string line;
+
+  while (std::getline(json, line))
+  {
+    if (line.find("g(int)") == std::string::npos)
+      continue;
+
+    REQUIRE(line.find("\"cat\":\"script\"") != std::string::npos);
+    phases.push_back(line.find("\"ph\":\"B\"") != std::string::npos ? 'B' : 'E');
+  }
+
+  REQUIRE(phases == std::vector<char>{ 'B', 'E', 'B', 'E' });
+}
+
+TEST_CASE("Test sampling profiler", "[profiler]")
+{
+  using namespace script;
+
+  script::Engine e;
+  e.setup();
+
+  auto profiler = std::make_shared<gonk::SamplingProfiler>(10000);
+  REQUIRE(profiler->frequency() == 10000);
+  profiler->start();
+  e.interpreter()->setDebugHandler(profiler);
+
+  const char* src =
+    "int g(int x) { return x % 7; }          \n"
+    "int n = 0;                              \n"
+    "for (int i = 0; i < 200000; ++i)        \n"
+    "{                                       \n"
+    "  n = n + g(i);                         \n"
+    "}                                       \n";
+
+  script::Script s = e.newScript(script::SourceFile::fromString(src));
+  REQUIRE(s.compile(script::CompileMode::Debug));
+  s.run();
+
+  e.interpreter()->setDebugHandler(nullptr);
+  profiler->stop();
+
+  REQUIRE(profiler->sampleCount() > 0);
+
+  std::stringstream report;
+  profiler->writeReport(report);
+  REQUIRE(report.str().find("Samples: " + std::to_string(profiler->sampleCount()) + " at 10000 Hz") == 0);
+  REQUIRE(report.str().find("Functions (self samples)") != std::string::npos);
+  REQUIRE(report.str().find("Lines (self samples)") != std::string::npos);
+
+  // the histogram accounts for every sample
+  std::stringstream folded;
+  profiler->writeCollapsedStacks(folded);
+
+  size_t total = 0;
+  std::string line;
+
+  while (std::getline(folded, line))
+  {
+    size_t sep = line.rfind(' ');
+    REQUIRE(sep != std::string::npos);
+    total += std::stoul(line.substr(sep + 1));
+  }
+
+  REQUIRE(total == profiler->sampleCount());
+}
+
+TEST_CASE("Test coverage", "[coverage]")
+{
+  using namespace script;
+
+  script::Engine e;
+  e.setup();
+
+  // only scripts with a path are reported
+  const std::string path = "gonk-unittests-coverage.gnk";
+
+  {
+    std::ofstream file{ path };
+    file << "int f(int x)     \n";
+    file << "{                \n";
+    file << "  if (x > 0)     \n";
+    file << "    return 1;    \n";
+    file << "  return 0;      \n";
+    file << "}                \n";
+    file << "int n = f(1) + f(2); \n";
+  }
+
+  auto coverage = std::make_shared<gonk::Coverage>(true);
+  coverage->start();
+  e.interpreter()->setDebugHandler(coverage);
+
+  script::Script s = e.newScript(script::SourceFile{ path });
+  REQUIRE(s.compile(script::CompileMode::Debug));
+  coverage->addScript(s);
+  s.run();
+
+  e.interpreter()->setDebugHandler(nullptr);
+  coverage->stop();
+  std::remove(path.c_str());
+
+  REQUIRE(coverage->scripts().size() == 1);
+  const gonk::Coverage::ScriptCoverage& sc = *coverage->scripts().begin()->second;
+  REQUIRE(sc.isExecuted(2));
+  REQUIRE(sc.isExecuted(3));
+  REQUIRE(!sc.isExecuted(4));
+
+  std::stringstream lcov;
+  coverage->writeLcov(lcov);
+
+  // lines are 1-based in lcov
+  REQUIRE(lcov.str().find("SF:" + path + "\n") != std::string::npos);
+  REQUIRE(lcov.str().find("DA:3,2\n") != std::string::npos);
+  REQUIRE(lcov.str().find("DA:4,2\n") != std::string::npos);
+  REQUIRE(lcov.str().find("DA:5,0\n") != std::string::npos);
+  REQUIRE(lcov.str().find("end_of_record\n") != std::string::npos);
+}
+
+TEST_CASE("Test memory statistics", "[memstats]")
+{
+  using namespace script;
+
+  script::Engine e;
+  e.setup();
+
+  Class vec = e.rootNamespace().newClass("IntVector").setId(e.registerType<std::vector<int>>().data()).get();
+  gonk::bind::default_constructor<std::vector<int>>(vec).create();
+  gonk::bind::copy_constructor<std::vector<int>>(vec).create();
+  gonk::bind::destructor<std::vector<int>>(vec).create();
+
+  gonk::memstats::ContainerTrackerT<std::vector<int>> tracker{ "IntVector" };
+
+  gonk::memstats::reset();
+  gonk::memstats::setEnabled(true);
+
+  const char* src =
+    "IntVector a;      \n"
+    "IntVector b = a;  \n"
+    "IntVector c = b;  \n";
+
+  script::Script s = e.newScript(script::SourceFile::fromString(src));
+  REQUIRE(s.compile(script::CompileMode::Debug));
+  s.run();
+
+  std::vector<int> v{ 1, 2, 3 };
+  tracker.add(&v);
+
+  gonk::memstats::setEnabled(false);
+
+  std::map<int, gonk::memstats::TypeCounters> counters = gonk::memstats::counters();
+  REQUIRE(counters.find(vec.id()) != counters.end());
+  REQUIRE(counters[vec.id()].copied == 2);
+  REQUIRE(gonk::memstats::total().copied == 2);
+
+  // the tracker sees the live instances until they are removed
+  gonk::memstats::ContainerStats stats = tracker.stats();
+  REQUIRE(stats.live == 1);
+  REQUIRE(stats.created == 1);
+  REQUIRE(stats.elements == 3);
+  REQUIRE(stats.capacity >= 3);
+
+  std::stringstream report;
+  gonk::memstats::write_report(report, e);
+  REQUIRE(report.str().find("memory statistics") != std::string::npos);
+  REQUIRE(report.str().find("  IntVector\n") != std::string::npos);
+  REQUIRE(report.str().find("peak RSS: ") != std::string::npos);
+
+  tracker.remove(&v);
+  REQUIRE(tracker.stats().live == 0);
+
+  gonk::memstats::reset();
+  REQUIRE(gonk::memstats::total().copied == 0);
+}
+
+TEST_CASE("Test metrics", "[metrics]")
+{
+  using namespace script;
+
+  script::Engine e;
+  e.setup();
+
+  gonk::bind::function(e.rootNamespace(), "guaranteed_random", &guaranteed_random);
+
+  gonk::memstats::ContainerTrackerT<std::vector<int>> tracker{ "IntVector" };
+
+  gonk::Metrics::reset();
+  gonk::Metrics::setEnabled(true);
+
+  const char* src =
+    "int n = guaranteed_random() + guaranteed_random(); \n";
+
+  script::Script s = e.newScript(script::SourceFile::fromString(src));
+  REQUIRE(s.compile(script::CompileMode::Debug));
+  s.run();
+
+  gonk::Metrics::time(gonk::Metrics::RunTime, std::chrono::milliseconds(2));
+
+  std::vector<int> v{ 1, 2, 3 };
+  tracker.add(&v);
+
+  gonk::Metrics::Snapshot snapshot = gonk::Metrics::snapshot();
+
+  tracker.remove(&v);
+  gonk::Metrics::setEnabled(false);
+
+  REQUIRE(snapshot.counters[gonk::Metrics::NativeCalls] == 2);
+  REQUIRE(snapshot.counters[gonk::Metrics::RuntimeErrors] == 0);
+
+  // 2ms falls in the (1ms, 10ms] bucket
+  const gonk::Metrics::HistogramData& run_time = snapshot.histograms[gonk::Metrics::RunTime];
+  REQUIRE(run_time.count == 1);
+  REQUIRE(run_time.buckets[3] == 1);
+
+  REQUIRE(snapshot.container_elements.size() == 1);
+  REQUIRE(snapshot.container_elements.front().first == "IntVector");
+  REQUIRE(snapshot.container_elements.front().second == 3);
+
+  std::stringstream prometheus;
+  gonk::Metrics::writePrometheus(prometheus, snapshot);
+  REQUIRE(prometheus.str().find("# TYPE gonk_native_calls_total counter\ngonk_native_calls_total 2\n") != std::string::npos);
+  REQUIRE(prometheus.str().find("gonk_run_time_seconds_bucket{le=\"0.001\"} 0\n") != std::string::npos);
+  REQUIRE(prometheus.str().find("gonk_run_time_seconds_bucket{le=\"0.01\"} 1\n") != std::string::npos);
+  REQUIRE(prometheus.str().find("gonk_run_time_seconds_bucket{le=\"+Inf\"} 1\n") != std::string::npos);
+  REQUIRE(prometheus.str().find("gonk_run_time_seconds_count 1\n") != std::string::npos);
+  REQUIRE(prometheus.str().find("gonk_container_elements{container=\"IntVector\"} 3\n") != std::string::npos);
+
+  std::stringstream json;
+  gonk::Metrics::writeJson(json, snapshot);
+  REQUIRE(json.str().find("{\"counters\":{\"scripts_compiled\":") == 0);
+  REQUIRE(json.str().find("\"native_calls\":2,") != std::string::npos);
+  REQUIRE(json.str().find("\"run_time_seconds\":{\"count\":1,") != std::string::npos);
+  REQUIRE(json.str().find("\"buckets\":[0,0,0,1,0,0,0,0]") != std::string::npos);
+  REQUIRE(json.str().find("\"container_elements\":{\"IntVector\":3}}") != std::string::npos);
+
+  gonk::Metrics::reset();
+  REQUIRE(gonk::Metrics::snapshot().counters[gonk::Metrics::NativeCalls] == 0);
+}
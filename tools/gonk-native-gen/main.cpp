@@ -0,0 +1,283 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "native-scanner.h"
+
+#include "gonk/cli-parser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+class NativeGenOptions
+{
+public:
+  NativeGenOptions(int argc_, char** argv_);
+
+public:
+  int argc;
+  char** argv;
+
+public:
+  bool help = false;
+  std::string input;
+  std::optional<std::string> output;
+  std::optional<std::string> entry_point;
+};
+
+class NativeGenOptionsParser : public gonk::GenericCliParser<NativeGenOptions>
+{
+public:
+
+  using GenericCliParser<NativeGenOptions>::GenericCliParser;
+
+  void parse()
+  {
+    while (!atEnd())
+    {
+      std::string arg = read();
+
+      if (arg == "--help" || arg == "-h")
+        cli.help = true;
+      else if (arg == "--output" || arg == "-o")
+        cli.output = readValue(arg);
+      else if (arg == "--entry")
+        cli.entry_point = readValue(arg);
+      else if (!isOption(arg) && cli.input.empty())
+        cli.input = arg;
+      else
+        throw std::runtime_error("Unrecognized option " + arg);
+    }
+  }
+
+protected:
+  std::string readValue(const std::string& option)
+  {
+    if (atEnd())
+      throw std::runtime_error("Missing value for option " + option);
+
+    return read();
+  }
+};
+
+NativeGenOptions::NativeGenOptions(int argc_, char** argv_)
+  : argc(argc_),
+    argv(argv_)
+{
+  NativeGenOptionsParser parser{ *this };
+  parser.parse();
+}
+
+static void display_help()
+{
+  std::cout << "gonk-native-gen" << std::endl;
+  std::cout << "---------------" << std::endl;
+  std::cout << "Generates the registration code for the [[native]] functions of a hybrid module." << std::endl;
+  std::cout << "  gonk-native-gen <module.gnk> [-o <output.h>] [--entry <name>]" << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << "  -o, --output <file>  write to file instead of the standard output" << std::endl;
+  std::cout << "  --entry <name>       name of the generated function (default: <module>_natives)" << std::endl;
+}
+
+static std::string read_file(const std::string& path)
+{
+  std::ifstream file{ path };
+
+  if (!file.is_open())
+    throw std::runtime_error("could not open " + path);
+
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+static std::string identifier(std::string str)
+{
+  for (char& c : str)
+  {
+    if (!std::isalnum(static_cast<unsigned char>(c)))
+      c = '_';
+  }
+
+  return str;
+}
+
+static std::string basename(const std::string& path)
+{
+  size_t sep = path.find_last_of("/\\");
+  return sep == std::string::npos ? path : path.substr(sep + 1);
+}
+
+static void write_signature_list(std::ostream& out, const std::vector<std::string>& signatures)
+{
+  for (size_t i(0); i < signatures.size(); ++i)
+  {
+    out << (i == 0 ? "" : ",") << std::endl;
+    out << "    " << signatures.at(i);
+  }
+}
+
+static void generate(std::ostream& out, const std::string& input, const std::string& entry_point, const std::vector<NativeDecl>& decls)
+{
+  std::vector<std::string> functions;
+  std::vector<std::string> ctors;
+  std::vector<std::string> dtors;
+  std::vector<std::string> members;
+
+  auto add = [](std::vector<std::string>& list, const std::string& str) {
+    if (std::find(list.begin(), list.end(), str) == list.end())
+      list.push_back(str);
+  };
+
+  for (const NativeDecl& d : decls)
+  {
+    if (d.kind == NativeDecl::Function)
+      add(functions, d.signature());
+    else if (d.kind == NativeDecl::Constructor)
+      add(ctors, d.signature());
+    else if (d.kind == NativeDecl::Destructor)
+      add(dtors, d.class_name);
+    else
+      add(members, d.symbol);
+  }
+
+  std::string guard = entry_point;
+  std::transform(guard.begin(), guard.end(), guard.begin(), [](char c) { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); });
+  guard = "GONK_GENERATED_" + guard + "_H";
+
+  out << "// Generated by gonk-native-gen from " << basename(input) << ", do not edit." << std::endl;
+  out << "// The native procedures and types must be declared before this file is included." << std::endl;
+  out << std::endl;
+  out << "#ifndef " << guard << std::endl;
+  out << "#define " << guard << std::endl;
+  out << std::endl;
+  out << "#include \"gonk/functioncreator.h\"" << std::endl;
+  out << std::endl;
+  out << "#include <string>" << std::endl;
+  out << std::endl;
+  out << "inline void " << entry_point << "(gonk::FunctionCreator& creator)" << std::endl;
+  out << "{" << std::endl;
+
+  bool has_symbols = false;
+
+  for (const NativeDecl& d : decls)
+  {
+    if (d.kind != NativeDecl::Function)
+      continue;
+
+    if (!has_symbols)
+      out << "  static const gonk::NativeSymbol symbols[] = {" << std::endl;
+
+    has_symbols = true;
+    out << "    { \"" << d.symbol << "\", gonk::native_symbol<" << d.signature() << ">(&" << d.symbol << ") }," << std::endl;
+  }
+
+  if (has_symbols)
+  {
+    out << "  };" << std::endl;
+    out << std::endl;
+    out << "  creator.addSymbols(symbols, sizeof(symbols) / sizeof(symbols[0]));" << std::endl;
+  }
+
+  if (!functions.empty())
+  {
+    out << "  creator.addCreators<";
+    write_signature_list(out, functions);
+    out << ">();" << std::endl;
+  }
+
+  if (!ctors.empty())
+  {
+    out << "  creator.addCtorCreators<";
+    write_signature_list(out, ctors);
+    out << ">();" << std::endl;
+  }
+
+  if (!dtors.empty())
+  {
+    out << "  creator.addDtorCreators<";
+    write_signature_list(out, dtors);
+    out << ">();" << std::endl;
+  }
+
+  for (const std::string& m : members)
+    out << "  creator.addMember<&" << m << ">(\"" << m << "\");" << std::endl;
+
+  out << "}" << std::endl;
+  out << std::endl;
+  out << "#endif // " << guard << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    NativeGenOptions options{ argc, argv };
+
+    if (options.help || options.input.empty())
+    {
+      display_help();
+      return options.help ? 0 : 1;
+    }
+
+    NativeScanner scanner{ read_file(options.input) };
+    std::vector<NativeDecl> decls;
+
+    try
+    {
+      decls = scanner.scan();
+    }
+    catch (const std::exception& ex)
+    {
+      throw std::runtime_error(options.input + ": " + ex.what());
+    }
+
+    std::string entry_point = options.entry_point.value_or("");
+
+    if (entry_point.empty())
+    {
+      std::string name = basename(options.input);
+      entry_point = identifier(name.substr(0, name.rfind('.'))) + "_natives";
+    }
+
+    if (!options.output.has_value())
+    {
+      generate(std::cout, options.input, entry_point, decls);
+      return 0;
+    }
+
+    std::ostringstream ss;
+    generate(ss, options.input, entry_point, decls);
+
+    // leaves the file untouched when nothing changed to avoid rebuilds
+    std::ifstream previous{ options.output.value() };
+
+    if (previous.is_open())
+    {
+      std::stringstream content;
+      content << previous.rdbuf();
+
+      if (content.str() == ss.str())
+        return 0;
+    }
+
+    std::ofstream file{ options.output.value() };
+
+    if (!file.is_open())
+      throw std::runtime_error("could not write " + options.output.value());
+
+    file << ss.str();
+    return 0;
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,352 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "native-scanner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+static bool is_ident_char(char c)
+{
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+std::string NativeDecl::signature() const
+{
+  std::string result = return_type + "(";
+
+  for (size_t i(0); i < params.size(); ++i)
+  {
+    if (i > 0)
+      result += ", ";
+
+    result += params.at(i);
+  }
+
+  return result + ")";
+}
+
+NativeScanner::NativeScanner(const std::string& source)
+{
+  tokenize(source);
+}
+
+void NativeScanner::tokenize(const std::string& source)
+{
+  size_t i = 0;
+  int line = 1;
+
+  while (i < source.size())
+  {
+    const char c = source[i];
+
+    if (c == '\n')
+    {
+      ++line;
+      ++i;
+    }
+    else if (std::isspace(static_cast<unsigned char>(c)))
+    {
+      ++i;
+    }
+    else if (source.compare(i, 2, "//") == 0)
+    {
+      while (i < source.size() && source[i] != '\n')
+        ++i;
+    }
+    else if (source.compare(i, 2, "/*") == 0)
+    {
+      size_t end = source.find("*/", i + 2);
+      end = end == std::string::npos ? source.size() : end + 2;
+
+      for (; i < end; ++i)
+      {
+        if (source[i] == '\n')
+          ++line;
+      }
+    }
+    else if (c == '"' || c == '\'')
+    {
+      size_t j = i + 1;
+
+      while (j < source.size() && source[j] != c)
+        j += source[j] == '\\' ? 2 : 1;
+
+      j = std::min(j + 1, source.size());
+      m_tokens.push_back(Token{ source.substr(i, j - i), line });
+      i = j;
+    }
+    else if (is_ident_char(c))
+    {
+      size_t j = i;
+
+      while (j < source.size() && is_ident_char(source[j]))
+        ++j;
+
+      m_tokens.push_back(Token{ source.substr(i, j - i), line });
+      i = j;
+    }
+    else if (source.compare(i, 2, "::") == 0)
+    {
+      m_tokens.push_back(Token{ "::", line });
+      i += 2;
+    }
+    else
+    {
+      m_tokens.push_back(Token{ std::string(1, c), line });
+      ++i;
+    }
+  }
+}
+
+bool NativeScanner::isIdentifier(size_t i) const
+{
+  return i < m_tokens.size() && is_ident_char(m_tokens.at(i).text.front())
+    && !std::isdigit(static_cast<unsigned char>(m_tokens.at(i).text.front()));
+}
+
+bool NativeScanner::isPunctuator(size_t i, const char* p) const
+{
+  return i < m_tokens.size() && m_tokens.at(i).text == p;
+}
+
+std::vector<NativeDecl> NativeScanner::scan()
+{
+  std::vector<NativeDecl> result;
+  std::string pending_class;
+  m_scopes.clear();
+
+  size_t i = 0;
+
+  while (i < m_tokens.size())
+  {
+    const std::string& text = m_tokens.at(i).text;
+
+    if (text == "class" || text == "struct")
+    {
+      ++i;
+
+      std::string symbol;
+      bool is_native = false;
+      readAttributes(i, symbol, is_native);
+
+      if (isIdentifier(i))
+        pending_class = m_tokens.at(i++).text;
+    }
+    else if (text == "{")
+    {
+      m_scopes.push_back(pending_class);
+      pending_class.clear();
+      ++i;
+    }
+    else if (text == "}")
+    {
+      if (!m_scopes.empty())
+        m_scopes.pop_back();
+      ++i;
+    }
+    else if (text == ";")
+    {
+      pending_class.clear();
+      ++i;
+    }
+    else if (isPunctuator(i, "[") && isPunctuator(i + 1, "["))
+    {
+      std::string symbol;
+      bool is_native = false;
+      readAttributes(i, symbol, is_native);
+
+      if (is_native)
+        result.push_back(readDeclaration(i, symbol));
+    }
+    else
+    {
+      ++i;
+    }
+  }
+
+  return result;
+}
+
+bool NativeScanner::readAttributes(size_t& i, std::string& symbol, bool& is_native)
+{
+  bool found = false;
+
+  while (isPunctuator(i, "[") && isPunctuator(i + 1, "["))
+  {
+    found = true;
+    i += 2;
+
+    while (i < m_tokens.size() && !(isPunctuator(i, "]") && isPunctuator(i + 1, "]")))
+    {
+      if (m_tokens.at(i).text == "native")
+      {
+        is_native = true;
+
+        if (isPunctuator(i + 1, "(") && i + 2 < m_tokens.size() && m_tokens.at(i + 2).text.front() == '"')
+        {
+          const std::string& literal = m_tokens.at(i + 2).text;
+          symbol = literal.substr(1, literal.size() - 2);
+        }
+      }
+
+      ++i;
+    }
+
+    i += 2;
+  }
+
+  return found;
+}
+
+NativeDecl NativeScanner::readDeclaration(size_t& i, const std::string& symbol)
+{
+  std::vector<Token> tokens;
+  int depth = 0;
+
+  const int line = i < m_tokens.size() ? m_tokens.at(i).line : 0;
+
+  for (; i < m_tokens.size(); ++i)
+  {
+    const std::string& text = m_tokens.at(i).text;
+
+    if (depth == 0 && (text == ";" || text == "{"))
+      break;
+    else if (text == "(")
+      ++depth;
+    else if (text == ")")
+      --depth;
+
+    tokens.push_back(m_tokens.at(i));
+  }
+
+  auto error = [line](const std::string& mssg) {
+    return std::runtime_error("line " + std::to_string(line) + ": " + mssg);
+  };
+
+  size_t lpar = 0;
+  while (lpar < tokens.size() && tokens.at(lpar).text != "(")
+    ++lpar;
+
+  if (lpar == 0 || lpar == tokens.size())
+    throw error("expected a function declaration after [[native]]");
+
+  size_t begin = 0;
+  bool is_static = false;
+
+  while (begin < lpar && (tokens.at(begin).text == "static" || tokens.at(begin).text == "explicit" || tokens.at(begin).text == "virtual"))
+    is_static |= tokens.at(begin++).text == "static";
+
+  const std::string name = tokens.at(lpar - 1).text;
+  const std::string class_name = m_scopes.empty() ? std::string() : m_scopes.back();
+
+  NativeDecl decl;
+  decl.line = line;
+  decl.symbol = symbol;
+  decl.class_name = class_name;
+
+  if (!class_name.empty() && name == class_name && begin == lpar - 1)
+  {
+    decl.kind = NativeDecl::Constructor;
+    decl.return_type = class_name;
+  }
+  else if (!class_name.empty() && name == class_name && begin == lpar - 2 && tokens.at(begin).text == "~")
+  {
+    decl.kind = NativeDecl::Destructor;
+    decl.return_type = "void";
+  }
+  else
+  {
+    if (symbol.empty())
+      throw error("native function '" + name + "' needs a procedure name, e.g. [[native(\"" + name + "\")]]");
+
+    if (symbol.find("::") != std::string::npos)
+    {
+      if (class_name.empty() || is_static)
+        throw error("'" + symbol + "' can only be bound to a non-static member function");
+
+      decl.kind = NativeDecl::Member;
+    }
+
+    decl.return_type = readType(tokens, begin, lpar - 1);
+  }
+
+  size_t rpar = lpar + 1;
+  size_t param_begin = rpar;
+  depth = 0;
+
+  for (; rpar < tokens.size(); ++rpar)
+  {
+    const std::string& text = tokens.at(rpar).text;
+
+    if (text == "(" || text == "<")
+    {
+      ++depth;
+    }
+    else if ((text == ")" || text == ">") && depth > 0)
+    {
+      --depth;
+    }
+    else if (depth == 0 && (text == "," || text == ")"))
+    {
+      if (rpar > param_begin)
+        decl.params.push_back(readType(tokens, param_begin, rpar));
+
+      param_begin = rpar + 1;
+
+      if (text == ")")
+        break;
+    }
+  }
+
+  bool is_const = false;
+
+  for (size_t j = rpar + 1; j < tokens.size() && tokens.at(j).text != "="; ++j)
+    is_const |= tokens.at(j).text == "const";
+
+  if (decl.kind != NativeDecl::Constructor && !class_name.empty() && !is_static)
+    decl.params.insert(decl.params.begin(), (is_const ? "const " : "") + class_name + "&");
+
+  return decl;
+}
+
+std::string NativeScanner::readType(const std::vector<Token>& tokens, size_t begin, size_t end) const
+{
+  // drops the default argument
+  for (size_t i = begin; i < end; ++i)
+  {
+    if (tokens.at(i).text == "=")
+    {
+      end = i;
+      break;
+    }
+  }
+
+  // drops the parameter name
+  if (end - begin > 1 && is_ident_char(tokens.at(end - 1).text.front()) && tokens.at(end - 2).text != "::")
+  {
+    bool has_type_name = false;
+
+    for (size_t i = begin; i < end - 1; ++i)
+      has_type_name |= is_ident_char(tokens.at(i).text.front()) && tokens.at(i).text != "const";
+
+    if (has_type_name)
+      --end;
+  }
+
+  std::string result;
+
+  for (size_t i = begin; i < end; ++i)
+  {
+    const std::string text = tokens.at(i).text == "String" ? std::string("std::string") : tokens.at(i).text;
+
+    if (!result.empty() && is_ident_char(result.back()) && is_ident_char(text.front()))
+      result.push_back(' ');
+
+    result += text;
+  }
+
+  return result;
+}
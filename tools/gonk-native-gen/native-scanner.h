@@ -0,0 +1,62 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONKNATIVEGEN_NATIVESCANNER_H
+#define GONKNATIVEGEN_NATIVESCANNER_H
+
+#include <string>
+#include <vector>
+
+/*!
+ * \class NativeDecl
+ * \brief a function declared with the [[native]] attribute in a gonk script
+ */
+struct NativeDecl
+{
+  enum Kind
+  {
+    Function,
+    Member, // bound to a C++ member, e.g. [[native("Foo::bar")]]
+    Constructor,
+    Destructor,
+  };
+
+  Kind kind = Function;
+  int line = 0;
+  std::string symbol;
+  std::string class_name;
+  std::string return_type;
+  std::vector<std::string> params;
+
+  // the C++ signature expected for the procedure, e.g. "int(const Foo&, int)"
+  std::string signature() const;
+};
+
+class NativeScanner
+{
+public:
+  explicit NativeScanner(const std::string& source);
+
+  std::vector<NativeDecl> scan();
+
+  struct Token
+  {
+    std::string text;
+    int line = 0;
+  };
+
+protected:
+  void tokenize(const std::string& source);
+  bool isIdentifier(size_t i) const;
+  bool isPunctuator(size_t i, const char* p) const;
+  bool readAttributes(size_t& i, std::string& symbol, bool& is_native);
+  NativeDecl readDeclaration(size_t& i, const std::string& symbol);
+  std::string readType(const std::vector<Token>& tokens, size_t begin, size_t end) const;
+
+private:
+  std::vector<Token> m_tokens;
+  std::vector<std::string> m_scopes;
+};
+
+#endif // GONKNATIVEGEN_NATIVESCANNER_H
@@ -0,0 +1,353 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "commands.h"
+
+#include "session.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+// Lines are 0-based in the debugger protocol and 1-based for the user.
+
+CommandInterpreter::CommandInterpreter(DebugSession& session, std::ostream& out)
+  : m_session(session),
+    m_out(out)
+{
+
+}
+
+std::vector<std::string> CommandInterpreter::split(const std::string& line)
+{
+  std::vector<std::string> result;
+  std::istringstream stream{ line };
+  std::string word;
+
+  while (stream >> word)
+    result.push_back(word);
+
+  return result;
+}
+
+bool CommandInterpreter::exec(const std::string& line)
+{
+  std::vector<std::string> args = split(line);
+
+  if (args.empty() || args.front().front() == '#')
+    return true;
+
+  const std::string cmd = args.front();
+
+  if (cmd == "help" || cmd == "h")
+  {
+    help();
+  }
+  else if (cmd == "quit" || cmd == "q")
+  {
+    m_session.detach();
+    return false;
+  }
+  else if (cmd == "detach")
+  {
+    m_session.detach();
+    return false;
+  }
+  else if (cmd == "wait")
+  {
+    m_session.waitForBreak();
+    printLocation();
+  }
+  else if (cmd == "pause")
+  {
+    m_session.pause();
+    m_session.waitForBreak();
+    printLocation();
+  }
+  else if (cmd == "continue" || cmd == "c" || cmd == "run")
+  {
+    step("run");
+  }
+  else if (cmd == "step" || cmd == "s")
+  {
+    step("stepinto");
+  }
+  else if (cmd == "next" || cmd == "n")
+  {
+    step("stepover");
+  }
+  else if (cmd == "finish" || cmd == "out")
+  {
+    step("stepout");
+  }
+  else if (cmd == "break" || cmd == "b")
+  {
+    addBreakpoint(args);
+  }
+  else if (cmd == "delete" || cmd == "d")
+  {
+    if (args.size() != 2)
+      throw std::runtime_error("usage: delete <id>");
+
+    m_session.removeBreakpoint(std::stoi(args.at(1)));
+  }
+  else if (cmd == "breakpoints")
+  {
+    printBreakpoints();
+  }
+  else if (cmd == "backtrace" || cmd == "bt")
+  {
+    printCallstack();
+  }
+  else if (cmd == "locals")
+  {
+    printVariables(args.size() > 1 ? std::stoi(args.at(1)) : -1);
+  }
+  else if (cmd == "list" || cmd == "l")
+  {
+    printSource(args);
+  }
+  else if (cmd == "bench")
+  {
+    bench(args);
+  }
+  else
+  {
+    throw std::runtime_error("unknown command '" + cmd + "', type 'help' for a list of commands");
+  }
+
+  return m_session.state() != DebugSession::Finished && m_session.state() != DebugSession::Disconnected;
+}
+
+void CommandInterpreter::help()
+{
+  m_out << "break <file>:<line>    add a breakpoint" << std::endl;
+  m_out << "delete <id>            remove a breakpoint" << std::endl;
+  m_out << "breakpoints            list the breakpoints" << std::endl;
+  m_out << "continue, c            resume execution until the next breakpoint" << std::endl;
+  m_out << "step, s                step into" << std::endl;
+  m_out << "next, n                step over" << std::endl;
+  m_out << "finish, out            step out" << std::endl;
+  m_out << "pause                  interrupt the script" << std::endl;
+  m_out << "wait                   wait until the script is paused" << std::endl;
+  m_out << "backtrace, bt          print the callstack" << std::endl;
+  m_out << "locals [depth]         print the variables of a frame (default: top)" << std::endl;
+  m_out << "list [file [from [to]]] print source code" << std::endl;
+  m_out << "bench <step|next> <n>  measure the latency of n step operations" << std::endl;
+  m_out << "detach, quit           leave the script running and exit" << std::endl;
+}
+
+void CommandInterpreter::step(const std::string& action)
+{
+  if (!m_session.isPaused())
+    throw std::runtime_error("the script is not paused");
+
+  if (action == "run")
+    m_session.run();
+  else if (action == "stepinto")
+    m_session.stepInto();
+  else if (action == "stepover")
+    m_session.stepOver();
+  else
+    m_session.stepOut();
+
+  m_session.waitForBreak();
+  printLocation();
+}
+
+void CommandInterpreter::printLocation()
+{
+  if (m_session.state() == DebugSession::Finished)
+  {
+    m_out << "script finished" << std::endl;
+    return;
+  }
+
+  if (!m_session.isPaused())
+    return;
+
+  auto snapshot = m_session.lastSnapshot();
+  std::shared_ptr<gonk::debugger::Callstack> cs = (snapshot && snapshot->callstack) ? snapshot->callstack : m_session.callstack();
+
+  if (cs->entries.empty())
+    return;
+
+  const gonk::debugger::CallstackEntry& top = cs->entries.back();
+  m_out << "stopped in " << top.function << " at " << top.path << ":" << (top.line + 1) << std::endl;
+}
+
+void CommandInterpreter::addBreakpoint(const std::vector<std::string>& args)
+{
+  std::string path;
+  int line = -1;
+
+  if (args.size() == 2)
+  {
+    const std::string& loc = args.at(1);
+    size_t sep = loc.rfind(':');
+
+    if (sep == std::string::npos)
+      throw std::runtime_error("usage: break <file>:<line>");
+
+    path = loc.substr(0, sep);
+    line = std::stoi(loc.substr(sep + 1));
+  }
+  else if (args.size() == 3)
+  {
+    path = args.at(1);
+    line = std::stoi(args.at(2));
+  }
+  else
+  {
+    throw std::runtime_error("usage: break <file>:<line>");
+  }
+
+  m_session.addBreakpoint(path, line - 1);
+}
+
+void CommandInterpreter::printBreakpoints()
+{
+  auto list = m_session.breakpoints();
+
+  for (const gonk::debugger::BreakpointData& bp : list->list)
+    m_out << "#" << bp.id << " " << bp.script_path << ":" << (bp.line + 1) << " in " << bp.function << std::endl;
+}
+
+void CommandInterpreter::printCallstack()
+{
+  auto cs = m_session.callstack();
+  int depth = cs->offset + static_cast<int>(cs->entries.size());
+
+  for (auto it = cs->entries.rbegin(); it != cs->entries.rend(); ++it)
+  {
+    --depth;
+    m_out << "#" << depth << " " << it->function;
+
+    if (!it->path.empty())
+      m_out << " at " << it->path << ":" << (it->line + 1);
+
+    m_out << std::endl;
+  }
+}
+
+void CommandInterpreter::printVariables(int depth)
+{
+  auto vars = m_session.variables(depth);
+
+  for (const auto& v : vars->variables)
+    printVariable(*v, 0);
+}
+
+void CommandInterpreter::printVariable(const gonk::debugger::Variable& v, int indent)
+{
+  m_out << std::string(2 * indent, ' ') << v.type << " " << v.name << " = " << v.value << std::endl;
+
+  for (const auto& m : v.members)
+    printVariable(*m, indent + 1);
+}
+
+void CommandInterpreter::printSource(const std::vector<std::string>& args)
+{
+  std::string path;
+  int first = -1;
+  int last = -1;
+
+  if (args.size() > 1)
+  {
+    path = args.at(1);
+
+    if (args.size() > 2)
+      first = std::stoi(args.at(2)) - 1;
+
+    if (args.size() > 3)
+      last = std::stoi(args.at(3)) - 1;
+  }
+  else
+  {
+    auto cs = m_session.callstack();
+
+    if (cs->entries.empty())
+      return;
+
+    path = cs->entries.back().path;
+    first = std::max(0, cs->entries.back().line - 5);
+    last = cs->entries.back().line + 5;
+  }
+
+  auto src = m_session.source(path);
+
+  std::istringstream stream{ src->source };
+  std::string text;
+  int n = 0;
+
+  while (std::getline(stream, text))
+  {
+    if ((first == -1 || n >= first) && (last == -1 || n <= last))
+      m_out << std::setw(5) << (n + 1) << "  " << text << std::endl;
+
+    ++n;
+  }
+}
+
+void CommandInterpreter::bench(const std::vector<std::string>& args)
+{
+  if (args.size() != 3 || (args.at(1) != "step" && args.at(1) != "next"))
+    throw std::runtime_error("usage: bench <step|next> <count>");
+
+  if (!m_session.isPaused())
+    throw std::runtime_error("the script is not paused");
+
+  const bool step_into = args.at(1) == "step";
+  const int count = std::stoi(args.at(2));
+
+  std::vector<double> samples;
+  samples.reserve(count);
+
+  for (int i(0); i < count; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+
+    if (step_into)
+      m_session.stepInto();
+    else
+      m_session.stepOver();
+
+    bool paused = m_session.waitForBreak();
+
+    auto end = std::chrono::steady_clock::now();
+    samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+
+    if (!paused)
+      break;
+  }
+
+  if (samples.empty())
+    return;
+
+  std::sort(samples.begin(), samples.end());
+
+  double total = 0;
+  for (double s : samples)
+    total += s;
+
+  auto percentile = [&samples](double p) -> double {
+    size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+    return samples.at(index);
+  };
+
+  m_out << std::fixed << std::setprecision(1);
+  m_out << "bench " << args.at(1) << ": " << samples.size() << " steps"
+    << ", mean " << (total / samples.size()) << "us"
+    << ", median " << percentile(0.5) << "us"
+    << ", p95 " << percentile(0.95) << "us"
+    << ", min " << samples.front() << "us"
+    << ", max " << samples.back() << "us" << std::endl;
+  m_out << std::defaultfloat;
+
+  if (samples.size() < static_cast<size_t>(count))
+    m_out << "script finished after " << samples.size() << " steps" << std::endl;
+}
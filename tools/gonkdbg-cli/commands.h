@@ -0,0 +1,49 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONKDBGCLI_COMMANDS_H
+#define GONKDBGCLI_COMMANDS_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class DebugSession;
+
+namespace gonk
+{
+namespace debugger
+{
+struct Variable;
+} // namespace debugger
+} // namespace gonk
+
+class CommandInterpreter
+{
+public:
+  CommandInterpreter(DebugSession& session, std::ostream& out);
+
+  // returns false once the session is over ('quit' or end of the script)
+  bool exec(const std::string& line);
+
+  static std::vector<std::string> split(const std::string& line);
+
+protected:
+  void help();
+  void step(const std::string& action);
+  void printLocation();
+  void addBreakpoint(const std::vector<std::string>& args);
+  void printBreakpoints();
+  void printCallstack();
+  void printVariables(int depth);
+  void printVariable(const gonk::debugger::Variable& v, int indent);
+  void printSource(const std::vector<std::string>& args);
+  void bench(const std::vector<std::string>& args);
+
+private:
+  DebugSession& m_session;
+  std::ostream& m_out;
+};
+
+#endif // GONKDBGCLI_COMMANDS_H
@@ -0,0 +1,320 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "commands.h"
+#include "session.h"
+
+#include "gonk/cli-parser.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif // !defined(_WIN32)
+
+class GonkdbgCliOptions
+{
+public:
+  GonkdbgCliOptions(int argc_, char** argv_);
+
+public:
+  int argc;
+  char** argv;
+
+public:
+  bool help = false;
+  int port = 24242;
+  std::optional<std::string> socket;
+  std::optional<std::string> batch;
+  std::optional<std::string> launch;
+  int timeout = 10000;
+};
+
+class GonkdbgCliOptionsParser : public gonk::GenericCliParser<GonkdbgCliOptions>
+{
+public:
+
+  using GenericCliParser<GonkdbgCliOptions>::GenericCliParser;
+
+  void parse()
+  {
+    while (!atEnd())
+    {
+      std::string arg = read();
+
+      if (arg == "--help" || arg == "-h")
+        cli.help = true;
+      else if (arg == "--port")
+        cli.port = std::stoi(readValue(arg));
+      else if (arg == "--socket")
+        cli.socket = readValue(arg);
+      else if (arg == "--batch")
+        cli.batch = readValue(arg);
+      else if (arg == "--launch")
+        cli.launch = readValue(arg);
+      else if (arg == "--timeout")
+        cli.timeout = std::stoi(readValue(arg));
+      else
+        throw std::runtime_error("Unrecognized option " + arg);
+    }
+  }
+
+protected:
+  std::string readValue(const std::string& option)
+  {
+    if (atEnd())
+      throw std::runtime_error("Missing value for option " + option);
+
+    return read();
+  }
+};
+
+GonkdbgCliOptions::GonkdbgCliOptions(int argc_, char** argv_)
+  : argc(argc_),
+    argv(argv_)
+{
+  GonkdbgCliOptionsParser parser{ *this };
+  parser.parse();
+}
+
+/*!
+ * \class Debuggee
+ * \brief the process started with --launch
+ */
+class Debuggee
+{
+public:
+  explicit Debuggee(const std::string& command);
+  Debuggee(const Debuggee&) = delete;
+  ~Debuggee();
+
+  void wait();
+  void terminate();
+
+  Debuggee& operator=(const Debuggee&) = delete;
+
+private:
+#if defined(_WIN32)
+  std::thread m_thread;
+#else
+  pid_t m_pid = -1;
+#endif // defined(_WIN32)
+};
+
+#if defined(_WIN32)
+
+Debuggee::Debuggee(const std::string& command)
+{
+  m_thread = std::thread([command]() {
+    std::system(command.c_str());
+  });
+}
+
+Debuggee::~Debuggee()
+{
+  if (m_thread.joinable())
+    m_thread.detach();
+}
+
+void Debuggee::wait()
+{
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+void Debuggee::terminate()
+{
+  // the process started by std::system() cannot be killed, at least
+  // do not wait for it
+  if (m_thread.joinable())
+    m_thread.detach();
+}
+
+#else
+
+Debuggee::Debuggee(const std::string& command)
+{
+  std::string shell = "/bin/sh";
+  std::string flag = "-c";
+  std::string cmd = command;
+  char* args[] = { &shell[0], &flag[0], &cmd[0], nullptr };
+
+  if (posix_spawn(&m_pid, shell.c_str(), nullptr, nullptr, args, environ) != 0)
+    throw std::runtime_error("could not launch " + command);
+}
+
+Debuggee::~Debuggee()
+{
+  wait();
+}
+
+void Debuggee::wait()
+{
+  if (m_pid == -1)
+    return;
+
+  int status = 0;
+  waitpid(m_pid, &status, 0);
+  m_pid = -1;
+}
+
+void Debuggee::terminate()
+{
+  if (m_pid != -1)
+    kill(m_pid, SIGTERM);
+
+  wait();
+}
+
+#endif // defined(_WIN32)
+
+static void display_help()
+{
+  std::cout << "gonkdbg-cli" << std::endl;
+  std::cout << "-----------" << std::endl;
+  std::cout << "Command-line client for the gonk debugger (gonk --debug)." << std::endl;
+  std::cout << "  gonkdbg-cli [--port <port>] [--socket <path>] [--timeout <ms>] [--launch <command>] [--batch <file>]" << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << "  --port <port>       connect to the given TCP port (default: 24242)" << std::endl;
+  std::cout << "  --socket <path>     connect to a Unix domain socket" << std::endl;
+  std::cout << "  --timeout <ms>      how long to wait for the debugger (default: 10000)" << std::endl;
+  std::cout << "  --launch <command>  start the debuggee, e.g. \"gonk --debug script.gnk\"" << std::endl;
+  std::cout << "  --batch <file>      execute the commands in file and exit" << std::endl;
+  std::cout << "Type 'help' in a session for the list of commands." << std::endl;
+}
+
+static int run_batch(CommandInterpreter& interpreter, const std::string& path)
+{
+  std::ifstream file{ path };
+
+  if (!file.is_open())
+  {
+    std::cerr << "could not open " << path << std::endl;
+    return 1;
+  }
+
+  std::string line;
+  int lineno = 0;
+
+  while (std::getline(file, line))
+  {
+    ++lineno;
+
+    try
+    {
+      if (!interpreter.exec(line))
+        break;
+    }
+    catch (const std::exception& ex)
+    {
+      std::cerr << path << ":" << lineno << ": " << ex.what() << std::endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static int run_interactive(CommandInterpreter& interpreter)
+{
+  std::string line;
+
+  for (;;)
+  {
+    std::cout << "(gonkdbg) " << std::flush;
+
+    if (!std::getline(std::cin, line))
+      break;
+
+    try
+    {
+      if (!interpreter.exec(line))
+        break;
+    }
+    catch (const std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+    }
+  }
+
+  return 0;
+}
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    GonkdbgCliOptions options{ argc, argv };
+
+    if (options.help)
+    {
+      display_help();
+      return 0;
+    }
+
+    std::unique_ptr<Debuggee> debuggee;
+
+    if (options.launch.has_value())
+      debuggee = std::make_unique<Debuggee>(options.launch.value());
+
+    int result = 0;
+    bool failed = false;
+
+    try
+    {
+      DebugSession session;
+      session.setTimeout(std::chrono::milliseconds(options.timeout));
+
+      if (options.socket.has_value())
+        session.connectLocal(options.socket.value());
+      else
+        session.connect(options.port);
+
+      // the location is printed after each step, that is all we need by default
+      session.configureSnapshot(1, false, false);
+
+      CommandInterpreter interpreter{ session, std::cout };
+
+      if (options.batch.has_value())
+        result = run_batch(interpreter, options.batch.value());
+      else
+        result = run_interactive(interpreter);
+
+      session.detach();
+    }
+    catch (const std::exception& ex)
+    {
+      std::cerr << ex.what() << std::endl;
+      result = 1;
+      failed = true;
+    }
+
+    if (debuggee)
+    {
+      // after an error the debuggee may be waiting for a client forever
+      if (failed)
+        debuggee->terminate();
+      else
+        debuggee->wait();
+    }
+
+    return result;
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+}
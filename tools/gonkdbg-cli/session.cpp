@@ -0,0 +1,325 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "session.h"
+
+#include <plugins/gonk-debugger/message-parser.h>
+
+#include <json-toolkit/stringify.h>
+
+#include <stdexcept>
+#include <thread>
+
+DebugSession::DebugSession()
+  : m_socket(m_io_context)
+{
+  m_buffer.resize(4096);
+}
+
+DebugSession::~DebugSession()
+{
+  boost::system::error_code ec;
+  m_socket.close(ec);
+}
+
+DebugSession::State DebugSession::state() const
+{
+  return m_state;
+}
+
+bool DebugSession::isPaused() const
+{
+  return m_state == State::Paused;
+}
+
+std::chrono::milliseconds DebugSession::timeout() const
+{
+  return m_timeout;
+}
+
+void DebugSession::setTimeout(std::chrono::milliseconds t)
+{
+  m_timeout = t;
+}
+
+void DebugSession::connect(int port)
+{
+  boost::asio::ip::tcp::endpoint endpoint{ boost::asio::ip::address_v4::loopback(), static_cast<unsigned short>(port) };
+  connect(protocol::endpoint(endpoint));
+}
+
+void DebugSession::connectLocal(const std::string& path)
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  boost::asio::local::stream_protocol::endpoint endpoint{ path };
+  connect(protocol::endpoint(endpoint));
+#else
+  throw std::runtime_error("Unix domain sockets are not supported on this platform");
+#endif // defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+}
+
+void DebugSession::connect(const protocol::endpoint& endpoint)
+{
+  // the debuggee may still be starting, retry until the timeout expires
+  auto deadline = std::chrono::steady_clock::now() + m_timeout;
+
+  for (;;)
+  {
+    boost::system::error_code ec;
+    m_socket.close(ec);
+    m_socket.connect(endpoint, ec);
+
+    if (!ec)
+      break;
+
+    if (std::chrono::steady_clock::now() >= deadline)
+      throw std::runtime_error("could not connect to the debugger: " + ec.message());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  m_state = State::Running;
+}
+
+void DebugSession::detach()
+{
+  if (m_state == State::Disconnected)
+    return;
+
+  if (m_state != State::Finished)
+  {
+    json::Object obj;
+    obj["type"] = "detach";
+    send(obj);
+  }
+
+  boost::system::error_code ec;
+  m_socket.shutdown(protocol::socket::shutdown_both, ec);
+  m_socket.close(ec);
+  m_state = State::Disconnected;
+}
+
+void DebugSession::configureSnapshot(int frames, bool variables, bool source)
+{
+  json::Object obj;
+  obj["type"] = "setsnapshot";
+  obj["frames"] = frames;
+  obj["variables"] = variables;
+  obj["source"] = source;
+  send(obj);
+}
+
+std::shared_ptr<gonk::debugger::BreakSnapshot> DebugSession::lastSnapshot() const
+{
+  return m_last_snapshot;
+}
+
+void DebugSession::pause()
+{
+  action("pause");
+}
+
+void DebugSession::run()
+{
+  action("run");
+}
+
+void DebugSession::stepInto()
+{
+  action("stepinto");
+}
+
+void DebugSession::stepOver()
+{
+  action("stepover");
+}
+
+void DebugSession::stepOut()
+{
+  action("stepout");
+}
+
+bool DebugSession::waitForBreak()
+{
+  if (m_state == State::Paused)
+    return true;
+
+  // the script may run for any amount of time before it breaks
+  while (m_state == State::Running)
+    nextMessage(false);
+
+  return m_state == State::Paused;
+}
+
+void DebugSession::addBreakpoint(const std::string& path, int line)
+{
+  json::Object obj;
+  obj["type"] = "addbreakpoint";
+  obj["path"] = path;
+  obj["line"] = line;
+  send(obj);
+}
+
+void DebugSession::removeBreakpoint(int id)
+{
+  json::Object obj;
+  obj["type"] = "removebreakpoint";
+  obj["id"] = id;
+  send(obj);
+}
+
+std::shared_ptr<gonk::debugger::BreakpointList> DebugSession::breakpoints()
+{
+  json::Object obj;
+  obj["type"] = "getbreakpoints";
+  send(obj);
+  return gonk::debugger::parseBreakpointList(receive("breakpoints"));
+}
+
+std::shared_ptr<gonk::debugger::Callstack> DebugSession::callstack()
+{
+  json::Object obj;
+  obj["type"] = "getcallstack";
+  send(obj);
+  return gonk::debugger::parseCallstack(receive("callstack"));
+}
+
+std::shared_ptr<gonk::debugger::VariableList> DebugSession::variables(int depth)
+{
+  json::Object obj;
+  obj["type"] = "getvariables";
+  obj["depth"] = depth;
+  send(obj);
+  return gonk::debugger::parseVariableList(receive("variables"));
+}
+
+std::shared_ptr<gonk::debugger::SourceCode> DebugSession::source(const std::string& path)
+{
+  json::Object obj;
+  obj["type"] = "getsource";
+  obj["path"] = path;
+  send(obj);
+  return gonk::debugger::parseSourceCode(receive("sourcecode"));
+}
+
+void DebugSession::send(const json::Object& obj)
+{
+  if (m_state == State::Disconnected || m_state == State::Finished)
+    throw std::runtime_error("not connected to a debugger");
+
+  std::string bytes = json::stringify(obj);
+  boost::system::error_code ec;
+  boost::asio::write(m_socket, boost::asio::buffer(bytes), ec);
+
+  if (ec)
+  {
+    m_state = State::Disconnected;
+    throw std::runtime_error("connection lost: " + ec.message());
+  }
+}
+
+json::Object DebugSession::receive()
+{
+  return nextMessage(true);
+}
+
+json::Object DebugSession::nextMessage(bool deadline)
+{
+  while (m_messages.empty())
+    readMore(deadline);
+
+  json::Object message = m_messages.front();
+  m_messages.pop_front();
+  process(message);
+  return message;
+}
+
+json::Object DebugSession::receive(const std::string& type)
+{
+  for (;;)
+  {
+    json::Object message = receive();
+
+    if (message["type"].toString() == type)
+      return message;
+
+    if (m_state == State::Finished)
+      throw std::runtime_error("the script has finished");
+  }
+}
+
+void DebugSession::action(const std::string& type)
+{
+  json::Object obj;
+  obj["type"] = type;
+  send(obj);
+
+  if (type != "pause")
+    m_state = State::Running;
+}
+
+void DebugSession::readMore(bool deadline)
+{
+  if (m_state == State::Disconnected || m_state == State::Finished)
+    throw std::runtime_error("not connected to a debugger");
+
+  bool done = false;
+  boost::system::error_code error;
+  size_t bytes_transferred = 0;
+
+  m_socket.async_read_some(boost::asio::buffer(&m_buffer[0], m_buffer.size()),
+    [&](const boost::system::error_code& ec, size_t n) {
+      error = ec;
+      bytes_transferred = n;
+      done = true;
+    });
+
+  m_io_context.restart();
+
+  if (deadline)
+    m_io_context.run_for(m_timeout);
+  else
+    m_io_context.run();
+
+  if (!done)
+  {
+    // the handler refers to local variables, let it complete before leaving
+    m_socket.cancel();
+    m_io_context.restart();
+    m_io_context.run();
+    throw std::runtime_error("timed out waiting for the debugger");
+  }
+
+  if (error)
+  {
+    m_state = State::Disconnected;
+    throw std::runtime_error("connection lost: " + error.message());
+  }
+
+  m_json_stream.write(std::string(m_buffer.data(), bytes_transferred));
+
+  for (const json::Object& obj : m_json_stream.objects)
+    m_messages.push_back(obj);
+
+  m_json_stream.objects.clear();
+}
+
+void DebugSession::process(const json::Object& message)
+{
+  std::string type = message["type"].toString();
+
+  if (type == "run")
+  {
+    m_state = State::Running;
+  }
+  else if (type == "break")
+  {
+    m_last_snapshot = gonk::debugger::parseBreakSnapshot(message);
+    m_state = State::Paused;
+  }
+  else if (type == "goodbye")
+  {
+    m_state = State::Finished;
+  }
+}
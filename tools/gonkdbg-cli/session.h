@@ -0,0 +1,83 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONKDBGCLI_SESSION_H
+#define GONKDBGCLI_SESSION_H
+
+#include <plugins/gonk-debugger/json-stream-parser.h>
+#include <plugins/gonk-debugger/message.h>
+
+#include <boost/asio.hpp>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+
+class DebugSession
+{
+public:
+  DebugSession();
+  ~DebugSession();
+
+  using protocol = boost::asio::generic::stream_protocol;
+
+  enum State
+  {
+    Disconnected,
+    Running,
+    Paused,
+    Finished,
+  };
+
+  State state() const;
+  bool isPaused() const;
+
+  std::chrono::milliseconds timeout() const;
+  void setTimeout(std::chrono::milliseconds t);
+
+  void connect(int port);
+  void connectLocal(const std::string& path);
+  void detach();
+
+  void configureSnapshot(int frames, bool variables, bool source);
+  std::shared_ptr<gonk::debugger::BreakSnapshot> lastSnapshot() const;
+
+  void pause();
+  void run();
+  void stepInto();
+  void stepOver();
+  void stepOut();
+  bool waitForBreak();
+
+  void addBreakpoint(const std::string& path, int line);
+  void removeBreakpoint(int id);
+  std::shared_ptr<gonk::debugger::BreakpointList> breakpoints();
+  std::shared_ptr<gonk::debugger::Callstack> callstack();
+  std::shared_ptr<gonk::debugger::VariableList> variables(int depth = -1);
+  std::shared_ptr<gonk::debugger::SourceCode> source(const std::string& path);
+
+  void send(const json::Object& obj);
+  json::Object receive();
+  json::Object receive(const std::string& type);
+
+protected:
+  void connect(const protocol::endpoint& endpoint);
+  void action(const std::string& type);
+  json::Object nextMessage(bool deadline);
+  void readMore(bool deadline);
+  void process(const json::Object& message);
+
+private:
+  boost::asio::io_context m_io_context;
+  protocol::socket m_socket;
+  std::string m_buffer;
+  gonk::JsonStreamParser m_json_stream;
+  std::deque<json::Object> m_messages;
+  State m_state = State::Disconnected;
+  std::chrono::milliseconds m_timeout{ 10000 };
+  std::shared_ptr<gonk::debugger::BreakSnapshot> m_last_snapshot;
+};
+
+#endif // GONKDBGCLI_SESSION_H
@@ -0,0 +1,191 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "code-viewer.h"
+#include "controller.h"
+#include "syntax-highlighting.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QTimer>
+
+#include <json-toolkit/json.h>
+
+#include <iostream>
+#include <string>
+
+// Loads a large generated script and its syntax tree into a CodeViewer and
+// reports how long it takes before the first paint and before the whole file
+// is highlighted, then how long it takes to apply a new syntax tree in which
+// the hints of one function in ten changed.
+//   gonkdbg_bench_codeviewer [nb-lines]
+
+class ScriptGenerator
+{
+public:
+  std::string source;
+  json::Array nodes;
+
+  // the call of every 'skip_calls'-th function gets no hint (0 for none)
+  ScriptGenerator(int nblines, int skip_calls)
+  {
+    int n = 0;
+
+    write("import std.io;\n\n");
+    n += 2;
+
+    for (int i(0); n < nblines; ++i)
+    {
+      const std::string name = "func" + std::to_string(i);
+      const std::string callee = "func" + std::to_string(i > 0 ? i - 1 : 0);
+
+      write("/* Function number " + std::to_string(i) + "\n");
+      write(" * computes something */\n");
+      write("int ");
+      json::Array decl;
+      decl.push(identifier(name));
+      write("(int a, int b)\n");
+      write("{\n");
+      write("  // single line comment\n");
+      write("  string s = \"" + name + "\";\n");
+      write("  int c = ");
+      json::Array qualid;
+      qualid.push(identifier("std"));
+      write("::");
+      qualid.push(identifier("max"));
+      json::Array max_call;
+      max_call.push(node("QualifiedIdentifier", qualid));
+      write("(a, b) + " + std::to_string(i) + ";\n");
+      write("  return ");
+      json::Array call;
+      call.push(identifier(callee));
+      write("(c, a * 2);\n");
+      write("}\n\n");
+      n += 10;
+
+      decl.push(node("FunctionCall", max_call));
+
+      if (skip_calls == 0 || i % skip_calls != 0)
+        decl.push(node("FunctionCall", call));
+
+      nodes.push(node("FunctionDeclaration", decl));
+    }
+  }
+
+  json::Object syntaxtree() const
+  {
+    json::Object result;
+    result["nodes"] = nodes;
+    return result;
+  }
+
+protected:
+  void write(const std::string& text)
+  {
+    source += text;
+  }
+
+  json::Object identifier(const std::string& name)
+  {
+    json::Object result;
+    result["type"] = "SimpleIdentifier";
+    result["offset"] = static_cast<int>(source.size());
+    result["length"] = static_cast<int>(name.size());
+    write(name);
+    return result;
+  }
+
+  static json::Object node(const std::string& type, const json::Array& children)
+  {
+    json::Object result;
+    result["type"] = type;
+    result["children"] = children;
+    return result;
+  }
+};
+
+class FirstPaintFilter : public QObject
+{
+public:
+  QElapsedTimer& timer;
+  qint64 elapsed = -1;
+
+  explicit FirstPaintFilter(QElapsedTimer& t) : timer(t) { }
+
+  bool eventFilter(QObject* watched, QEvent* ev) override
+  {
+    if (ev->type() == QEvent::Paint && elapsed == -1)
+      elapsed = timer.elapsed();
+
+    return QObject::eventFilter(watched, ev);
+  }
+};
+
+int main(int argc, char* argv[])
+{
+  QApplication app{ argc, argv };
+
+  const int nblines = argc > 1 ? std::stoi(argv[1]) : 20000;
+
+  ScriptGenerator script{ nblines, 0 };
+
+  auto src = std::make_shared<gonk::debugger::SourceCode>();
+  src->path = "generated.gnk";
+  src->source = script.source;
+  src->syntaxtree = script.syntaxtree();
+
+  // same text, the call hints of one function in ten are gone
+  auto updated = std::make_shared<gonk::debugger::SourceCode>(*src);
+  updated->syntaxtree = ScriptGenerator(nblines, 10).syntaxtree();
+
+  // no script on the command line: the controller only tries to connect
+  int controller_argc = 1;
+  Controller controller{ controller_argc, argv };
+
+  QElapsedTimer timer;
+  FirstPaintFilter filter{ timer };
+
+  timer.start();
+
+  CodeViewer viewer{ controller, src };
+  const qint64 construct_time = timer.elapsed();
+
+  viewer.viewport()->installEventFilter(&filter);
+  viewer.resize(800, 600);
+  viewer.show();
+
+  qint64 analysis_time = -1;
+  qint64 highlight_time = -1;
+  qint64 hints_time = -1;
+
+  QObject::connect(viewer.highlighter(), &SyntaxHighlighter::analysisFinished, [&]() {
+    analysis_time = timer.elapsed();
+    });
+
+  QObject::connect(viewer.highlighter(), &SyntaxHighlighter::highlightingFinished, [&]() {
+    highlight_time = timer.elapsed();
+
+    QElapsedTimer hints_timer;
+    hints_timer.start();
+    viewer.setSourceCode(updated);
+    hints_time = hints_timer.elapsed();
+
+    QTimer::singleShot(0, &app, &QApplication::quit);
+    });
+
+  // in case something goes wrong
+  QTimer::singleShot(60 * 1000, &app, &QApplication::quit);
+
+  app.exec();
+
+  std::cout << "lines: " << viewer.document()->blockCount() << std::endl;
+  std::cout << "construction: " << construct_time << "ms" << std::endl;
+  std::cout << "first paint: " << filter.elapsed << "ms" << std::endl;
+  std::cout << "background analysis: " << analysis_time << "ms" << std::endl;
+  std::cout << "fully highlighted: " << highlight_time << "ms" << std::endl;
+  std::cout << "new syntax tree: " << hints_time << "ms" << std::endl;
+
+  return highlight_time == -1 ? 1 : 0;
+}
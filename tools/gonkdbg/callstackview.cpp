@@ -32,7 +32,7 @@ void CallstackView::onCallstackUpdated()
 
   clear();
 
-  int d = static_cast<int>(callstack.entries.size());
+  int d = callstack.offset + static_cast<int>(callstack.entries.size());
 
   for (auto it = callstack.entries.rbegin(); it != callstack.entries.rend(); ++it)
   {
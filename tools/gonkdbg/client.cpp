@@ -4,6 +4,8 @@
 
 #include "client.h"
 
+#include <plugins/gonk-debugger/message-parser.h>
+
 #include <json-toolkit/stringify.h>
 
 #include <QHostAddress>
@@ -142,11 +144,15 @@ void Client::removeBreakpoint(const std::string& script_path, int line)
   send(obj);
 }
 
-void Client::getSource(const std::string& path)
+void Client::getSource(const std::string& path, const std::string& hash)
 {
   json::Object obj;
   obj["type"] = "getsource";
   obj["path"] = path;
+
+  if (!hash.empty())
+    obj["hash"] = hash;
+
   send(obj);
 }
 
@@ -172,6 +178,24 @@ void Client::getVariables(int depth)
   send(obj);
 }
 
+void Client::detach()
+{
+  json::Object obj;
+  obj["type"] = "detach";
+  send(obj);
+  m_socket->disconnectFromHost();
+}
+
+void Client::configureSnapshot(int frames, bool variables, bool source)
+{
+  json::Object obj;
+  obj["type"] = "setsnapshot";
+  obj["frames"] = frames;
+  obj["variables"] = variables;
+  obj["source"] = source;
+  send(obj);
+}
+
 void Client::onSocketConnected()
 {
   connect(m_socket, &QAbstractSocket::readyRead, this, &Client::onReadyRead);
@@ -202,26 +226,6 @@ void Client::onReadyRead()
   m_json_stream.objects.clear();
 }
 
-static std::shared_ptr<debugger::Variable> deserializeVar(const json::Object& json)
-{
-  auto ret = std::make_shared<debugger::Variable>();
-
-  ret->name = json["name"].toString();
-  ret->offset = json["offset"].toInt();
-  ret->type = json["type"].toString();
-  ret->value = json["value"].toString();
-
-  if (json["members"].isArray() && json["members"].toArray().length() > 0)
-  {
-    json::Array members = json["members"].toArray();
-
-    for (int i(0); i < members.length(); ++i)
-      ret->members.push_back(deserializeVar(members.at(i).toObject()));
-  }
-
-  return ret;
-}
-
 void Client::processMessage(json::Object message)
 {
   std::string type = message["type"].toString();
@@ -232,6 +236,11 @@ void Client::processMessage(json::Object message)
   }
   else if (type == "break")
   {
+    std::shared_ptr<BreakSnapshot> snapshot = parseBreakSnapshot(message);
+
+    if (snapshot)
+      Q_EMIT messageReceived(snapshot);
+
     setState(State::DebuggerPaused);
   }
   else if (type == "goodbye")
@@ -241,67 +250,19 @@ void Client::processMessage(json::Object message)
   }
   else if (type == "sourcecode")
   {
-    auto mssg = std::make_shared<SourceCode>();
-    mssg->source = message["text"].toString();
-    mssg->path = message["path"].toString();
-    mssg->syntaxtree = message["ast"].toObject();
-
-    Q_EMIT messageReceived(mssg);
+    Q_EMIT messageReceived(parseSourceCode(message));
   }
   else if (type == "breakpoints")
   {
-    auto mssg = std::make_shared<BreakpointList>();
-  
-    json::Array list = message["list"].toArray();
-
-    for(int i(0); i < list.length(); ++i)
-    {
-      json::Object js = list.at(i).toObject();
-
-      BreakpointData bp;
-      bp.function = js["function"].toString();
-      bp.id = js["id"].toInt();
-      bp.line = js["line"].toInt();
-      bp.script_path = js["path"].toString();
-
-      mssg->list.push_back(bp);
-    }
-
-    Q_EMIT messageReceived(mssg);
+    Q_EMIT messageReceived(parseBreakpointList(message));
   }
   else if (type == "callstack")
   {
-    auto mssg = std::make_shared<Callstack>();
-
-    json::Array list = message["stack"].toArray();
-
-    for (int i(0); i < list.length(); ++i)
-    {
-      json::Object jsonentry = list.at(i).toObject();
-      debugger::CallstackEntry entry;
-      entry.function = jsonentry["function"].toString();
-      entry.path = jsonentry["path"].toString();
-      entry.line = jsonentry["line"].toInt();
-      mssg->entries.push_back(entry);
-    }
-
-    Q_EMIT messageReceived(mssg);
+    Q_EMIT messageReceived(parseCallstack(message));
   }
   else if (type == "variables")
   {
-    auto mssg = std::make_shared<VariableList>();
-
-    mssg->callstack_depth = message["depth"].toInt();
-
-    json::Array list = message["variables"].toArray();
-
-    for (int i(0); i < list.length(); ++i)
-    {
-      json::Object varjson = list.at(i).toObject();
-      mssg->variables.push_back(deserializeVar(varjson));
-    }
-
-    Q_EMIT messageReceived(mssg);
+    Q_EMIT messageReceived(parseVariableList(message));
   }
 }
 
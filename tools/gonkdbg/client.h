@@ -60,7 +60,7 @@ public:
   void removeBreakpoint(int id);
   void removeBreakpoint(const std::string& script_path, int line);
 
-  void getSource(const std::string& path);
+  void getSource(const std::string& path, const std::string& hash = {});
 
   void getBreakpoints();
 
@@ -68,6 +68,10 @@ public:
 
   void getVariables(int depth = -1);
 
+  void detach();
+
+  void configureSnapshot(int frames, bool variables = true, bool source = true);
+
 Q_SIGNALS:
   void stateChanged(int cur, int prev);
   void connectionEstablished();
@@ -27,8 +27,6 @@ CodeViewer::CodeViewer(Controller& con, std::shared_ptr<gonk::debugger::SourceCo
   m_charwidth = metrics.width('M');
   m_lineheight = metrics.height();
 
-  m_highlighter = new SyntaxHighlighter(document());
-
   {
     m_linenumberarea = new LineNumberArea(this);
 
@@ -44,8 +42,23 @@ CodeViewer::CodeViewer(Controller& con, std::shared_ptr<gonk::debugger::SourceCo
   QTextCursor cursor{ document() };
   cursor.insertText(QString::fromStdString(src->source));
 
+  // the highlighter is attached after the text is inserted and the file is
+  // tokenized in a worker thread, the blocks are then highlighted in chunks
+  // starting with the visible ones
+  m_highlighter = new SyntaxHighlighter(document());
+  m_highlighter->analyzeInBackground(src->source, src->syntaxtree);
+
+  connect(m_highlighter, &SyntaxHighlighter::analysisFinished, this, [this]() {
+    m_highlighter->highlightIncrementally(firstVisibleBlock().blockNumber());
+    });
+
   document()->setMetaInformation(QTextDocument::MetaInformation::DocumentUrl, QString::fromStdString(src->path));
 
+  connect(&m_controller, &Controller::sourceCodeReceived, this, [this](std::shared_ptr<gonk::debugger::SourceCode> received) {
+    if (received->path == m_source->path)
+      setSourceCode(received);
+    });
+
   connect(&m_controller, &Controller::currentFrameChanged, this, &CodeViewer::updateMarkers);
   connect(&m_controller, &Controller::callstackUpdated, this, &CodeViewer::updateMarkers);
   connect(&m_controller, &Controller::breakpointsUpdated, this, &CodeViewer::updateMarkers);
@@ -54,6 +67,33 @@ CodeViewer::CodeViewer(Controller& con, std::shared_ptr<gonk::debugger::SourceCo
   updateMarkers();
 }
 
+SyntaxHighlighter* CodeViewer::highlighter() const
+{
+  return m_highlighter;
+}
+
+void CodeViewer::setSourceCode(std::shared_ptr<gonk::debugger::SourceCode> src)
+{
+  if (src == m_source)
+    return;
+
+  const bool same_text = src->source == m_source->source;
+  m_source = src;
+
+  if (same_text && !m_highlighter->isAnalyzing())
+  {
+    // only the lines whose hints changed are highlighted again
+    m_highlighter->setHints(SyntaxHighlighter::hintsFromAst(src->syntaxtree, src->source));
+    return;
+  }
+
+  // blocks are not highlighted while the analysis is running
+  m_highlighter->analyzeInBackground(src->source, src->syntaxtree);
+
+  if (!same_text)
+    setPlainText(QString::fromStdString(src->source));
+}
+
 QString CodeViewer::documentPath() const
 {
   return document()->metaInformation(QTextDocument::MetaInformation::DocumentUrl);
@@ -98,7 +138,8 @@ void CodeViewer::updateMarkers()
   if (callstack != nullptr)
   {
     const auto& callstack_top = [&]() -> const gonk::debugger::CallstackEntry& {
-      return m_controller.currentFrame() == -1 ? callstack->entries.back() : callstack->entries.at(m_controller.currentFrame());
+      int n = m_controller.currentFrame() - callstack->offset;
+      return (n < 0 || n >= static_cast<int>(callstack->entries.size())) ? callstack->entries.back() : callstack->entries.at(n);
     }();
 
     std::shared_ptr<gonk::debugger::SourceCode> src = m_controller.getSource(callstack_top.path);
@@ -125,6 +166,7 @@ void CodeViewer::updateMarkers()
   }
 }
 
+
 void CodeViewer::toggleBreakpoint(int line)
 {
   if (m_controller.hasBreakpoint(documentPath().toStdString(), line))
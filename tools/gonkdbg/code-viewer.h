@@ -33,6 +33,10 @@ public:
     int markers = 0;
   };
 
+  SyntaxHighlighter* highlighter() const;
+
+  void setSourceCode(std::shared_ptr<gonk::debugger::SourceCode> src);
+
   QString documentPath() const;
 
   void clearMarkers();
@@ -148,6 +148,21 @@ std::shared_ptr<gonk::debugger::SourceCode> Controller::getSource(const std::str
   return it == m_source_codes.end() ? nullptr : it->second;
 }
 
+void Controller::requestSource(const std::string& path)
+{
+  std::shared_ptr<gonk::debugger::SourceCode> cached = m_source_cache.find(path);
+
+  // the break snapshot tells us whether the cached copy is still valid
+  if (cached && m_last_snapshot && m_last_snapshot->path == path && m_last_snapshot->source_hash == cached->hash)
+  {
+    m_source_codes[path] = cached;
+    Q_EMIT sourceCodeReceived(cached);
+    return;
+  }
+
+  client().getSource(path, cached ? cached->hash : std::string());
+}
+
 bool Controller::hasBreakpoint(const std::string& script_path, int line) const
 {
   if (m_last_breakpoints_message == nullptr)
@@ -229,18 +244,28 @@ void Controller::onSocketConnected()
   connect(&client(), &gonk::debugger::Client::debuggerRunning, this, &Controller::onDebuggerRunning);
   connect(&client(), &gonk::debugger::Client::debuggerPaused, this, &Controller::onDebuggerPaused);
   connect(&client(), &gonk::debugger::Client::messageReceived, this, &Controller::onMessageReceived);
+
+  client().configureSnapshot(32);
 }
 
 void Controller::onDebuggerRunning()
 {
+  m_last_snapshot = nullptr;
   setCurrentFrame(-1);
 }
 
 void Controller::onDebuggerPaused()
 {
-  client().getCallstack();
-  client().getBreakpoints();
-  client().getVariables();
+  // anything that came with the break notification does not need to be requested
+  if (!m_last_snapshot || !m_last_snapshot->callstack)
+    client().getCallstack();
+
+  // breakpoints only change through our own requests, which refresh the list
+  if (!m_last_snapshot || !m_last_breakpoints_message)
+    client().getBreakpoints();
+
+  if (!m_last_snapshot || !m_last_snapshot->variables)
+    client().getVariables();
 }
 
 void Controller::onMessageReceived(std::shared_ptr<gonk::debugger::DebuggerMessage> mssg)
@@ -252,10 +277,12 @@ void Controller::onMessageReceived(std::shared_ptr<gonk::debugger::DebuggerMessa
   {
     m_last_callstack_message = std::static_pointer_cast<gonk::debugger::Callstack>(mssg);
 
+    int depth = m_last_callstack_message->offset + static_cast<int>(m_last_callstack_message->entries.size());
+
     m_variables.clear();
-    m_variables.resize(m_last_callstack_message->entries.size(), nullptr);
+    m_variables.resize(depth, nullptr);
 
-    setCurrentFrame(static_cast<int>(m_last_callstack_message->entries.size()) - 1);
+    setCurrentFrame(depth - 1);
 
     Q_EMIT callstackUpdated();
   }
@@ -270,9 +297,37 @@ void Controller::onMessageReceived(std::shared_ptr<gonk::debugger::DebuggerMessa
     m_variables[m_last_variables_message->callstack_depth] = m_last_variables_message;
     Q_EMIT variablesUpdated();
   }
+  else if (dynamic_cast<gonk::debugger::BreakSnapshot*>(mssg.get()))
+  {
+    m_last_snapshot = std::static_pointer_cast<gonk::debugger::BreakSnapshot>(mssg);
+
+    if (m_last_snapshot->callstack)
+      onMessageReceived(m_last_snapshot->callstack);
+
+    if (m_last_snapshot->variables)
+      onMessageReceived(m_last_snapshot->variables);
+  }
   else if (dynamic_cast<gonk::debugger::SourceCode*>(mssg.get()))
   {
     auto src = std::static_pointer_cast<gonk::debugger::SourceCode>(mssg);
+
+    if (src->unchanged)
+    {
+      std::shared_ptr<gonk::debugger::SourceCode> cached = m_source_cache.find(src->path);
+
+      if (!cached || cached->hash != src->hash)
+      {
+        client().getSource(src->path);
+        return;
+      }
+
+      src = cached;
+    }
+    else
+    {
+      m_source_cache.store(src);
+    }
+
     m_source_codes[src->path] = src;
 
     {
@@ -8,6 +8,7 @@
 #include <QObject>
 
 #include "client.h"
+#include "source-cache.h"
 
 #include <QProcess>
 
@@ -53,6 +54,7 @@ public:
 
   bool hasSource(const std::string& path) const;
   std::shared_ptr<gonk::debugger::SourceCode> getSource(const std::string& path) const;
+  void requestSource(const std::string& path);
 
   bool hasBreakpoint(const std::string& script_path, int line) const;
 
@@ -93,8 +95,10 @@ private:
   std::shared_ptr<gonk::debugger::Callstack> m_last_callstack_message;
   std::shared_ptr<gonk::debugger::BreakpointList> m_last_breakpoints_message;
   std::shared_ptr<gonk::debugger::VariableList> m_last_variables_message;
+  std::shared_ptr<gonk::debugger::BreakSnapshot> m_last_snapshot;
   std::vector<std::shared_ptr<gonk::debugger::VariableList>> m_variables;
   std::map<std::string, std::shared_ptr<gonk::debugger::SourceCode>> m_source_codes;
+  SourceCache m_source_cache;
 };
 
 #endif // GONKDBG_CONTROLLER_H
@@ -180,7 +180,7 @@ void MainWindow::onCallstackUpdated()
   else
   {
     connect(m_controller, &Controller::sourceCodeReceived, this, &MainWindow::setCurrentSourceCode);
-    m_controller->client().getSource(callstack_top.path);
+    m_controller->requestSource(callstack_top.path);
   }
 }
 
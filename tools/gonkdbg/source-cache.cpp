@@ -0,0 +1,114 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "source-cache.h"
+
+#include <plugins/gonk-debugger/json-stream-parser.h>
+
+#include <json-toolkit/stringify.h>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QStandardPaths>
+
+#include <fstream>
+#include <sstream>
+
+SourceCache::SourceCache()
+  : SourceCache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/sources")
+{
+
+}
+
+SourceCache::SourceCache(const QString& dir)
+  : m_dir(dir)
+{
+
+}
+
+const QString& SourceCache::directory() const
+{
+  return m_dir;
+}
+
+std::shared_ptr<gonk::debugger::SourceCode> SourceCache::find(const std::string& path)
+{
+  auto it = m_entries.find(path);
+
+  if (it != m_entries.end())
+    return it->second;
+
+  std::shared_ptr<gonk::debugger::SourceCode> src = load(path);
+
+  if (src)
+    m_entries[path] = src;
+
+  return src;
+}
+
+void SourceCache::store(const std::shared_ptr<gonk::debugger::SourceCode>& src)
+{
+  if (!src || src->hash.empty() || src->unchanged)
+    return;
+
+  auto it = m_entries.find(src->path);
+
+  if (it != m_entries.end() && it->second->hash == src->hash)
+    return;
+
+  m_entries[src->path] = src;
+  save(*src);
+}
+
+QString SourceCache::filePath(const std::string& path) const
+{
+  QByteArray digest = QCryptographicHash::hash(QByteArray::fromStdString(path), QCryptographicHash::Sha1);
+  return m_dir + "/" + QString::fromLatin1(digest.toHex()) + ".json";
+}
+
+std::shared_ptr<gonk::debugger::SourceCode> SourceCache::load(const std::string& path) const
+{
+  std::ifstream file{ filePath(path).toStdString() };
+
+  if (!file.is_open())
+    return nullptr;
+
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+
+  gonk::JsonStreamParser parser;
+  parser.write(buffer.str());
+
+  if (parser.objects.empty())
+    return nullptr;
+
+  json::Object obj = parser.objects.front();
+
+  // two paths may end up with the same file name
+  if (obj["path"].toString() != path)
+    return nullptr;
+
+  auto src = std::make_shared<gonk::debugger::SourceCode>();
+  src->path = path;
+  src->hash = obj["hash"].toString();
+  src->source = obj["text"].toString();
+  src->syntaxtree = obj["ast"].toObject();
+  return src;
+}
+
+void SourceCache::save(const gonk::debugger::SourceCode& src) const
+{
+  if (!QDir().mkpath(m_dir))
+    return;
+
+  json::Object obj;
+  obj["path"] = src.path;
+  obj["hash"] = src.hash;
+  obj["text"] = src.source;
+  obj["ast"] = src.syntaxtree;
+
+  std::string content = json::stringify(obj);
+  std::ofstream file{ filePath(src.path).toStdString() };
+  file.write(content.c_str(), content.size());
+}
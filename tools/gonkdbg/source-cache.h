@@ -0,0 +1,39 @@
+// Copyright (C) 2022 Vincent Chambrin
+// This file is part of the 'gonk' project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#ifndef GONKDBG_SOURCECACHE_H
+#define GONKDBG_SOURCECACHE_H
+
+#include <plugins/gonk-debugger/message.h>
+
+#include <QString>
+
+#include <map>
+#include <memory>
+#include <string>
+
+// Keeps the source code (and syntax tree) received from the debugger on disk
+// so that a new session only needs to send the content hash of a script.
+class SourceCache
+{
+public:
+  SourceCache();
+  explicit SourceCache(const QString& dir);
+
+  const QString& directory() const;
+
+  std::shared_ptr<gonk::debugger::SourceCode> find(const std::string& path);
+  void store(const std::shared_ptr<gonk::debugger::SourceCode>& src);
+
+protected:
+  QString filePath(const std::string& path) const;
+  std::shared_ptr<gonk::debugger::SourceCode> load(const std::string& path) const;
+  void save(const gonk::debugger::SourceCode& src) const;
+
+private:
+  QString m_dir;
+  std::map<std::string, std::shared_ptr<gonk::debugger::SourceCode>> m_entries;
+};
+
+#endif // GONKDBG_SOURCECACHE_H
@@ -4,15 +4,18 @@
 
 #include "syntax-highlighting.h"
 
+#include <QTextBlock>
 #include <QTextDocument>
 
-#include <QJsonObject>
-#include <QJsonArray>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <QTimer>
 
 #include <QDebug>
 
+#include <algorithm>
+
 
 enum class TokenType
 {
@@ -749,36 +752,109 @@ SyntaxHighlighter::SyntaxHighlighter(QTextDocument* doc)
   fmt.setForeground(QColor("#008000"));
   initFormat(Format::Comment, fmt);
 
-  m_rehighlight_timer = new QTimer(this);
-  m_rehighlight_timer->setSingleShot(true);
-  m_rehighlight_timer->setInterval(1000);
+  m_chunk_timer = new QTimer(this);
+  m_chunk_timer->setInterval(0);
 
-  connect(m_rehighlight_timer, &QTimer::timeout, this, &SyntaxHighlighter::rehighlight);
+  connect(m_chunk_timer, &QTimer::timeout, this, &SyntaxHighlighter::highlightNextBlocks);
 }
 
-void SyntaxHighlighter::highlightBlock(const QString& text)
+SyntaxHighlighter::~SyntaxHighlighter()
+{
+
+}
+
+SyntaxHighlighter::HintIndex::HintIndex(std::vector<Hint> hints)
+  : m_hints(std::move(hints))
+{
+  std::sort(m_hints.begin(), m_hints.end(), [](const Hint& a, const Hint& b) {
+    return a.line < b.line || (a.line == b.line && a.col < b.col);
+    });
+
+  const int nblines = m_hints.empty() ? 0 : m_hints.back().line + 1;
+  m_lines.resize(static_cast<size_t>(nblines) + 1);
+
+  size_t i = 0;
+
+  for (int line(0); line <= nblines; ++line)
+  {
+    while (i < m_hints.size() && m_hints.at(i).line < line)
+      ++i;
+
+    m_lines[line] = i;
+  }
+}
+
+int SyntaxHighlighter::HintIndex::lineCount() const
+{
+  return m_lines.empty() ? 0 : static_cast<int>(m_lines.size()) - 1;
+}
+
+SyntaxHighlighter::Format SyntaxHighlighter::HintIndex::find(int line, int col) const
 {
-  int prevstate = previousBlockState();
-  int blocknum = currentBlock().blockNumber();
+  if (line < 0 || line >= lineCount())
+    return Default;
+
+  auto begin = m_hints.begin() + m_lines.at(line);
+  auto end = m_hints.begin() + m_lines.at(line + 1);
+
+  auto it = std::upper_bound(begin, end, col, [](int c, const Hint& h) {
+    return c < h.col;
+    });
+
+  if (it == begin)
+    return Default;
+
+  --it;
+  return col < it->col + it->length ? it->type : Default;
+}
+
+bool SyntaxHighlighter::HintIndex::sameHints(const HintIndex& other, int line) const
+{
+  auto range = [line](const HintIndex& index) -> std::pair<size_t, size_t> {
+    if (line < 0 || line >= index.lineCount())
+      return { 0, 0 };
+    return { index.m_lines.at(line), index.m_lines.at(line + 1) };
+  };
+
+  auto r1 = range(*this);
+  auto r2 = range(other);
+
+  if (r1.second - r1.first != r2.second - r2.first)
+    return false;
+
+  for (size_t i(0); i < r1.second - r1.first; ++i)
+  {
+    const Hint& a = m_hints.at(r1.first + i);
+    const Hint& b = other.m_hints.at(r2.first + i);
+
+    if (a.col != b.col || a.length != b.length || a.type != b.type)
+      return false;
+  }
+
+  return true;
+}
+
+SyntaxHighlighter::BlockFormats SyntaxHighlighter::lex(const QString& text, int prevstate)
+{
+  BlockFormats result;
+  result.hash = qHash(text);
+  result.after_comment = (prevstate == ST_Comment);
 
   int begin = 0;
 
-  if (prevstate == ST_Comment)
+  if (result.after_comment)
   {
     begin = text.indexOf("*/");
 
-    if (begin != -1)
-    {
-      begin = begin + 2;
-      setFormat(0, begin, Comment);
-      setCurrentBlockState(0);
-    }
-    else
+    if (begin == -1)
     {
-      setFormat(0, text.length(), Comment);
-      setCurrentBlockState(prevstate);
-      return;
+      result.ranges.push_back(FormatRange{ 0, text.length(), Format::Comment, false });
+      result.state = ST_Comment;
+      return result;
     }
+
+    begin = begin + 2;
+    result.ranges.push_back(FormatRange{ 0, begin, Format::Comment, false });
   }
 
   Tokenizer lexer;
@@ -789,18 +865,19 @@ void SyntaxHighlighter::highlightBlock(const QString& text)
     const Token& tok = lexer.output.at(i);
 
     int offset = tok.str.data() - text.data();
+    int length = static_cast<int>(tok.str.length());
 
     if (tok.type == TokenType::StringLiteral)
     {
-      setFormat(offset, tok.str.length(), Format::String);
+      result.ranges.push_back(FormatRange{ offset, length, Format::String, false });
     }
     else if (tok.type == TokenType::NumericLiteral)
     {
-      setFormat(offset, tok.str.length(), Format::Literal);
+      result.ranges.push_back(FormatRange{ offset, length, Format::Literal, false });
     }
     else if (tok.type == TokenType::Keyword)
     {
-      setFormat(offset, tok.str.length(), Format::Keyword);
+      result.ranges.push_back(FormatRange{ offset, length, Format::Keyword, false });
     }
     else if (tok.type == TokenType::Punctuator)
     {
@@ -808,37 +885,278 @@ void SyntaxHighlighter::highlightBlock(const QString& text)
     }
     else if (tok.type == TokenType::Identifier)
     {
+      Format fmt = Format::Default;
+
       if (i + 1 < lexer.output.size())
       {
-        if(lexer.output.at(i+1).str == '(')
-          setFormat(offset, tok.str.length(), Format::Function);
-        else if(lexer.output.at(i + 1).str == QLatin1String("::"))
-          setFormat(offset, tok.str.length(), Format::Typename);
-        else
-          setFormat(offset, tok.str.length(), guessFormat(blocknum, offset, tok.str));
-      }
-      else
-      {
-        setFormat(offset, tok.str.length(), guessFormat(blocknum, offset, tok.str));
+        if (lexer.output.at(i + 1).str == '(')
+          fmt = Format::Function;
+        else if (lexer.output.at(i + 1).str == QLatin1String("::"))
+          fmt = Format::Typename;
       }
+
+      // hints from the syntax tree take precedence, see apply()
+      result.ranges.push_back(FormatRange{ offset, length, fmt, true });
     }
     else if (tok.type == TokenType::Comment)
     {
-      setFormat(offset, tok.str.length(), Format::Comment);
+      result.ranges.push_back(FormatRange{ offset, length, Format::Comment, false });
     }
   }
 
   if (!lexer.output.empty())
   {
     const Token& tok = lexer.output.back();
-    
+
     bool starts_multi_comment = tok.type == TokenType::Comment && tok.str.startsWith(QLatin1String("/*")) && !tok.str.endsWith(QLatin1String("*/"));
-    setCurrentBlockState(starts_multi_comment ? ST_Comment : 0);
+    result.state = starts_multi_comment ? ST_Comment : 0;
   }
   else
   {
-    setCurrentBlockState(0);
+    result.state = 0;
+  }
+
+  return result;
+}
+
+namespace
+{
+
+class AstHintCollector
+{
+public:
+  using Format = SyntaxHighlighter::Format;
+
+  std::vector<SyntaxHighlighter::Hint> hints;
+
+  explicit AstHintCollector(const std::string& source)
+  {
+    m_line_starts.push_back(0);
+
+    for (size_t i(0); i < source.size(); ++i)
+    {
+      if (source[i] == '\n')
+        m_line_starts.push_back(static_cast<int>(i) + 1);
+    }
+  }
+
+  static bool isIdentifier(const std::string& type)
+  {
+    return type == "SimpleIdentifier" || type == "TemplateIdentifier";
+  }
+
+  void add(const json::Object& node, Format fmt)
+  {
+    int offset = node["offset"].toInt();
+    int length = node["length"].toInt();
+
+    // only highlight the name of a template-id
+    if (node["children"].isArray() && node["children"].toArray().length() > 0)
+    {
+      json::Object first = node["children"].toArray().at(0).toObject();
+
+      if (first["type"].toString() == "id")
+      {
+        offset = first["offset"].toInt();
+        length = first["length"].toInt();
+      }
+    }
+
+    auto it = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), offset);
+    int line = static_cast<int>(std::distance(m_line_starts.begin(), it)) - 1;
+
+    hints.push_back(SyntaxHighlighter::Hint{ line, offset - m_line_starts.at(line), length, fmt });
+  }
+
+  void visit(const json::Object& node, Format qualified_name)
+  {
+    if (!node["children"].isArray())
+      return;
+
+    const std::string type = node["type"].toString();
+    json::Array children = node["children"].toArray();
+
+    const bool is_decl = type == "FunctionDeclaration" || type == "ConstructorDeclaration" || type == "DestructorDeclaration"
+      || type == "ClassDeclaration" || type == "EnumDeclaration" || type == "NamespaceDecl" || type == "NamespaceAliasDef";
+
+    std::vector<int> ids;
+
+    for (int i(0); i < children.length(); ++i)
+    {
+      if (isIdentifier(children.at(i).toObject()["type"].toString()))
+        ids.push_back(i);
+    }
+
+    for (size_t i(0); i < ids.size(); ++i)
+    {
+      const bool last = (i + 1 == ids.size());
+      Format fmt = Format::Default;
+
+      if (is_decl)
+      {
+        // the first identifier is the name of the entity
+        if (i != 0)
+          break;
+
+        if (type == "ClassDeclaration" || type == "EnumDeclaration")
+          fmt = Format::Typename;
+        else if (type == "NamespaceDecl" || type == "NamespaceAliasDef")
+          fmt = Format::NamespaceName;
+        else
+          fmt = Format::Function;
+      }
+      else if (type == "QualifiedType")
+      {
+        fmt = Format::Typename;
+      }
+      else if (type == "QualifiedIdentifier")
+      {
+        fmt = last ? qualified_name : Format::NamespaceName;
+      }
+      else if (type == "FunctionCall" && ids.at(i) == 0)
+      {
+        fmt = Format::Function;
+      }
+
+      if (fmt != Format::Default)
+        add(children.at(ids.at(i)).toObject(), fmt);
+    }
+
+    Format next = type == "QualifiedType" ? Format::Typename : (type == "FunctionCall" ? Format::Function : Format::Default);
+
+    for (int i(0); i < children.length(); ++i)
+      visit(children.at(i).toObject(), next);
+  }
+
+private:
+  std::vector<int> m_line_starts;
+};
+
+} // namespace
+
+std::vector<SyntaxHighlighter::Hint> SyntaxHighlighter::hintsFromAst(const json::Object& ast, const std::string& source)
+{
+  AstHintCollector collector{ source };
+
+  if (ast["nodes"].isArray())
+  {
+    json::Array nodes = ast["nodes"].toArray();
+
+    for (int i(0); i < nodes.length(); ++i)
+      collector.visit(nodes.at(i).toObject(), Format::Default);
+  }
+
+  return std::move(collector.hints);
+}
+
+SyntaxHighlighter::Analysis SyntaxHighlighter::analyze(const std::string& source, const json::Object& ast)
+{
+  Analysis result;
+
+  const QString text = QString::fromStdString(source);
+  int state = 0;
+  int start = 0;
+
+  for (;;)
+  {
+    int end = text.indexOf('\n', start);
+    QString line = text.mid(start, end == -1 ? -1 : end - start);
+
+    BlockFormats formats = lex(line, state);
+    state = formats.state;
+    result.blocks.push_back(std::move(formats));
+
+    if (end == -1)
+      break;
+
+    start = end + 1;
+  }
+
+  result.hints = hintsFromAst(ast, source);
+
+  return result;
+}
+
+void SyntaxHighlighter::analyzeInBackground(const std::string& source, const json::Object& ast)
+{
+  m_precomputed.clear();
+  m_chunk_timer->stop();
+  m_highlighted_blocks = -1;
+
+  if (m_watcher)
+  {
+    m_watcher->disconnect(this);
+    m_watcher->deleteLater();
+  }
+
+  m_watcher = new QFutureWatcher<Analysis>(this);
+  connect(m_watcher, &QFutureWatcher<Analysis>::finished, this, &SyntaxHighlighter::onAnalysisFinished);
+
+  m_watcher->setFuture(QtConcurrent::run([source, ast]() -> Analysis {
+    return analyze(source, ast);
+    }));
+}
+
+bool SyntaxHighlighter::isAnalyzing() const
+{
+  return m_watcher != nullptr && !m_watcher->isFinished();
+}
+
+void SyntaxHighlighter::highlightIncrementally(int first_block)
+{
+  if (!document() || document()->blockCount() == 0)
+    return;
+
+  m_first_block = std::max(0, std::min(first_block, document()->blockCount() - 1));
+  m_highlighted_blocks = 0;
+  m_chunk_timer->start();
+}
+
+void SyntaxHighlighter::setHints(std::vector<Hint> hints)
+{
+  HintIndex index{ std::move(hints) };
+  std::swap(m_hints, index);
+
+  if (!document())
+    return;
+
+  // only the lines whose hints changed need to be highlighted again
+  const int nblines = std::max(m_hints.lineCount(), index.lineCount());
+
+  for (int line(0); line < nblines; ++line)
+  {
+    if (m_hints.sameHints(index, line))
+      continue;
+
+    QTextBlock block = document()->findBlockByNumber(line);
+
+    if (block.isValid())
+      rehighlightBlock(block);
+  }
+}
+
+void SyntaxHighlighter::highlightBlock(const QString& text)
+{
+  const int prevstate = previousBlockState();
+  const int blocknum = currentBlock().blockNumber();
+
+  if (blocknum < static_cast<int>(m_precomputed.size()))
+  {
+    const BlockFormats& formats = m_precomputed.at(blocknum);
+
+    // -1 means the previous block has not been highlighted yet
+    bool state_matches = prevstate == -1 || formats.after_comment == (prevstate == ST_Comment);
+
+    if (state_matches && formats.hash == qHash(text))
+      return apply(formats, blocknum);
+  }
+  else if (isAnalyzing())
+  {
+    // the block will be highlighted once the analysis is done
+    return;
   }
+
+  apply(lex(text, prevstate), blocknum);
 }
 
 void SyntaxHighlighter::initFormat(Format fmt, const QTextCharFormat& value)
@@ -851,8 +1169,56 @@ void SyntaxHighlighter::setFormat(int start, int count, Format fmt)
   QSyntaxHighlighter::setFormat(start, count, m_formats.at(fmt));
 }
 
-SyntaxHighlighter::Format SyntaxHighlighter::guessFormat(int line, int col, const QStringView& tok) const
+void SyntaxHighlighter::apply(const BlockFormats& formats, int blocknum)
 {
-  // @TODO: use "m_hints"
-  return Default;
+  for (const FormatRange& r : formats.ranges)
+  {
+    Format fmt = r.format;
+
+    if (r.identifier)
+    {
+      Format hint = m_hints.find(blocknum, r.start);
+
+      if (hint != Format::Default)
+        fmt = hint;
+    }
+
+    if (fmt != Format::Default)
+      setFormat(r.start, r.length, fmt);
+  }
+
+  setCurrentBlockState(formats.state);
+}
+
+void SyntaxHighlighter::onAnalysisFinished()
+{
+  Analysis result = m_watcher->result();
+
+  m_precomputed = std::move(result.blocks);
+  m_hints = HintIndex(std::move(result.hints));
+
+  Q_EMIT analysisFinished();
+
+  // nobody asked to start from a specific block
+  if (!m_chunk_timer->isActive())
+    highlightIncrementally(0);
+}
+
+void SyntaxHighlighter::highlightNextBlocks()
+{
+  const int count = document() ? document()->blockCount() : 0;
+  const int chunk_size = 500;
+
+  for (int i(0); i < chunk_size && m_highlighted_blocks < count; ++i, ++m_highlighted_blocks)
+  {
+    int n = (m_first_block + m_highlighted_blocks) % count;
+    rehighlightBlock(document()->findBlockByNumber(n));
+  }
+
+  if (m_highlighted_blocks >= count)
+  {
+    m_chunk_timer->stop();
+    m_highlighted_blocks = -1;
+    Q_EMIT highlightingFinished();
+  }
 }
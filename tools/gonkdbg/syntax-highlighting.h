@@ -7,15 +7,24 @@
 
 #include <QSyntaxHighlighter> 
 
+#include <json-toolkit/json.h>
+
 #include <set>
+#include <string>
+#include <vector>
 
 class QStringView;
+class QTimer;
+
+template<typename T>
+class QFutureWatcher;
 
 class SyntaxHighlighter : public QSyntaxHighlighter
 {
   Q_OBJECT
 public:
   SyntaxHighlighter(QTextDocument* doc);
+  ~SyntaxHighlighter();
 
   enum Format
   {
@@ -42,23 +51,83 @@ public:
   {
     int line;
     int col;
+    int length;
     Format type;
   };
 
+  // hints sorted by position with the index of the first hint of each line,
+  // the hint covering a column is found with a binary search in its line
+  class HintIndex
+  {
+  public:
+    HintIndex() = default;
+    explicit HintIndex(std::vector<Hint> hints);
+
+    int lineCount() const;
+    Format find(int line, int col) const;
+    bool sameHints(const HintIndex& other, int line) const;
+
+  private:
+    std::vector<Hint> m_hints;
+    std::vector<size_t> m_lines;
+  };
+
+  struct FormatRange
+  {
+    int start;
+    int length;
+    Format format;
+    bool identifier;
+  };
+
+  struct BlockFormats
+  {
+    uint hash = 0;
+    bool after_comment = false;
+    int state = 0;
+    std::vector<FormatRange> ranges;
+  };
+
+  struct Analysis
+  {
+    std::vector<BlockFormats> blocks;
+    std::vector<Hint> hints;
+  };
+
+  static BlockFormats lex(const QString& text, int prevstate);
+  static std::vector<Hint> hintsFromAst(const json::Object& ast, const std::string& source);
+  static Analysis analyze(const std::string& source, const json::Object& ast);
+
+  void analyzeInBackground(const std::string& source, const json::Object& ast);
+  bool isAnalyzing() const;
+  void highlightIncrementally(int first_block);
+
+  void setHints(std::vector<Hint> hints);
+
+Q_SIGNALS:
+  void analysisFinished();
+  void highlightingFinished();
+
 protected:
   void highlightBlock(const QString& text) override;
 
 protected:
   void initFormat(Format fmt, const QTextCharFormat& value);
   void setFormat(int start, int count, Format fmt);
-  Format guessFormat(int line, int col, const QStringView& tok) const;
+  void apply(const BlockFormats& formats, int blocknum);
+
+protected Q_SLOTS:
+  void onAnalysisFinished();
+  void highlightNextBlocks();
 
 private:
   std::vector<QTextCharFormat> m_formats;
-  std::string m_text;
-  std::vector<int> m_offsets;
-  QTimer* m_rehighlight_timer;
-  std::vector<Hint> m_hints;
+  HintIndex m_hints;
+  std::vector<BlockFormats> m_precomputed;
+  QFutureWatcher<Analysis>* m_watcher = nullptr;
+  QTimer* m_chunk_timer = nullptr;
+  int m_first_block = 0;
+  int m_highlighted_blocks = -1;
 };
 
 #endif // GONKDBG_SYNTAXHIGHLIGHTING_H